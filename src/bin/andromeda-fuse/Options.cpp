@@ -29,7 +29,8 @@ std::string Options::HelpText()
         << "andromeda-fuse -m|--mountpath path (-a|--apiurl url | -p|--apipath [path])" << endl << endl
 
         << "Remote Object:   [--folder [id] | --filesystem [id]]" << endl
-        << "Remote Auth:     [-u|--username str] [--password str] | [--sessionid id] [--sessionkey key] [--force-session]" << endl << endl
+        << "Remote Auth:     [-u|--username str] [--password str] | [--sessionid id] [--sessionkey key] [--force-session]" << endl
+        << "Statistics:      [--cache-stats] (print cache and worker counters when unmounted)" << endl << endl
        
         << HTTPOptions::HelpText() << endl
         << RunnerOptions::HelpText() << endl << endl
@@ -71,6 +72,8 @@ bool Options::AddFlag(const std::string& flag)
 
     else if (flag == "d" || flag == "debug")
         mForeground = true;
+    else if (flag == "cache-stats")
+        mPrintCacheStats = true;
     
     else if (BaseOptions::AddFlag(flag)) { }
     else if (mConfigOptions.AddFlag(flag)) { }
@@ -104,6 +104,9 @@ public:
     /** Returns true if we should run in the foreground */
     [[nodiscard]] bool isForeground() const { return mForeground; }
 
+    /** Returns true if we should print the cache counters when unmounted */
+    [[nodiscard]] bool isPrintCacheStats() const { return mPrintCacheStats; }
+
 private:
 
     Andromeda::ConfigOptions& mConfigOptions; // cppcheck-suppress uninitMemberVarPrivate
@@ -127,6 +130,7 @@ private:
     std::string mMountItemID;
 
     bool mForeground { false };
+    bool mPrintCacheStats { false };
 };
 
 } // namespace AndromedaFuse
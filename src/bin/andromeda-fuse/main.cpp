@@ -33,6 +33,7 @@ using Andromeda::Backend::HTTPOptions;
 using Andromeda::Backend::RunnerOptions;
 #include "andromeda/backend/RunnerPool.hpp"
 using Andromeda::Backend::RunnerPool;
+#include "andromeda/backend/WorkerPool.hpp"
 
 #include "andromeda/filesystem/Folder.hpp"
 using Andromeda::Filesystem::Folder;
@@ -44,6 +45,8 @@ using Andromeda::Filesystem::Folders::Filesystem;
 using Andromeda::Filesystem::Folders::SuperRoot;
 #include "andromeda/filesystem/filedata/CacheManager.hpp"
 using Andromeda::Filesystem::Filedata::CacheManager;
+#include "andromeda/filesystem/filedata/CacheStats.hpp"
+using Andromeda::Filesystem::Filedata::CacheStats;
 #include "andromeda/filesystem/filedata/CacheOptions.hpp"
 using Andromeda::Filesystem::Filedata::CacheOptions;
 
@@ -178,6 +181,15 @@ int main(int argc, char** argv)
         return static_cast<int>(ExitCode::FUSE_INIT);
     }
 
+    if (cacheMgr && options.isPrintCacheStats())
+    {
+        std::cout << "cache stats: ";
+        CacheStats::Print(std::cout, cacheMgr->GetCacheStats().GetValues());
+        std::cout << std::endl << "worker stats: ";
+        backend->GetWorkerPool().PrintStats(std::cout);
+        std::cout << std::endl;
+    }
+
     DDBG_INFO(": returning success...");
     return static_cast<int>(ExitCode::SUCCESS);
 }
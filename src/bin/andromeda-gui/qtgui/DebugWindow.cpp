@@ -1,5 +1,6 @@
 
 #include <chrono>
+#include <sstream>
 #include <QtCore/QTextStream>
 
 #include "DebugWindow.hpp"
@@ -11,6 +12,8 @@ using Andromeda::Debug;
 using Andromeda::StringUtil;
 #include "andromeda/filesystem/filedata/CacheManager.hpp"
 using Andromeda::Filesystem::Filedata::CacheManager;
+#include "andromeda/filesystem/filedata/CacheStats.hpp"
+using Andromeda::Filesystem::Filedata::CacheStats;
 #include "andromeda/filesystem/filedata/CachingAllocator.hpp"
 using Andromeda::Filesystem::Filedata::CachingAllocator;
 
@@ -137,8 +140,13 @@ void DebugWindow::UpdateCacheStats()
         << "curAlloc: " << StringUtil::bytesToStringF(allocStats.curAlloc).c_str()
             << " (" << StringUtil::bytesToStringF(allocStats.maxAlloc).c_str() << " max)"
         << ", curFree: " << StringUtil::bytesToStringF(allocStats.curFree).c_str()
-        << ", allocs: " << allocStats.allocs << ", recycles: " << allocStats.recycles;
+        << ", allocs: " << allocStats.allocs << ", recycles: " << allocStats.recycles
+            << " (" << allocStats.magazineHits << " magazine)";
     mQtUi->cacheAllocStats->setText(allocText);
+
+    std::ostringstream countersText;
+    CacheStats::Print(countersText, mCacheManager->GetCacheStats().GetValues());
+    mQtUi->cacheCounters->setText(countersText.str().c_str());
 }
 
 } // namespace QtGui
@@ -18,9 +18,13 @@ std::string ConfigOptions::HelpText()
     const size_t stBits { sizeof(size_t)*8 };
 
     using std::endl; output 
-        << "Advanced:        [-q|--quiet] [-r|--read-only] [--dir-refresh secs(" << defRefresh << ")] [--cachemode none|memory|normal] [--backend-runners uint"<<stBits<<"(" << optDefault.runnerPoolSize << ")]" << endl
+        << "Advanced:        [-q|--quiet] [-r|--read-only] [--dir-refresh secs(" << defRefresh << ")] [--cachemode none|memory|normal] [--backend-runners uint"<<stBits<<"(" << optDefault.runnerPoolSize << ")] [--backend-runners-min uint"<<stBits<<"(" << optDefault.runnerPoolMin << ")]" << endl
+        << "I/O Advanced:    [--backend-workers uint"<<stBits<<"(" << optDefault.workerPoolSize << ")] [--backend-queue uint"<<stBits<<"(" << optDefault.workerQueueSize << ")] [--backend-reserve-runner]" << endl
         << "Data Advanced:   [--pagesize bytes"<<stBits<<"(" << StringUtil::bytesToString(optDefault.pageSize) << ")] [--read-ahead ms(" << defReadAhead << ")]"
-            << " [--read-max-cache-frac uint32(" << optDefault.readMaxCacheFrac << ")] [--read-ahead-buffer pages(" << optDefault.readAheadBuffer << ")]";
+            << " [--read-max-cache-frac uint32(" << optDefault.readMaxCacheFrac << ")] [--read-ahead-buffer pages(" << optDefault.readAheadBuffer << ")]"
+            << " [--subpage-size bytes"<<stBits<<"(" << StringUtil::bytesToString(optDefault.subPageSize) << ")]" << endl
+        << "Upload Advanced: [--upload-stream bytes"<<stBits<<"(" << StringUtil::bytesToString(optDefault.uploadStreamBuffer) << ")]"
+            << " (stream new files while written in upload/append mode, 0 to disable - streamed data can't be read back or overwritten until closed)";
 
     return output.str();
 }
@@ -32,6 +36,8 @@ bool ConfigOptions::AddFlag(const std::string& flag)
         quiet = true;
     else if (flag == "r" || flag == "read-only")
         readOnly = true;
+    else if (flag == "backend-reserve-runner")
+        reserveRunner = true;
     else return false; // not used
 
     return true;
@@ -61,6 +67,26 @@ bool ConfigOptions::AddOption(const std::string& option, const std::string& valu
 
         if (!runnerPoolSize) throw BaseOptions::BadValueException(option);
     }
+    else if (option == "backend-runners-min")
+    {
+        try { runnerPoolMin = static_cast<decltype(runnerPoolMin)>(stoul(value)); }
+        catch (const std::logic_error& e) { 
+            throw BaseOptions::BadValueException(option); }
+    }
+    else if (option == "backend-workers")
+    {
+        try { workerPoolSize = static_cast<decltype(workerPoolSize)>(stoul(value)); }
+        catch (const std::logic_error& e) { 
+            throw BaseOptions::BadValueException(option); }
+
+        if (!workerPoolSize) throw BaseOptions::BadValueException(option);
+    }
+    else if (option == "backend-queue")
+    {
+        try { workerQueueSize = static_cast<decltype(workerQueueSize)>(stoul(value)); }
+        catch (const std::logic_error& e) { 
+            throw BaseOptions::BadValueException(option); }
+    }
     else if (option == "pagesize")
     {
         try { pageSize = static_cast<decltype(pageSize)>(StringUtil::stringToBytes(value)); }
@@ -89,6 +115,18 @@ bool ConfigOptions::AddOption(const std::string& option, const std::string& valu
         catch (const std::logic_error& e) { 
             throw BaseOptions::BadValueException(option); }
     }
+    else if (option == "subpage-size")
+    {
+        try { subPageSize = static_cast<decltype(subPageSize)>(StringUtil::stringToBytes(value)); }
+        catch (const std::logic_error& e) { 
+            throw BaseOptions::BadValueException(option); }
+    }
+    else if (option == "upload-stream")
+    {
+        try { uploadStreamBuffer = static_cast<decltype(uploadStreamBuffer)>(StringUtil::stringToBytes(value)); }
+        catch (const std::logic_error& e) { 
+            throw BaseOptions::BadValueException(option); }
+    }
     else return false; // not used
 
     return true; 
@@ -77,8 +77,45 @@ struct ConfigOptions
      */
     size_t readAheadBuffer { 2 };
 
+    /** 
+     * The size of the aligned blocks to fetch for random reads within a page (0 to always fetch whole pages)
+     * When reads are detected as random, only the blocks needed are fetched rather than the whole page,
+     * which reduces read amplification for small random reads when the pageSize is large
+     */
+    size_t subPageSize { 4096 }; // 4K
+
+    /** 
+     * The buffer size for streaming new files to the backend as they are written (0 to disable)
+     * Without RANDOM write mode, new files are otherwise uploaded all at once when flushed, so must fit in the cache.
+     * Streamed data must be written sequentially and can't be read back or overwritten until the upload is finished,
+     * so this is off by default as it breaks applications that seek back within a new file before closing it.
+     * The upload is sent in chunks of at most this size, and up to twice this is kept in memory for retries.
+     */
+    size_t uploadStreamBuffer { 0 };
+
     /** The maximum number of concurrent backend runners, never zero! */
     size_t runnerPoolSize { 1 }; // TODO server has threading issues
+
+    /** 
+     * The minimum number of concurrent backend runners, or 0 to always allow runnerPoolSize
+     * If set, the number used adapts between this and runnerPoolSize based on demand and server feedback
+     */
+    size_t runnerPoolMin { 0 };
+
+    /** If true (and runnerPoolSize > 1), one runner is reserved for requests a user is waiting on (not read-ahead/writeback) */
+    bool reserveRunner { false };
+
+    /** 
+     * The maximum number of background I/O worker threads (e.g. for read-ahead), never zero!
+     * Workers mostly wait on backend runners so this should be >= runnerPoolSize
+     */
+    size_t workerPoolSize { 8 };
+
+    /** 
+     * The maximum number of background I/O tasks waiting for a worker
+     * Tasks past this limit are dropped (read-ahead) or run by the caller instead
+     */
+    size_t workerQueueSize { 128 };
 };
 
 } // namespace Andromeda
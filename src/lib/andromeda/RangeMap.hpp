@@ -0,0 +1,157 @@
+#ifndef LIBA2_RANGEMAP_H_
+#define LIBA2_RANGEMAP_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <utility>
+
+namespace Andromeda {
+
+/**
+ * A map of non-overlapping [start, start+count) integer ranges to values (an interval set)
+ * Stored as a std::map keyed by range start, so finding the range containing an index is O(log n)
+ * Assigning or erasing a range trims or splits any existing ranges that overlap it
+ * @tparam T the value stored for each range - must be copyable if ranges are split
+ */
+template<typename T>
+class RangeMap
+{
+public:
+
+    /** A range's length and value (its start is the map key) */
+    struct Range
+    {
+        uint64_t count;
+        T value;
+    };
+
+    using RangeList = std::map<uint64_t, Range>;
+    using value_type = typename RangeList::value_type;
+    using iterator = typename RangeList::iterator;
+    using const_iterator = typename RangeList::const_iterator;
+
+    /** Returns an iterator pointing to the lowest range */
+    [[nodiscard]] inline iterator begin() noexcept { return mRanges.begin(); }
+    /** Returns an iterator pointing to the past-the-end range */
+    [[nodiscard]] inline iterator end() noexcept { return mRanges.end(); }
+    /** Returns a const iterator pointing to the lowest range */
+    [[nodiscard]] inline const_iterator begin() const noexcept { return mRanges.begin(); }
+    /** Returns a const iterator pointing to the past-the-end range */
+    [[nodiscard]] inline const_iterator end() const noexcept { return mRanges.end(); }
+
+    /** Returns the number of ranges (O(1)) */
+    [[nodiscard]] inline size_t size() const noexcept { return mRanges.size(); }
+    /** Returns true iff there are no ranges (O(1)) */
+    [[nodiscard]] inline bool empty() const noexcept { return mRanges.empty(); }
+    /** Erases all ranges */
+    inline void clear() noexcept { mRanges.clear(); }
+
+    /**
+     * Returns an iterator to the range containing the given index, or end() if none
+     * Complexity: O(log n)
+     */
+    [[nodiscard]] iterator find(const uint64_t index) noexcept
+    {
+        iterator it { mRanges.upper_bound(index) };
+        if (it == mRanges.begin()) return mRanges.end();
+        --it; return (index < it->first + it->second.count) ? it : mRanges.end();
+    }
+
+    /**
+     * Returns an iterator to the range containing the given index, or end() if none
+     * Complexity: O(log n)
+     */
+    [[nodiscard]] const_iterator find(const uint64_t index) const noexcept
+    {
+        const_iterator it { mRanges.upper_bound(index) };
+        if (it == mRanges.begin()) return mRanges.end();
+        --it; return (index < it->first + it->second.count) ? it : mRanges.end();
+    }
+
+    /** Returns true if the given index is in any range - O(log n) */
+    [[nodiscard]] inline bool contains(const uint64_t index) const noexcept { return find(index) != end(); }
+
+    /**
+     * Returns an iterator to the first range that overlaps or is after the given index
+     * Complexity: O(log n)
+     */
+    [[nodiscard]] iterator lower_bound(const uint64_t index) noexcept
+    {
+        iterator it { mRanges.upper_bound(index) };
+        if (it != mRanges.begin())
+        {
+            const iterator prev { std::prev(it) };
+            if (index < prev->first + prev->second.count) return prev;
+        }
+        return it;
+    }
+
+    /**
+     * Returns an iterator to the first range that overlaps or is after the given index
+     * Complexity: O(log n)
+     */
+    [[nodiscard]] const_iterator lower_bound(const uint64_t index) const noexcept
+    {
+        const_iterator it { mRanges.upper_bound(index) };
+        if (it != mRanges.begin())
+        {
+            const const_iterator prev { std::prev(it) };
+            if (index < prev->first + prev->second.count) return prev;
+        }
+        return it;
+    }
+
+    /**
+     * Sets the value for the given range, replacing any overlapping ranges
+     * @return iterator to the new range
+     * Complexity: O(log n + m) where m is the number of overlapped ranges
+     */
+    iterator assign(const uint64_t start, const uint64_t count, T value)
+    {
+        erase(start, count);
+        return mRanges.emplace(start, Range{count, std::move(value)}).first;
+    }
+
+    /**
+     * Erases the given range, trimming or splitting any overlapping ranges
+     * @return the number of indexes that were erased
+     * Complexity: O(log n + m) where m is the number of overlapped ranges
+     */
+    uint64_t erase(const uint64_t start, const uint64_t count)
+    {
+        const uint64_t end { start + count };
+        uint64_t erased { 0 };
+
+        for (iterator it { lower_bound(start) }; it != mRanges.end() && it->first < end; )
+        {
+            const uint64_t rstart { it->first };
+            const uint64_t rend { rstart + it->second.count };
+            Range range { std::move(it->second) };
+            it = mRanges.erase(it);
+
+            erased += std::min(rend, end) - std::max(rstart, start);
+            if (rend > end) // keep the part after the erased range
+                it = mRanges.emplace_hint(it, end, Range{rend-end, range.value});
+            if (rstart < start) // keep the part before the erased range
+                mRanges.emplace_hint(it, rstart, Range{start-rstart, std::move(range.value)});
+        }
+        return erased;
+    }
+
+    /**
+     * Erases the range pointed to by the given iterator
+     * @return iterator pointing to the next range
+     */
+    inline iterator erase(const const_iterator& it) noexcept { return mRanges.erase(it); }
+
+private:
+
+    /** Map of range start to range */
+    RangeList mRanges;
+};
+
+} // namespace Andromeda
+
+#endif // LIBA2_RANGEMAP_H_
@@ -0,0 +1,103 @@
+#ifndef LIBA2_SINGLEFLIGHT_H_
+#define LIBA2_SINGLEFLIGHT_H_
+
+#include <exception>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <utility>
+
+#include "andromeda/common.hpp"
+
+namespace Andromeda {
+
+/**
+ * Coalesces concurrent identical calls (request "single flight")
+ * The first caller for a key runs the function while later callers with the same key wait
+ * for and share its result (or exception) instead of running it again. Once finished the key
+ * is removed, so calls starting after that run the function again and never get a stale result.
+ * Only for idempotent operations whose result does not depend on which caller runs it!
+ * THREAD SAFE (INTERNAL LOCKS)
+ * @tparam K the key type identifying identical calls - must be ordered
+ * @tparam V the result type - must be copyable (each caller gets a copy)
+ */
+template<typename K, typename V>
+class SingleFlight
+{
+public:
+
+    using Func = std::function<V()>;
+
+    SingleFlight() = default;
+    ~SingleFlight() = default;
+    DELETE_COPY(SingleFlight)
+    DELETE_MOVE(SingleFlight)
+
+    /**
+     * Returns the result of the given function, or of the one already running for the key
+     * @param key the key identifying identical calls
+     * @param func the function to run if not already running
+     * @param[out] shared if not null, set to true if the result came from another caller
+     * @throws any exception thrown by the function (in all waiting callers)
+     */
+    V Run(const K& key, const Func& func, bool* shared = nullptr)
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        const typename FlightMap::const_iterator it { mFlights.find(key) };
+        if (it != mFlights.end())
+        {
+            const std::shared_future<V> future { it->second }; // copy
+            lock.unlock();
+
+            if (shared != nullptr) *shared = true;
+            return future.get();
+        }
+
+        std::promise<V> promise;
+        mFlights.emplace(key, promise.get_future().share());
+        lock.unlock();
+
+        if (shared != nullptr) *shared = false;
+        try
+        {
+            V value { func() };
+            Finish(key);
+            promise.set_value(value);
+            return value;
+        }
+        catch (...)
+        {
+            Finish(key);
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+    }
+
+    /** Returns the number of calls currently running */
+    [[nodiscard]] size_t size() const
+    {
+        const std::lock_guard<std::mutex> lock(mMutex);
+        return mFlights.size();
+    }
+
+private:
+
+    /** Removes the given key so new calls run again (waiters keep their future) */
+    void Finish(const K& key)
+    {
+        const std::lock_guard<std::mutex> lock(mMutex);
+        mFlights.erase(key);
+    }
+
+    using FlightMap = std::map<K, std::shared_future<V>>;
+    /** Map of running calls to their result */
+    FlightMap mFlights;
+    /** Mutex that protects mFlights */
+    mutable std::mutex mMutex;
+};
+
+} // namespace Andromeda
+
+#endif // LIBA2_SINGLEFLIGHT_H_
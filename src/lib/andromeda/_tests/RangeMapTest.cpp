@@ -0,0 +1,82 @@
+
+#include <string>
+
+#include "catch2/catch_test_macros.hpp"
+
+#include "RangeMap.hpp"
+
+namespace Andromeda {
+namespace { // anonymous
+
+using TestMap = RangeMap<std::string>;
+
+/*****************************************************/
+TEST_CASE("Find", "[RangeMap]")
+{
+    TestMap map;
+    REQUIRE(map.empty());
+    REQUIRE(map.find(0) == map.end());
+
+    map.assign(10, 5, "a"); // 10-14
+    map.assign(20, 1, "b"); // 20
+    REQUIRE(map.size() == 2);
+
+    REQUIRE(!map.contains(9));
+    REQUIRE(map.find(10)->second.value == "a");
+    REQUIRE(map.find(14)->first == 10);
+    REQUIRE(!map.contains(15));
+    REQUIRE(map.find(20)->second.value == "b");
+    REQUIRE(!map.contains(21));
+
+    REQUIRE(map.lower_bound(0)->first == 10);
+    REQUIRE(map.lower_bound(12)->first == 10);
+    REQUIRE(map.lower_bound(15)->first == 20);
+    REQUIRE(map.lower_bound(21) == map.end());
+}
+
+/*****************************************************/
+TEST_CASE("Erase", "[RangeMap]")
+{
+    TestMap map;
+    map.assign(10, 10, "a"); // 10-19
+
+    REQUIRE(map.erase(10, 1) == 1); // trim front
+    REQUIRE(map.begin()->first == 11);
+    REQUIRE(map.begin()->second.count == 9);
+
+    REQUIRE(map.erase(14, 2) == 2); // split
+    REQUIRE(map.size() == 2);
+    REQUIRE(map.find(13)->second.count == 3); // 11-13
+    REQUIRE(!map.contains(14));
+    REQUIRE(!map.contains(15));
+    REQUIRE(map.find(16)->first == 16); // 16-19
+    REQUIRE(map.find(19)->second.value == "a");
+
+    REQUIRE(map.erase(0, 100) == 7); // all
+    REQUIRE(map.empty());
+
+    map.assign(5, 5, "x");
+    REQUIRE(map.erase(map.find(7)) == map.end());
+    REQUIRE(map.empty());
+}
+
+/*****************************************************/
+TEST_CASE("Assign", "[RangeMap]")
+{
+    TestMap map;
+    map.assign(0, 4, "a");  // 0-3
+    map.assign(6, 4, "b");  // 6-9
+    map.assign(12, 4, "c"); // 12-15
+
+    map.assign(2, 12, "d"); // 2-13 replaces overlaps
+    REQUIRE(map.size() == 3);
+    REQUIRE(map.find(1)->second.value == "a");
+    REQUIRE(map.find(1)->second.count == 2);
+    REQUIRE(map.find(2)->second.value == "d");
+    REQUIRE(map.find(13)->second.value == "d");
+    REQUIRE(map.find(14)->second.value == "c");
+    REQUIRE(map.find(14)->first == 14);
+}
+
+} // namespace
+} // namespace Andromeda
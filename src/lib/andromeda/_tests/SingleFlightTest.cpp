@@ -0,0 +1,98 @@
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch2/catch_test_macros.hpp"
+
+#include "SingleFlight.hpp"
+
+namespace Andromeda {
+namespace { // anonymous
+
+using TestFlight = SingleFlight<std::string, std::string>;
+
+/*****************************************************/
+TEST_CASE("Single", "[SingleFlight]")
+{
+    TestFlight flight;
+    bool shared { true };
+    REQUIRE(flight.Run("a", [](){ return std::string("1"); }, &shared) == "1");
+    REQUIRE(!shared);
+    REQUIRE(flight.size() == 0);
+
+    // finished calls are not cached
+    REQUIRE(flight.Run("a", [](){ return std::string("2"); }) == "2");
+
+    REQUIRE_THROWS_AS(flight.Run("a", []()->std::string{ throw std::runtime_error("fail"); }), std::runtime_error);
+    REQUIRE(flight.size() == 0);
+    REQUIRE(flight.Run("a", [](){ return std::string("3"); }) == "3");
+}
+
+/*****************************************************/
+TEST_CASE("Coalesce", "[SingleFlight]")
+{
+    TestFlight flight;
+    std::atomic<int> calls { 0 };
+    std::promise<void> release;
+    std::shared_future<void> releaseF { release.get_future() };
+
+    const TestFlight::Func func { [&]()
+    {
+        ++calls; releaseF.wait();
+        return std::string("result");
+    } };
+
+    std::vector<std::future<std::string>> results;
+    for (size_t i { 0 }; i < 8; ++i)
+        results.emplace_back(std::async(std::launch::async, [&](){ return flight.Run("key", func); }));
+
+    // a different key is not coalesced
+    std::future<std::string> other { std::async(std::launch::async, 
+        [&](){ return flight.Run("other", func); }) };
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100)); // let all callers start
+    REQUIRE(flight.size() == 2);
+    release.set_value();
+
+    for (std::future<std::string>& result : results)
+        REQUIRE(result.get() == "result");
+    REQUIRE(other.get() == "result");
+    REQUIRE(calls == 2);
+    REQUIRE(flight.size() == 0);
+}
+
+/*****************************************************/
+TEST_CASE("CoalesceException", "[SingleFlight]")
+{
+    TestFlight flight;
+    std::promise<void> started;
+    std::promise<void> release;
+    std::shared_future<void> releaseF { release.get_future() };
+
+    std::future<std::string> first { std::async(std::launch::async, [&](){ 
+        return flight.Run("key", [&]()->std::string
+        {
+            started.set_value(); releaseF.wait();
+            throw std::runtime_error("fail");
+        }); }) };
+    started.get_future().wait(); // now in flight
+
+    bool shared { false };
+    std::future<std::string> second { std::async(std::launch::async, [&](){ 
+        return flight.Run("key", [](){ return std::string("not run"); }, &shared); }) };
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100)); // let the second caller start
+    release.set_value();
+
+    REQUIRE_THROWS_AS(first.get(), std::runtime_error);
+    REQUIRE_THROWS_AS(second.get(), std::runtime_error);
+    REQUIRE(shared);
+}
+
+} // namespace
+} // namespace Andromeda
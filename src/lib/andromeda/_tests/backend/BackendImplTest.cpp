@@ -0,0 +1,85 @@
+
+#include <array>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "catch2/catch_test_macros.hpp"
+#include "nlohmann/json.hpp"
+
+#include "andromeda/ConfigOptions.hpp"
+#include "andromeda/backend/BackendImpl.hpp"
+#include "andromeda/backend/BaseRunner.hpp"
+#include "andromeda/backend/RunnerInput.hpp"
+#include "andromeda/backend/RunnerPool.hpp"
+
+namespace Andromeda {
+namespace Backend {
+namespace { // anonymous
+
+/** A runner that returns a minimal server config and records uploaded file data */
+class FakeRunner : public BaseRunner
+{
+public:
+    explicit FakeRunner(std::shared_ptr<std::string> data) : mData(std::move(data)) { }
+    ~FakeRunner() override = default;
+    DELETE_COPY(FakeRunner)
+    DELETE_MOVE(FakeRunner)
+
+    [[nodiscard]] std::unique_ptr<BaseRunner> Clone() const override { return std::make_unique<FakeRunner>(mData); }
+    [[nodiscard]] std::string GetHostname() const override { return "fake"; }
+
+    std::string RunAction_Read(const RunnerInput& input) override
+    {
+        if (input.app == "core" && input.action == "getconfig") return R"({"ok":true,"appdata":
+            {"api":2,"apps":{"core":1,"accounts":1,"files":1},"features":{"read_only":false}}})";
+        if (input.app == "files" && input.action == "getconfig") return R"({"ok":true,"appdata":
+            {"upload_maxbytes":null}})";
+        return R"({"ok":true,"appdata":null})";
+    }
+
+    std::string RunAction_Write(const RunnerInput& input) override { return R"({"ok":true,"appdata":null})"; }
+    std::string RunAction_FilesIn(const RunnerInput_FilesIn& input) override { return R"({"ok":true,"appdata":null})"; }
+
+    std::string RunAction_StreamIn(const RunnerInput_StreamIn& input) override
+    {
+        for (const RunnerInput_StreamIn::FileStreams::value_type& fstream : input.fstreams)
+        {
+            std::array<char,4> buf {}; size_t offset { 0 };
+            for (bool more { true }; more; )
+            {
+                size_t read { 0 };
+                more = fstream.second.streamer(offset, buf.data(), buf.size(), read);
+                mData->append(buf.data(), read); offset += read;
+            }
+        }
+        return R"({"ok":true,"appdata":{"id":"file1"}})";
+    }
+
+    void RunAction_StreamOut(const RunnerInput_StreamOut& input) override { }
+    [[nodiscard]] bool RequiresSession() const override { return false; }
+
+private:
+    /** The uploaded data, shared with clones */
+    const std::shared_ptr<std::string> mData;
+};
+
+/*****************************************************/
+TEST_CASE("UploadStreamOneshot", "[BackendImpl]")
+{
+    const std::shared_ptr<std::string> uploaded { std::make_shared<std::string>() };
+    FakeRunner runner(uploaded); ConfigOptions options;
+    options.uploadStreamBuffer = 16;
+    RunnerPool pool(runner, options);
+    BackendImpl backend(options, pool);
+
+    // a oneshot upload can't be chunked, so it must not be limited to the stream buffer
+    const std::string data(100, 'a');
+    const WriteFunc userFunc { RunnerInput_StreamIn::FromString(data) };
+    REQUIRE(backend.UploadFile("parent", "name", userFunc, true, false, true).at("id") == "file1");
+    REQUIRE(*uploaded == data);
+}
+
+} // namespace
+} // namespace Backend
+} // namespace Andromeda
@@ -0,0 +1,56 @@
+
+#include <chrono>
+#include <cmath>
+
+#include "catch2/catch_test_macros.hpp"
+
+#include "andromeda/backend/BandwidthEstimator.hpp"
+
+namespace Andromeda {
+namespace Backend {
+namespace { // anonymous
+
+using std::chrono::milliseconds;
+
+/** Returns true if the given values are within 0.1% (avoids float rounding issues) */
+bool Near(const double val, const double expect)
+{
+    return std::abs(val-expect) <= expect/1000;
+}
+
+/*****************************************************/
+TEST_CASE("Empty", "[BandwidthEstimator]")
+{
+    const BandwidthEstimator est;
+    REQUIRE(est.GetThroughput() == 0);
+    REQUIRE(est.GetRTT() == BandwidthEstimator::Duration::zero());
+    REQUIRE(est.GetTargetBytes(milliseconds(1000)) == 0);
+}
+
+/*****************************************************/
+TEST_CASE("Samples", "[BandwidthEstimator]")
+{
+    BandwidthEstimator est;
+
+    // 1MB in 100ms after 50ms of latency = 10MB/s
+    est.AddSample(1000000, milliseconds(50), milliseconds(150));
+    REQUIRE(Near(est.GetThroughput(), 10000000));
+    REQUIRE(est.GetRTT() == milliseconds(50));
+
+    // 1 second minus the RTT
+    REQUIRE(Near(static_cast<double>(est.GetTargetBytes(milliseconds(1000))), 9500000));
+    REQUIRE(est.GetTargetBytes(milliseconds(50)) == 0); // all latency
+
+    // small samples only update the RTT
+    est.AddSample(4096, milliseconds(250), milliseconds(251));
+    REQUIRE(Near(est.GetThroughput(), 10000000));
+    REQUIRE(est.GetRTT() == milliseconds(100)); // 50 + (250-50)/4
+
+    // 20MB/s moves a quarter of the way
+    est.AddSample(2000000, milliseconds(100), milliseconds(200));
+    REQUIRE(Near(est.GetThroughput(), 12500000));
+}
+
+} // namespace
+} // namespace Backend
+} // namespace Andromeda
@@ -0,0 +1,110 @@
+
+#include <chrono>
+
+#include "catch2/catch_test_macros.hpp"
+
+#include "andromeda/backend/ConcurrencyLimit.hpp"
+
+namespace Andromeda {
+namespace Backend {
+namespace { // anonymous
+
+using Clock = ConcurrencyLimit::Clock;
+using std::chrono::milliseconds;
+
+/** Adds the given number of successful results without latency */
+void AddSuccesses(ConcurrencyLimit& limit, const size_t count, const Clock::time_point& now)
+{
+    for (size_t i { 0 }; i < count; ++i)
+        limit.AddResult(false, std::nullopt, now);
+}
+
+/*****************************************************/
+TEST_CASE("Fixed", "[ConcurrencyLimit]")
+{
+    ConcurrencyLimit limit(4, 4);
+    REQUIRE(limit.GetLimit() == 4);
+
+    const Clock::time_point now { Clock::now() };
+    limit.AddResult(true, std::nullopt, now);
+    REQUIRE(limit.GetLimit() == 4);
+
+    ConcurrencyLimit limit2(0, 0); // never zero
+    REQUIRE(limit2.GetLimit() == 1);
+}
+
+/*****************************************************/
+TEST_CASE("Increase", "[ConcurrencyLimit]")
+{
+    ConcurrencyLimit limit(1, 3);
+    REQUIRE(limit.GetLimit() == 1);
+    const Clock::time_point now { Clock::now() };
+
+    AddSuccesses(limit, 5, now); // no waiting
+    REQUIRE(limit.GetLimit() == 1);
+
+    limit.AddWait(); AddSuccesses(limit, 1, now); // a round of 1
+    REQUIRE(limit.GetLimit() == 2);
+
+    limit.AddWait(); AddSuccesses(limit, 1, now);
+    REQUIRE(limit.GetLimit() == 2); // needs a round of 2
+    AddSuccesses(limit, 1, now);
+    REQUIRE(limit.GetLimit() == 3);
+
+    limit.AddWait(); AddSuccesses(limit, 3, now);
+    REQUIRE(limit.GetLimit() == 3); // max
+}
+
+/*****************************************************/
+TEST_CASE("Overload", "[ConcurrencyLimit]")
+{
+    ConcurrencyLimit limit(1, 8);
+    Clock::time_point now { Clock::now() };
+
+    for (size_t round { 0 }; round < 7; ++round)
+        { limit.AddWait(); AddSuccesses(limit, limit.GetLimit(), now); }
+    REQUIRE(limit.GetLimit() == 8);
+
+    limit.AddResult(true, std::nullopt, now);
+    REQUIRE(limit.GetLimit() == 4);
+    limit.AddResult(true, std::nullopt, now); // within cooldown
+    REQUIRE(limit.GetLimit() == 4);
+
+    now += ConcurrencyLimit::DECREASE_COOLDOWN;
+    limit.AddResult(true, std::nullopt, now);
+    REQUIRE(limit.GetLimit() == 2);
+
+    now += ConcurrencyLimit::DECREASE_COOLDOWN;
+    limit.AddResult(true, std::nullopt, now);
+    now += ConcurrencyLimit::DECREASE_COOLDOWN;
+    limit.AddResult(true, std::nullopt, now);
+    REQUIRE(limit.GetLimit() == 1); // min
+}
+
+/*****************************************************/
+TEST_CASE("Latency", "[ConcurrencyLimit]")
+{
+    ConcurrencyLimit limit(1, 8);
+    Clock::time_point now { Clock::now() };
+
+    for (size_t round { 0 }; round < 4; ++round)
+        { limit.AddWait(); AddSuccesses(limit, limit.GetLimit(), now); }
+    REQUIRE(limit.GetLimit() == 5);
+
+    for (size_t i { 0 }; i < 4; ++i)
+        limit.AddResult(false, milliseconds(10), now);
+    REQUIRE(limit.GetLimit() == 5); // baseline
+
+    // latency rising well above the baseline backs off by one at a time
+    for (size_t i { 0 }; i < 8; ++i)
+        limit.AddResult(false, milliseconds(200), now);
+    REQUIRE(limit.GetLimit() == 4);
+
+    now += ConcurrencyLimit::DECREASE_COOLDOWN;
+    limit.AddResult(false, milliseconds(200), now);
+    REQUIRE(limit.GetLimit() == 3);
+}
+
+} // namespace
+} // namespace Backend
+} // namespace Andromeda
@@ -0,0 +1,171 @@
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch2/catch_test_macros.hpp"
+
+#include "andromeda/ConfigOptions.hpp"
+#include "andromeda/backend/BaseRunner.hpp"
+#include "andromeda/backend/RunnerPool.hpp"
+
+namespace Andromeda {
+namespace Backend {
+namespace { // anonymous
+
+using Priority = RunnerPool::Priority;
+
+/** A runner that does nothing, for testing the pool */
+class FakeRunner : public BaseRunner
+{
+public:
+    FakeRunner() = default;
+    ~FakeRunner() override = default;
+    DELETE_COPY(FakeRunner)
+    DELETE_MOVE(FakeRunner)
+
+    [[nodiscard]] std::unique_ptr<BaseRunner> Clone() const override { return std::make_unique<FakeRunner>(); }
+    [[nodiscard]] std::string GetHostname() const override { return "fake"; }
+    std::string RunAction_Read(const RunnerInput& input) override { return ""; }
+    std::string RunAction_Write(const RunnerInput& input) override { return ""; }
+    std::string RunAction_FilesIn(const RunnerInput_FilesIn& input) override { return ""; }
+    std::string RunAction_StreamIn(const RunnerInput_StreamIn& input) override { return ""; }
+    void RunAction_StreamOut(const RunnerInput_StreamOut& input) override { }
+    [[nodiscard]] bool RequiresSession() const override { return false; }
+};
+
+constexpr std::chrono::milliseconds WAIT_TIME { 100 };
+
+/*****************************************************/
+TEST_CASE("Basic", "[RunnerPool]")
+{
+    FakeRunner runner; ConfigOptions options;
+    options.runnerPoolSize = 2;
+    RunnerPool pool(runner, options);
+
+    { RunnerPool::LockedRunner runner1 { pool.GetRunner() };
+        REQUIRE(&*runner1 == &runner); // first is used first
+        RunnerPool::LockedRunner runner2 { pool.GetRunner() };
+        REQUIRE(&*runner2 != &runner); // cloned
+    }
+
+    RunnerPool::LockedRunner runner1 { pool.GetRunner() };
+    REQUIRE(&*runner1 == &runner);
+}
+
+/*****************************************************/
+TEST_CASE("Priority", "[RunnerPool]")
+{
+    FakeRunner runner; ConfigOptions options;
+    options.runnerPoolSize = 1;
+    RunnerPool pool(runner, options);
+
+    std::mutex orderMutex; std::vector<Priority> order;
+    const auto getRunner { [&](const Priority priority)
+    {
+        const RunnerPool::LockedRunner locked { pool.GetRunner(priority) };
+        const std::lock_guard<std::mutex> lock(orderMutex);
+        order.push_back(priority);
+    } };
+
+    std::future<void> writeback; std::future<void> interactive;
+    { const RunnerPool::LockedRunner locked { pool.GetRunner() };
+        writeback = std::async(std::launch::async, getRunner, Priority::WRITEBACK);
+        std::this_thread::sleep_for(WAIT_TIME);
+        interactive = std::async(std::launch::async, getRunner, Priority::INTERACTIVE);
+        std::this_thread::sleep_for(WAIT_TIME);
+    } // release, the later higher priority waiter goes first
+
+    writeback.wait(); interactive.wait();
+    REQUIRE(order == std::vector<Priority>{ Priority::INTERACTIVE, Priority::WRITEBACK });
+}
+
+/*****************************************************/
+TEST_CASE("PriorityScope", "[RunnerPool]")
+{
+    FakeRunner runner; ConfigOptions options;
+    options.runnerPoolSize = 2;
+    options.reserveRunner = true;
+    RunnerPool pool(runner, options);
+
+    std::future<void> background;
+    { const RunnerPool::PriorityScope priority(Priority::READAHEAD);
+        RunnerPool::LockedRunner runner1 { pool.GetRunner() }; // overridden to READAHEAD
+        REQUIRE(&*runner1 != &runner); // first is reserved
+
+        // a second background request can't use the reserved runner
+        background = std::async(std::launch::async, [&]()
+        {
+            const RunnerPool::PriorityScope priority2(Priority::WRITEBACK);
+            const RunnerPool::LockedRunner runner2 { pool.GetRunner() };
+        });
+        REQUIRE(background.wait_for(WAIT_TIME) == std::future_status::timeout);
+
+        { // but a foreground request can
+            const RunnerPool::PriorityScope priority2(Priority::FOREGROUND);
+            RunnerPool::LockedRunner runner2 { pool.GetRunner() };
+            REQUIRE(&*runner2 == &runner);
+        }
+    }
+
+    background.wait();
+}
+
+/*****************************************************/
+TEST_CASE("Stream", "[RunnerPool]")
+{
+    FakeRunner runner; ConfigOptions options;
+    options.runnerPoolSize = 2;
+    RunnerPool pool(runner, options);
+
+    std::future<void> background;
+    { RunnerPool::StreamRunner stream { pool.GetStreamRunner() };
+        REQUIRE(&*stream != &runner); // not from the pool
+
+        const RunnerPool::PriorityScope priority(Priority::READAHEAD);
+        const RunnerPool::LockedRunner runner1 { pool.GetRunner() };
+
+        // the stream counts against the limit for background requests
+        background = std::async(std::launch::async, [&](){
+            const RunnerPool::LockedRunner runner2 { pool.GetRunner(Priority::WRITEBACK) }; });
+        REQUIRE(background.wait_for(WAIT_TIME) == std::future_status::timeout);
+
+        { // but not for foreground requests
+            const RunnerPool::PriorityScope priority2(Priority::FOREGROUND);
+            const RunnerPool::LockedRunner runner2 { pool.GetRunner() };
+        }
+        REQUIRE(background.wait_for(WAIT_TIME) == std::future_status::timeout);
+    } // the stream ends
+
+    background.wait();
+}
+
+/*****************************************************/
+TEST_CASE("Adaptive", "[RunnerPool]")
+{
+    FakeRunner runner; ConfigOptions options;
+    options.runnerPoolSize = 2;
+    options.runnerPoolMin = 1;
+    RunnerPool pool(runner, options);
+
+    std::future<void> waiter;
+    { const RunnerPool::LockedRunner runner1 { pool.GetRunner() };
+        // starts at the minimum so the second request waits
+        waiter = std::async(std::launch::async, [&](){ 
+            const RunnerPool::LockedRunner runner2 { pool.GetRunner() }; });
+        REQUIRE(waiter.wait_for(WAIT_TIME) == std::future_status::timeout);
+    } // a round with waiting increases the limit
+
+    waiter.wait();
+    RunnerPool::LockedRunner runner1 { pool.GetRunner() };
+    RunnerPool::LockedRunner runner2 { pool.GetRunner() }; // no wait
+    REQUIRE(&*runner1 != &*runner2);
+}
+
+} // namespace
+} // namespace Backend
+} // namespace Andromeda
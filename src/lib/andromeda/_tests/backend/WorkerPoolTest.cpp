@@ -0,0 +1,123 @@
+
+#include <atomic>
+#include <future>
+#include <sstream>
+#include <string>
+
+#include "catch2/catch_test_macros.hpp"
+
+#include "andromeda/backend/WorkerPool.hpp"
+
+namespace Andromeda {
+namespace Backend {
+namespace { // anonymous
+
+using TaskType = WorkerPool::TaskType;
+
+/*****************************************************/
+TEST_CASE("Basic", "[WorkerPool]")
+{
+    std::atomic<int> count { 0 };
+    std::promise<void> done;
+
+    { WorkerPool pool(2, 16);
+        const int owner { 0 };
+
+        for (size_t i { 0 }; i < 9; ++i)
+            REQUIRE(pool.TrySubmit(TaskType::FETCH, &owner, [&](){ ++count; }));
+        REQUIRE(pool.TrySubmit(TaskType::FETCH, &owner, [&](){ ++count; done.set_value(); }));
+
+        done.get_future().wait();
+        REQUIRE(pool.GetWorkerCount() >= 1);
+        REQUIRE(pool.GetWorkerCount() <= 2);
+    } // join workers
+
+    REQUIRE(count == 10);
+}
+
+/*****************************************************/
+TEST_CASE("QueueLimit", "[WorkerPool]")
+{
+    std::promise<void> started;
+    std::promise<void> release;
+    std::shared_future<void> releaseF { release.get_future() };
+    bool ran2 { false }; bool ran3 { false };
+
+    WorkerPool pool(1, 1); // after futures, join first
+    const int owner1 { 0 };
+    const int owner2 { 0 };
+
+    // occupy the only worker
+    REQUIRE(pool.TrySubmit(TaskType::FETCH, &owner1, [&](){ started.set_value(); releaseF.wait(); }));
+    started.get_future().wait();
+
+    REQUIRE(pool.TrySubmit(TaskType::FLUSH, &owner2, [&](){ ran2 = true; }));
+    REQUIRE(!pool.TrySubmit(TaskType::FLUSH, &owner2, [&](){ ran3 = true; })); // full
+
+    REQUIRE(pool.GetStats(TaskType::FETCH).running == 1);
+    REQUIRE(pool.GetStats(TaskType::FLUSH).queued == 1);
+    REQUIRE(pool.GetStats(TaskType::FLUSH).rejected == 1);
+
+    // the caller can run its own queued task
+    REQUIRE(!pool.RunQueued(&owner1));
+    REQUIRE(pool.RunQueued(&owner2));
+    REQUIRE(ran2); REQUIRE(!ran3);
+    REQUIRE(!pool.RunQueued(&owner2));
+
+    const WorkerPool::Stats stats { pool.GetStats(TaskType::FLUSH) };
+    REQUIRE(stats.queued == 0);
+    REQUIRE(stats.submitted == 1);
+    REQUIRE(stats.completed == 1);
+
+    release.set_value();
+}
+
+/*****************************************************/
+TEST_CASE("CancelQueued", "[WorkerPool]")
+{
+    std::promise<void> started;
+    std::promise<void> release;
+    std::shared_future<void> releaseF { release.get_future() };
+    std::atomic<int> count { 0 };
+
+    WorkerPool pool(1, 8); // after futures, join first
+    const int owner1 { 0 };
+    const int owner2 { 0 };
+
+    REQUIRE(pool.TrySubmit(TaskType::FETCH, &owner1, [&](){ started.set_value(); releaseF.wait(); }));
+    started.get_future().wait();
+
+    for (size_t i { 0 }; i < 3; ++i)
+        REQUIRE(pool.TrySubmit(TaskType::FETCH, &owner2, [&](){ ++count; }));
+    REQUIRE(pool.TrySubmit(TaskType::FETCH, &owner1, [&](){ ++count; }));
+
+    REQUIRE(pool.CancelQueued(&owner2) == 3);
+    REQUIRE(pool.CancelQueued(&owner2) == 0);
+    REQUIRE(pool.GetStats(TaskType::FETCH).cancelled == 3);
+    REQUIRE(pool.GetStats(TaskType::FETCH).queued == 1);
+
+    REQUIRE(pool.RunQueued(&owner1));
+    REQUIRE(count == 1);
+
+    release.set_value();
+}
+
+/*****************************************************/
+TEST_CASE("PrintStats", "[WorkerPool]")
+{
+    WorkerPool pool(1, 0); // nothing can queue
+    const int owner { 0 };
+    REQUIRE(!pool.TrySubmit(TaskType::FLUSH, &owner, [](){ }));
+
+    std::ostringstream out;
+    pool.PrintStats(out);
+    const std::string str { out.str() };
+
+    REQUIRE(str.find("workers: 0") != std::string::npos);
+    REQUIRE(str.find("fetch: (queued:0 running:0 submitted:0 rejected:0") != std::string::npos);
+    REQUIRE(str.find("flush: (queued:0 running:0 submitted:0 rejected:1") != std::string::npos);
+}
+
+} // namespace
+} // namespace Backend
+} // namespace Andromeda
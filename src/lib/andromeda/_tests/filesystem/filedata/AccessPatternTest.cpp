@@ -0,0 +1,96 @@
+
+#include <initializer_list>
+
+#include "catch2/catch_test_macros.hpp"
+
+#include "andromeda/filesystem/filedata/AccessPattern.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+namespace { // anonymous
+
+using Type = AccessPattern::Type;
+
+/** Accesses each of the given indexes in order and returns the final type */
+Type AccessAll(AccessPattern& pattern, std::initializer_list<uint64_t> indexes)
+{
+    for (const uint64_t index : indexes)
+        pattern.Access(index);
+    return pattern.GetType();
+}
+
+/*****************************************************/
+TEST_CASE("Sequential", "[AccessPattern]")
+{
+    AccessPattern pattern("test");
+    REQUIRE(pattern.GetType() == Type::SEQUENTIAL); // default
+
+    REQUIRE(AccessAll(pattern, {0, 0, 1, 1, 1, 2, 3, 4, 5}) == Type::SEQUENTIAL);
+    REQUIRE(pattern.GetStride() == 0);
+
+    // slightly out of order is still sequential
+    AccessPattern pattern2("test");
+    REQUIRE(AccessAll(pattern2, {5, 7, 6, 8, 10, 9, 11}) == Type::SEQUENTIAL);
+}
+
+/*****************************************************/
+TEST_CASE("Reverse", "[AccessPattern]")
+{
+    AccessPattern pattern("test");
+    REQUIRE(AccessAll(pattern, {100, 99, 98, 97, 96}) == Type::REVERSE);
+    REQUIRE(pattern.GetStride() == 0);
+
+    REQUIRE(AccessAll(pattern, {97, 98, 99, 100, 101, 102, 103, 104}) == Type::SEQUENTIAL);
+}
+
+/*****************************************************/
+TEST_CASE("Strided", "[AccessPattern]")
+{
+    AccessPattern pattern("test");
+    REQUIRE(AccessAll(pattern, {0, 10, 20, 30, 40}) == Type::STRIDED);
+    REQUIRE(pattern.GetStride() == 10);
+
+    AccessPattern pattern2("test");
+    REQUIRE(AccessAll(pattern2, {1000, 900, 800, 700}) == Type::STRIDED);
+    REQUIRE(pattern2.GetStride() == -100);
+}
+
+/*****************************************************/
+TEST_CASE("Random", "[AccessPattern]")
+{
+    AccessPattern pattern("test");
+    REQUIRE(AccessAll(pattern, {0, 1, 2, 3}) == Type::SEQUENTIAL);
+    REQUIRE(AccessAll(pattern, {500, 17, 9000, 3, 77777, 42, 1234, 800}) == Type::RANDOM);
+    REQUIRE(pattern.GetStride() == 0);
+
+    // a few seeks do not break a sequential stream
+    REQUIRE(AccessAll(pattern, {50, 51, 52, 53, 54, 55, 56, 57}) == Type::SEQUENTIAL);
+    REQUIRE(AccessAll(pattern, {9000, 9001, 9002, 9003}) == Type::SEQUENTIAL);
+}
+
+/*****************************************************/
+TEST_CASE("Jump", "[AccessPattern]")
+{
+    AccessPattern pattern("test");
+    REQUIRE(!pattern.isJump());
+
+    AccessAll(pattern, {0, 1, 2, 3}); REQUIRE(!pattern.isJump());
+    pattern.Access(5); REQUIRE(!pattern.isJump()); // within slack
+    pattern.Access(5); REQUIRE(!pattern.isJump()); // same page
+    pattern.Access(500); REQUIRE(pattern.isJump());
+    pattern.Access(501); REQUIRE(!pattern.isJump());
+    pattern.Access(100); REQUIRE(pattern.isJump()); // backwards
+
+    // the current stride is not a jump, but leaving it is
+    AccessPattern pattern2("test");
+    REQUIRE(AccessAll(pattern2, {0, 10, 20, 30, 40}) == Type::STRIDED);
+    REQUIRE(!pattern2.isJump());
+    pattern2.Access(50); REQUIRE(!pattern2.isJump());
+    pattern2.Access(5000); REQUIRE(pattern2.isJump());
+}
+
+} // namespace
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
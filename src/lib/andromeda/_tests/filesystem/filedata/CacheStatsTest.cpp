@@ -0,0 +1,111 @@
+
+#include <chrono>
+#include <sstream>
+#include <string>
+
+#include "catch2/catch_test_macros.hpp"
+
+#include "andromeda/filesystem/filedata/CacheStats.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+namespace { // anonymous
+
+using EvictReason = CacheStats::EvictReason;
+using std::chrono::milliseconds;
+
+/*****************************************************/
+TEST_CASE("Parent", "[CacheStats]")
+{
+    CacheStats parent;
+    CacheStats child1(&parent);
+    CacheStats child2(&parent);
+
+    child1.AddHit(); child1.AddHit(); child1.AddMiss();
+    child2.AddHit(); child2.AddPendingWait(); child2.AddFetched();
+    child2.AddMemoryWait(milliseconds(3));
+
+    const CacheStats::Values values1 { child1.GetValues() };
+    REQUIRE(values1.pageHits == 2);
+    REQUIRE(values1.pageMisses == 1);
+    REQUIRE(values1.pendingWaits == 0);
+
+    const CacheStats::Values values2 { child2.GetValues() };
+    REQUIRE(values2.pageHits == 1);
+    REQUIRE(values2.pendingWaits == 1);
+    REQUIRE(values2.pagesFetched == 1);
+    REQUIRE(values2.memoryWaitTime == 3000);
+
+    const CacheStats::Values pvalues { parent.GetValues() };
+    REQUIRE(pvalues.pageHits == 3);
+    REQUIRE(pvalues.pageMisses == 1);
+    REQUIRE(pvalues.pendingWaits == 1);
+    REQUIRE(pvalues.pagesFetched == 1);
+    REQUIRE(pvalues.memoryWaitTime == 3000);
+}
+
+/*****************************************************/
+TEST_CASE("Evictions", "[CacheStats]")
+{
+    CacheStats parent;
+    CacheStats stats(&parent);
+
+    stats.AddEviction(EvictReason::MEMORY, false);
+    stats.AddEviction(EvictReason::MEMORY, true);
+    stats.AddEviction(EvictReason::TRUNCATE, true);
+    stats.AddEviction(EvictReason::CHANGED, false);
+    stats.AddReadAheadUsed();
+
+    for (const CacheStats::Values& values : { stats.GetValues(), parent.GetValues() })
+    {
+        REQUIRE(values.evictions[static_cast<size_t>(EvictReason::MEMORY)] == 2);
+        REQUIRE(values.evictions[static_cast<size_t>(EvictReason::CHANGED)] == 1);
+        REQUIRE(values.evictions[static_cast<size_t>(EvictReason::TRUNCATE)] == 1);
+        REQUIRE(values.readAheadUnused == 2);
+        REQUIRE(values.readAheadUsed == 1);
+    }
+}
+
+/*****************************************************/
+TEST_CASE("FlushLatency", "[CacheStats]")
+{
+    CacheStats stats;
+
+    stats.AddFlush(100, milliseconds(0)); // bucket 0 (<1ms)
+    stats.AddFlush(200, milliseconds(1)); // bucket 1 (<2ms)
+    stats.AddFlush(300, milliseconds(3)); // bucket 2 (<4ms)
+    stats.AddFlush(400, milliseconds(4)); // bucket 3 (<8ms)
+    stats.AddFlush(500, std::chrono::hours(1)); // last bucket
+
+    const CacheStats::Values values { stats.GetValues() };
+    REQUIRE(values.flushCount == 5);
+    REQUIRE(values.flushBytes == 1500);
+    REQUIRE(values.flushLatency[0] == 1);
+    REQUIRE(values.flushLatency[1] == 1);
+    REQUIRE(values.flushLatency[2] == 1);
+    REQUIRE(values.flushLatency[3] == 1);
+    REQUIRE(values.flushLatency[CacheStats::LATENCY_BUCKETS-1] == 1);
+}
+
+/*****************************************************/
+TEST_CASE("Print", "[CacheStats]")
+{
+    CacheStats stats;
+    stats.AddHit(); stats.AddHit(); stats.AddHit(); stats.AddMiss();
+    stats.AddFlush(4096, milliseconds(5));
+
+    std::ostringstream out;
+    CacheStats::Print(out, stats.GetValues());
+    const std::string str { out.str() };
+
+    REQUIRE(str.find("reads: 4") != std::string::npos);
+    REQUIRE(str.find("hitRate:75%") != std::string::npos);
+    REQUIRE(str.find("flushes: 1 (4096 bytes)") != std::string::npos);
+    REQUIRE(str.find("<8ms:1") != std::string::npos);
+}
+
+} // namespace
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
@@ -0,0 +1,137 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "catch2/catch_test_macros.hpp"
+#include "catch2/benchmark/catch_benchmark.hpp"
+
+#include "andromeda/filesystem/filedata/CachingAllocator.hpp"
+#include "andromeda/filesystem/filedata/MemoryAllocator.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+
+namespace { // anonymous
+
+constexpr size_t NUM_THREADS { 4 };
+constexpr size_t NUM_LIVE { 64 }; // per thread
+constexpr size_t NUM_OPS { 5000 }; // per thread
+constexpr size_t FULL_PAGES { 32 }; // a 128K file page with 4K OS pages
+
+/** Returns the resident set size of this process in bytes, or 0 if unknown */
+size_t GetRSS()
+{
+    std::ifstream statm("/proc/self/statm");
+    size_t total { 0 }, resident { 0 };
+    if (!(statm >> total >> resident)) return 0;
+    return resident*MemoryAllocator().getPageSize();
+}
+
+/** 
+ * N threads each keeping NUM_LIVE allocations and replacing a random one each op, like readers/writers
+ * of N files - mostly full pages, some tail pages of random size, and some pages being resized
+ */
+size_t MixedWorkload(MemoryAllocator& alloc)
+{
+    std::vector<std::thread> threads;
+    for (size_t thread { 0 }; thread < NUM_THREADS; ++thread)
+        threads.emplace_back([&, thread]()
+        {
+            std::mt19937 rng(static_cast<std::mt19937::result_type>(thread));
+            std::uniform_int_distribution<size_t> sizeDist(1, FULL_PAGES);
+            std::uniform_int_distribution<size_t> liveDist(0, NUM_LIVE-1);
+            std::uniform_int_distribution<size_t> typeDist(0, 9);
+
+            std::vector<std::pair<void*, size_t>> live(NUM_LIVE, {nullptr, 0});
+            for (size_t i { 0 }; i < NUM_OPS; ++i)
+            {
+                std::pair<void*, size_t>& entry { live[liveDist(rng)] };
+                const size_t type { typeDist(rng) };
+
+                size_t pages { FULL_PAGES }; // read a full page
+                if (type >= 9 && entry.second) // resize (write extending a page)
+                    pages = std::min(entry.second + sizeDist(rng)/4 + 1, FULL_PAGES*2);
+                else if (type >= 7) pages = sizeDist(rng); // tail page
+
+                void* const ptr { alloc.alloc(pages) };
+                static_cast<char*>(ptr)[0] = 1; // touch
+                if (entry.first != nullptr) alloc.free(entry.first, entry.second);
+                entry = { ptr, pages };
+            }
+
+            for (const std::pair<void*, size_t>& entry : live)
+                if (entry.first != nullptr) alloc.free(entry.first, entry.second);
+        });
+
+    for (std::thread& thread : threads) thread.join();
+    return NUM_THREADS*NUM_OPS;
+}
+
+/** Copies 4K chunks from random offsets across many allocated pages, like reads from a large cache */
+size_t RandomCopies(MemoryAllocator& alloc)
+{
+    constexpr size_t numPages { 512 }; // 64MB of 128K pages
+    constexpr size_t chunkSize { 4096 };
+    const size_t pageBytes { FULL_PAGES*alloc.getPageSize() };
+
+    std::vector<char*> pages;
+    for (size_t i { 0 }; i < numPages; ++i)
+    {
+        pages.push_back(static_cast<char*>(alloc.alloc(FULL_PAGES)));
+        std::memset(pages.back(), static_cast<int>(i), pageBytes);
+    }
+
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<size_t> pageDist(0, numPages-1);
+    std::uniform_int_distribution<size_t> offsetDist(0, pageBytes/chunkSize-1);
+
+    std::vector<char> buf(chunkSize);
+    size_t sum { 0 };
+    for (size_t i { 0 }; i < 100000; ++i)
+    {
+        std::memcpy(buf.data(), pages[pageDist(rng)] + offsetDist(rng)*chunkSize, chunkSize);
+        sum += static_cast<size_t>(buf[0]);
+    }
+
+    for (char* page : pages) alloc.free(page, FULL_PAGES);
+    return sum;
+}
+
+} // namespace
+
+/*****************************************************/
+TEST_CASE("Benchmark", "[CachingAllocator][!benchmark]")
+{
+    MemoryAllocator memAlloc;
+    CachingAllocator cacheAlloc(0);
+    CachingAllocator hugeAlloc(0, true);
+
+    BENCHMARK("same size alloc/free (MemoryAllocator)") {
+        void* const ptr { memAlloc.alloc(FULL_PAGES) }; memAlloc.free(ptr, FULL_PAGES); return ptr; };
+    BENCHMARK("same size alloc/free (CachingAllocator)") {
+        void* const ptr { cacheAlloc.alloc(FULL_PAGES) }; cacheAlloc.free(ptr, FULL_PAGES); return ptr; };
+
+    BENCHMARK("mixed workload (MemoryAllocator)") { return MixedWorkload(memAlloc); };
+    BENCHMARK("mixed workload (CachingAllocator)") { return MixedWorkload(cacheAlloc); };
+    BENCHMARK("mixed workload (CachingAllocator, huge pages)") { return MixedWorkload(hugeAlloc); };
+
+    BENCHMARK("random copies (CachingAllocator)") { return RandomCopies(cacheAlloc); };
+    BENCHMARK("random copies (CachingAllocator, huge pages)") { return RandomCopies(hugeAlloc); };
+
+    const CachingAllocator::Stats stats { cacheAlloc.GetStats() };
+    std::cout << "CachingAllocator: maxAlloc:" << stats.maxAlloc << " curFree:" << stats.curFree 
+        << " allocs:" << stats.allocs << " recycles:" << stats.recycles 
+        << " magazineHits:" << stats.magazineHits << " RSS:" << GetRSS() << std::endl;
+
+    cacheAlloc.Trim(0);
+    std::cout << "after Trim(0): RSS:" << GetRSS() << std::endl;
+}
+
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
@@ -0,0 +1,147 @@
+
+#include <thread>
+#include <vector>
+
+#include "catch2/catch_test_macros.hpp"
+
+#include "andromeda/filesystem/filedata/CachingAllocator.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+namespace { // anonymous
+
+/*****************************************************/
+TEST_CASE("ClassPages", "[CachingAllocator]")
+{
+    for (size_t pages { 0 }; pages <= CachingAllocator::EXACT_CLASS_PAGES; ++pages)
+        REQUIRE(CachingAllocator::GetClassPages(pages) == pages);
+
+    REQUIRE(CachingAllocator::GetClassPages(9) == 10);
+    REQUIRE(CachingAllocator::GetClassPages(10) == 10);
+    REQUIRE(CachingAllocator::GetClassPages(15) == 16);
+    REQUIRE(CachingAllocator::GetClassPages(16) == 16);
+    REQUIRE(CachingAllocator::GetClassPages(17) == 20);
+    REQUIRE(CachingAllocator::GetClassPages(32) == 32);
+    REQUIRE(CachingAllocator::GetClassPages(33) == 40);
+    REQUIRE(CachingAllocator::GetClassPages(1000) == 1024);
+
+    for (size_t pages { 1 }; pages < 5000; ++pages)
+    {
+        const size_t classPages { CachingAllocator::GetClassPages(pages) };
+        REQUIRE(classPages >= pages);
+        REQUIRE(classPages*4 <= pages*5); // at most 25% waste
+        REQUIRE(CachingAllocator::GetClassPages(classPages) == classPages);
+    }
+}
+
+/*****************************************************/
+TEST_CASE("Recycle", "[CachingAllocator]")
+{
+    CachingAllocator alloc(0);
+    const size_t pageSize { alloc.getPageSize() };
+
+    void* const ptr1 { alloc.alloc(17) }; // class of 20
+    REQUIRE(alloc.GetStats().curAlloc == 20*pageSize);
+    alloc.free(ptr1, 17);
+    REQUIRE(alloc.GetStats().curAlloc == 0);
+    REQUIRE(alloc.GetStats().curFree == 20*pageSize);
+
+    // a different size in the same class re-uses it from the magazine
+    void* const ptr2 { alloc.alloc(19) };
+    REQUIRE(ptr2 == ptr1);
+    REQUIRE(alloc.GetStats().recycles == 1);
+    REQUIRE(alloc.GetStats().magazineHits == 1);
+    REQUIRE(alloc.GetStats().curFree == 0);
+    alloc.free(ptr2, 19);
+
+    REQUIRE(alloc.Trim(0) == 20*pageSize);
+    REQUIRE(alloc.GetStats().curFree == 0);
+}
+
+/*****************************************************/
+TEST_CASE("Depot", "[CachingAllocator]")
+{
+    CachingAllocator alloc(0);
+    const size_t pageSize { alloc.getPageSize() };
+    constexpr size_t count { CachingAllocator::MAGAZINE_SIZE*2 };
+
+    std::vector<void*> ptrs;
+    for (size_t i { 0 }; i < count; ++i)
+        ptrs.push_back(alloc.alloc(4));
+    for (void* ptr : ptrs)
+        alloc.free(ptr, 4); // overflows go to the depot
+
+    REQUIRE(alloc.GetStats().curFree == count*4*pageSize);
+    REQUIRE(alloc.GetStats().allocs == count);
+
+    // everything is recycled, from the magazine or the depot
+    for (size_t i { 0 }; i < count; ++i)
+        ptrs[i] = alloc.alloc(4);
+    REQUIRE(alloc.GetStats().recycles == count);
+    REQUIRE(alloc.GetStats().magazineHits < count);
+    REQUIRE(alloc.GetStats().curFree == 0);
+
+    for (void* ptr : ptrs)
+        alloc.free(ptr, 4);
+    REQUIRE(alloc.Trim(4*pageSize) == (count-1)*4*pageSize);
+}
+
+/*****************************************************/
+TEST_CASE("Split", "[CachingAllocator]")
+{
+    CachingAllocator alloc(0);
+    const size_t pageSize { alloc.getPageSize() };
+
+    void* const big { alloc.alloc(32) };
+    alloc.free(big, 32);
+    REQUIRE(alloc.Trim(32*pageSize) == 0); // moves it to the depot
+
+    // a smaller class is carved out of the larger free allocation
+    void* const small { alloc.alloc(8) };
+    REQUIRE(small == big);
+    REQUIRE(alloc.GetStats().curFree == 24*pageSize);
+
+    alloc.free(small, 8);
+    REQUIRE(alloc.Trim(0) == 32*pageSize);
+}
+
+/*****************************************************/
+TEST_CASE("Threads", "[CachingAllocator]")
+{
+    CachingAllocator alloc(0);
+    constexpr size_t numThreads { 4 };
+    constexpr size_t numAllocs { 1000 };
+
+    std::vector<std::thread> threads;
+    for (size_t thread { 0 }; thread < numThreads; ++thread)
+        threads.emplace_back([&, thread]()
+        {
+            std::vector<void*> ptrs;
+            for (size_t i { 0 }; i < numAllocs; ++i)
+            {
+                const size_t pages { 1 + (i+thread) % 40 };
+                void* const ptr { alloc.alloc(pages) };
+                static_cast<char*>(ptr)[0] = 1;
+                ptrs.push_back(ptr);
+                if (ptrs.size() > 10)
+                {
+                    alloc.free(ptrs.front(), 1 + (i-10+thread) % 40);
+                    ptrs.erase(ptrs.begin());
+                }
+            }
+            for (size_t i { 0 }; i < ptrs.size(); ++i)
+                alloc.free(ptrs[i], 1 + (numAllocs-ptrs.size()+i+thread) % 40);
+        });
+    for (std::thread& thread : threads) thread.join();
+
+    const CachingAllocator::Stats stats { alloc.GetStats() };
+    REQUIRE(stats.curAlloc == 0);
+    REQUIRE(stats.allocs == numThreads*numAllocs);
+    REQUIRE(stats.recycles > 0);
+}
+
+} // namespace
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
@@ -0,0 +1,136 @@
+#include <cstring>
+#include <random>
+#include <string>
+
+#include "catch2/catch_test_macros.hpp"
+
+#include "andromeda/filesystem/filedata/CachingAllocator.hpp"
+#include "andromeda/filesystem/filedata/CompressedCache.hpp"
+#include "andromeda/filesystem/filedata/Page.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+namespace { // anonymous
+
+/** Returns a page filled with the given string */
+Page MakePage(const std::string& data, CachingAllocator& alloc)
+{
+    Page page(data.size(), alloc);
+    std::memcpy(page.data(), data.data(), data.size());
+    return page;
+}
+
+/** Returns the data in the given page */
+std::string PageData(const Page& page)
+{
+    return std::string(page.data(), page.size());
+}
+
+/** Returns a compressible string of the given size, like a log file */
+std::string MakeText(const size_t size, const size_t seed)
+{
+    std::string text;
+    for (size_t line { seed }; text.size() < size; ++line)
+        text += "2024-01-01 12:00:00 INFO request " + std::to_string(line) + " completed OK\n";
+    text.resize(size); return text;
+}
+
+/*****************************************************/
+TEST_CASE("StoreLoad", "[CompressedCache]")
+{
+    if (!CompressedCache::isSupported()) return;
+
+    CachingAllocator alloc(0);
+    const std::string fileID { "file1" };
+    const CompressedCache::Version version { fileID, 100000, 12345.5, 4096 };
+
+    CompressedCache cache(1024*1024);
+    REQUIRE(!cache.Contains(fileID, 3));
+
+    Page page(0, alloc);
+    REQUIRE(!cache.Load(version, 3, page));
+
+    const std::string text { MakeText(4096, 0) };
+    REQUIRE(cache.Store(version, 3, MakePage(text, alloc)));
+    REQUIRE(cache.Contains(fileID, 3));
+    REQUIRE(!cache.Contains(fileID, 4));
+
+    CompressedCache::Stats stats { cache.GetStats() };
+    REQUIRE(stats.entries == 1);
+    REQUIRE(stats.currentRaw == 4096);
+    REQUIRE(stats.currentTotal < 4096/2);
+
+    REQUIRE(cache.Load(version, 3, page));
+    REQUIRE(PageData(page) == text);
+    REQUIRE(!cache.Contains(fileID, 3)); // moved back to memory
+
+    stats = cache.GetStats();
+    REQUIRE(stats.entries == 0);
+    REQUIRE(stats.currentTotal == 0);
+    REQUIRE(stats.hits == 1);
+    REQUIRE(stats.misses == 1);
+}
+
+/*****************************************************/
+TEST_CASE("Stale", "[CompressedCache]")
+{
+    if (!CompressedCache::isSupported()) return;
+
+    CachingAllocator alloc(0);
+    const std::string fileID { "file1" };
+    const CompressedCache::Version version { fileID, 100000, 12345.5, 4096 };
+    const CompressedCache::Version version2 { fileID, 100000, 99999.0, 4096 };
+
+    CompressedCache cache(1024*1024);
+    REQUIRE(cache.Store(version, 0, MakePage(MakeText(4096, 0), alloc)));
+
+    Page page(0, alloc);
+    REQUIRE(!cache.Load(version2, 0, page)); // modified changed
+    REQUIRE(!cache.Contains(fileID, 0)); // removed
+}
+
+/*****************************************************/
+TEST_CASE("Incompressible", "[CompressedCache]")
+{
+    if (!CompressedCache::isSupported()) return;
+
+    CachingAllocator alloc(0);
+    const std::string fileID { "file1" };
+    const CompressedCache::Version version { fileID, 100000, 12345.5, 4096 };
+
+    std::string random(4096, '\0');
+    std::mt19937 rng(0);
+    for (char& chr : random) chr = static_cast<char>(rng());
+
+    CompressedCache cache(1024*1024);
+    REQUIRE(!cache.Store(version, 0, MakePage(random, alloc)));
+    REQUIRE(!cache.Contains(fileID, 0));
+    REQUIRE(cache.GetStats().rejected == 1);
+}
+
+/*****************************************************/
+TEST_CASE("Limit", "[CompressedCache]")
+{
+    if (!CompressedCache::isSupported()) return;
+
+    CachingAllocator alloc(0);
+    const std::string fileID { "file1" };
+    const CompressedCache::Version version { fileID, 1000000, 12345.5, 65536 };
+
+    CompressedCache cache(8192);
+    for (uint64_t index { 0 }; index < 16; ++index)
+        REQUIRE(cache.Store(version, index, MakePage(MakeText(65536, index*1000), alloc)));
+
+    // the oldest entries were dropped to stay under the limit
+    const CompressedCache::Stats stats { cache.GetStats() };
+    REQUIRE(stats.currentTotal <= 8192);
+    REQUIRE(stats.entries < 16);
+    REQUIRE(cache.Contains(fileID, 15));
+    REQUIRE(!cache.Contains(fileID, 0));
+}
+
+} // namespace
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
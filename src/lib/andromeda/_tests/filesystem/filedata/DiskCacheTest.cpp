@@ -0,0 +1,143 @@
+
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+#include "catch2/catch_test_macros.hpp"
+
+#include "andromeda/TempPath.hpp"
+#include "andromeda/filesystem/filedata/CachingAllocator.hpp"
+#include "andromeda/filesystem/filedata/DiskCache.hpp"
+#include "andromeda/filesystem/filedata/Page.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+namespace { // anonymous
+
+/** Removes the cache directory when done */
+struct TempDir : public TempPath
+{
+    TempDir() : TempPath("diskcache") { }
+    ~TempDir() override { std::filesystem::remove_all(Get()); }
+    DELETE_COPY(TempDir)
+    DELETE_MOVE(TempDir)
+};
+
+/** Returns a page filled with the given string */
+Page MakePage(const std::string& data, CachingAllocator& alloc)
+{
+    Page page(data.size(), alloc);
+    std::memcpy(page.data(), data.data(), data.size());
+    return page;
+}
+
+/** Returns the data in the given page */
+std::string PageData(const Page& page)
+{
+    return std::string(page.data(), page.size());
+}
+
+/*****************************************************/
+TEST_CASE("StoreLoad", "[DiskCache]")
+{
+    const TempDir tmpdir; CachingAllocator alloc(0);
+    const std::string fileID { "file/1" }; // not a safe path
+    const DiskCache::Version version { fileID, 1000, 12345.5, 100 };
+
+    DiskCache cache(tmpdir.Get(), 1024*1024);
+    REQUIRE(!cache.Contains(fileID, 3));
+
+    Page page(0, alloc);
+    REQUIRE(!cache.Load(version, 3, page));
+
+    cache.Store(version, 3, MakePage("page three", alloc));
+    REQUIRE(cache.Contains(fileID, 3));
+    REQUIRE(!cache.Contains(fileID, 4));
+
+    REQUIRE(cache.Load(version, 3, page));
+    REQUIRE(PageData(page) == "page three");
+
+    const DiskCache::Stats stats { cache.GetStats() };
+    REQUIRE(stats.entries == 1);
+    REQUIRE(stats.hits == 1);
+    REQUIRE(stats.misses == 1);
+}
+
+/*****************************************************/
+TEST_CASE("Stale", "[DiskCache]")
+{
+    const TempDir tmpdir; CachingAllocator alloc(0);
+    const std::string fileID { "file1" };
+
+    DiskCache cache(tmpdir.Get(), 1024*1024);
+    cache.Store({ fileID, 1000, 5.0, 100 }, 0, MakePage("old data", alloc));
+
+    Page page(0, alloc); // different modified, different size
+    REQUIRE(!cache.Load({ fileID, 1000, 6.0, 100 }, 0, page));
+    REQUIRE(!cache.Contains(fileID, 0)); // removed
+
+    cache.Store({ fileID, 1000, 5.0, 100 }, 0, MakePage("old data", alloc));
+    REQUIRE(!cache.Load({ fileID, 2000, 5.0, 100 }, 0, page));
+    REQUIRE(cache.GetStats().entries == 0);
+}
+
+/*****************************************************/
+TEST_CASE("Limit", "[DiskCache]")
+{
+    const TempDir tmpdir; CachingAllocator alloc(0);
+    const std::string fileID { "file1" };
+    const DiskCache::Version version { fileID, 10000, 1.0, 1000 };
+    const std::string data(1000, 'a');
+
+    { DiskCache cache(tmpdir.Get(), 3500); // room for 3 entries
+        for (uint64_t i { 0 }; i < 3; ++i)
+            cache.Store(version, i, MakePage(data, alloc));
+
+        Page page(0, alloc); // use 0 so 1 is the oldest
+        REQUIRE(cache.Load(version, 0, page));
+
+        cache.Store(version, 3, MakePage(data, alloc));
+        REQUIRE(cache.GetStats().entries == 3);
+        REQUIRE(cache.Contains(fileID, 0));
+        REQUIRE(!cache.Contains(fileID, 1));
+        REQUIRE(cache.Contains(fileID, 3));
+    }
+
+    // entries persist to a new instance
+    DiskCache cache(tmpdir.Get(), 3500);
+    REQUIRE(cache.GetStats().entries == 3);
+
+    Page page(0, alloc);
+    REQUIRE(cache.Load(version, 3, page));
+    REQUIRE(PageData(page) == data);
+}
+
+#if !WIN32
+/*****************************************************/
+TEST_CASE("Permissions", "[DiskCache]")
+{
+    using std::filesystem::perms;
+    const TempDir tmpdir; CachingAllocator alloc(0);
+
+    DiskCache cache(tmpdir.Get(), 1024*1024);
+    cache.Store({ "file1", 1000, 1.0, 100 }, 0, MakePage("secret", alloc));
+
+    REQUIRE(std::filesystem::status(tmpdir.Get()).permissions() == perms::owner_all);
+
+    size_t files { 0 };
+    for (const std::filesystem::directory_entry& entry :
+        std::filesystem::recursive_directory_iterator(tmpdir.Get()))
+    {
+        if (!entry.is_regular_file()) continue;
+        REQUIRE(entry.status().permissions() == (perms::owner_read | perms::owner_write));
+        ++files;
+    }
+    REQUIRE(files == 1);
+}
+#endif // !WIN32
+
+} // namespace
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
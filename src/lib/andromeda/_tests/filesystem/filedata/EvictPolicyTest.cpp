@@ -0,0 +1,236 @@
+
+#include <deque>
+#include <vector>
+
+#include "catch2/catch_test_macros.hpp"
+
+#include "andromeda/filesystem/filedata/ARCPolicy.hpp"
+#include "andromeda/filesystem/filedata/CachingAllocator.hpp"
+#include "andromeda/filesystem/filedata/LRUPolicy.hpp"
+#include "andromeda/filesystem/filedata/Page.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+namespace { // anonymous
+
+using PageList = std::vector<const Page*>;
+
+/** Returns a list of the given number of (empty) pages, with stable addresses */
+std::deque<Page> MakePages(const size_t count, CachingAllocator& alloc)
+{
+    std::deque<Page> pages;
+    for (size_t i { 0 }; i < count; ++i)
+        pages.emplace_back(0, alloc);
+    return pages;
+}
+
+/** Returns the first count pages in eviction order */
+PageList GetVictims(const EvictPolicy& policy, const size_t count = 100)
+{
+    PageList victims;
+    policy.ForEachVictim([&](const Page* page){
+        victims.push_back(page); return victims.size() < count; });
+    return victims;
+}
+
+/*****************************************************/
+TEST_CASE("LRU", "[EvictPolicy]")
+{
+    CachingAllocator alloc(0);
+    const std::deque<Page> pages { MakePages(3, alloc) };
+    const Page* const p0 { &pages[0] };
+    const Page* const p1 { &pages[1] };
+    const Page* const p2 { &pages[2] };
+
+    LRUPolicy policy;
+    policy.Insert(p0, {nullptr,0}, 100, false);
+    policy.Insert(p1, {nullptr,1}, 100, false);
+    policy.Insert(p2, {nullptr,2}, 100, false);
+    REQUIRE(GetVictims(policy) == PageList{p0, p1, p2});
+    REQUIRE(GetVictims(policy, 1) == PageList{p0});
+
+    policy.Access(p0);
+    REQUIRE(GetVictims(policy) == PageList{p1, p2, p0});
+
+    policy.Erase(p2, true);
+    policy.Access(p2); // ignored
+    REQUIRE(GetVictims(policy) == PageList{p1, p0});
+}
+
+/*****************************************************/
+TEST_CASE("ARCScan", "[EvictPolicy]")
+{
+    CachingAllocator alloc(0);
+    const std::deque<Page> pages { MakePages(8, alloc) };
+
+    ARCPolicy policy(400);
+    for (size_t i { 0 }; i < 3; ++i)
+        policy.Insert(&pages[i], {nullptr,i}, 100, false);
+
+    policy.Access(&pages[0]);
+    policy.Access(&pages[1]);
+    REQUIRE(policy.isFrequent(&pages[0]));
+    REQUIRE(policy.isFrequent(&pages[1]));
+    REQUIRE(!policy.isFrequent(&pages[2]));
+
+    // a scan through pages read once only replaces other recent pages
+    for (size_t i { 3 }; i < 8; ++i)
+        policy.Insert(&pages[i], {nullptr,i}, 100, false);
+    REQUIRE(GetVictims(policy) == PageList{&pages[2], &pages[3], &pages[4],
+        &pages[5], &pages[6], &pages[7], &pages[0], &pages[1]});
+}
+
+/*****************************************************/
+TEST_CASE("ARCRepeatAccess", "[EvictPolicy]")
+{
+    CachingAllocator alloc(0);
+    const std::deque<Page> pages { MakePages(2, alloc) };
+
+    ARCPolicy policy(400);
+    policy.Insert(&pages[0], {nullptr,0}, 100, false);
+
+    // continuing accesses to the most recent page are one reference
+    policy.Access(&pages[0]);
+    policy.Access(&pages[0]);
+    REQUIRE(!policy.isFrequent(&pages[0]));
+
+    policy.Insert(&pages[1], {nullptr,1}, 100, false);
+    policy.Access(&pages[0]);
+    REQUIRE(policy.isFrequent(&pages[0]));
+}
+
+/*****************************************************/
+TEST_CASE("ARCGhosts", "[EvictPolicy]")
+{
+    CachingAllocator alloc(0);
+    const std::deque<Page> pages { MakePages(4, alloc) };
+    int owner { 0 }; // any address
+
+    ARCPolicy policy(400);
+    policy.Insert(&pages[0], {&owner,0}, 100, false);
+    policy.Insert(&pages[1], {&owner,1}, 100, false);
+    REQUIRE(policy.GetTarget() == 0);
+
+    // evicted from recent and read again - goes to frequent and grows the recent target
+    policy.Erase(&pages[0], true);
+    policy.Insert(&pages[2], {&owner,0}, 100, false);
+    REQUIRE(policy.isFrequent(&pages[2]));
+    REQUIRE(policy.GetTarget() == 100);
+
+    // evicted from frequent and read again - shrinks the recent target
+    policy.Erase(&pages[2], true);
+    policy.Insert(&pages[3], {&owner,0}, 100, false);
+    REQUIRE(policy.isFrequent(&pages[3]));
+    REQUIRE(policy.GetTarget() == 0);
+
+    // a different owner is a different page
+    policy.Erase(&pages[1], true);
+    policy.Insert(&pages[1], {nullptr,1}, 100, false);
+    REQUIRE(!policy.isFrequent(&pages[1]));
+}
+
+/*****************************************************/
+TEST_CASE("ARCNoGhosts", "[EvictPolicy]")
+{
+    CachingAllocator alloc(0);
+    const std::deque<Page> pages { MakePages(4, alloc) };
+    int owner { 0 }; // any address
+
+    ARCPolicy policy(400);
+    policy.Insert(&pages[0], {&owner,0}, 100, false);
+    policy.Insert(&pages[1], {&owner,1}, 100, false);
+    policy.Insert(&pages[2], {&owner,2}, 100, false);
+
+    // a deleted page is not remembered
+    policy.Erase(&pages[0], false);
+    policy.Insert(&pages[3], {&owner,0}, 100, false);
+    REQUIRE(!policy.isFrequent(&pages[3]));
+
+    // a page that failed to evict is requeued, not remembered or promoted
+    policy.Requeue(&pages[1]);
+    REQUIRE(!policy.isFrequent(&pages[1]));
+    REQUIRE(GetVictims(policy) == PageList{&pages[2], &pages[3], &pages[1]});
+    REQUIRE(policy.GetTarget() == 0);
+
+    // the ghosts of a deleted owner are forgotten
+    policy.Erase(&pages[2], true);
+    policy.EraseOwner(&owner);
+    policy.Insert(&pages[2], {&owner,2}, 100, false);
+    REQUIRE(!policy.isFrequent(&pages[2]));
+}
+
+/*****************************************************/
+TEST_CASE("ARCTarget", "[EvictPolicy]")
+{
+    CachingAllocator alloc(0);
+    const std::deque<Page> pages { MakePages(4, alloc) };
+
+    ARCPolicy policy(400);
+    policy.Insert(&pages[0], {nullptr,0}, 100, false);
+    policy.Insert(&pages[1], {nullptr,1}, 100, false);
+    policy.Access(&pages[0]); // frequent
+
+    // grow the target to 100 via a recent ghost
+    policy.Insert(&pages[2], {nullptr,2}, 100, false);
+    policy.Erase(&pages[2], true);
+    policy.Insert(&pages[2], {nullptr,2}, 100, false);
+    REQUIRE(policy.GetTarget() == 100);
+
+    // the recent list is within its target, so frequent pages go first
+    REQUIRE(GetVictims(policy) == PageList{&pages[0], &pages[2], &pages[1]});
+
+    policy.Resize(&pages[1], 200); // now over target
+    REQUIRE(GetVictims(policy, 1) == PageList{&pages[1]});
+}
+
+/*****************************************************/
+TEST_CASE("ARCCapacity", "[EvictPolicy]")
+{
+    CachingAllocator alloc(0);
+    const std::deque<Page> pages { MakePages(3, alloc) };
+
+    ARCPolicy policy(400);
+    policy.Insert(&pages[0], {nullptr,0}, 100, false);
+    policy.Insert(&pages[1], {nullptr,1}, 100, false);
+    policy.Erase(&pages[0], true);
+    policy.Insert(&pages[0], {nullptr,0}, 100, false);
+    REQUIRE(policy.GetTarget() == 100);
+
+    // a smaller cache limits the target and forgets ghosts that no longer fit
+    policy.SetCapacity(50);
+    REQUIRE(policy.GetTarget() == 50);
+    policy.Erase(&pages[1], true);
+    policy.Insert(&pages[2], {nullptr,1}, 100, false);
+    REQUIRE(!policy.isFrequent(&pages[2]));
+}
+
+/*****************************************************/
+TEST_CASE("ARCPrefetch", "[EvictPolicy]")
+{
+    CachingAllocator alloc(0);
+    const std::deque<Page> pages { MakePages(4, alloc) };
+
+    ARCPolicy policy(400);
+    policy.Insert(&pages[0], {nullptr,0}, 100, false);
+    policy.Insert(&pages[1], {nullptr,1}, 100, true);
+    policy.Insert(&pages[2], {nullptr,2}, 100, true);
+
+    // unused read-ahead goes first, oldest first
+    REQUIRE(GetVictims(policy) == PageList{&pages[1], &pages[2], &pages[0]});
+
+    // accessing read-ahead makes it a normal recent page, not frequent
+    policy.Access(&pages[1]);
+    REQUIRE(!policy.isFrequent(&pages[1]));
+    REQUIRE(GetVictims(policy) == PageList{&pages[2], &pages[0], &pages[1]});
+
+    // unused read-ahead is not remembered after eviction
+    policy.Erase(&pages[2], true);
+    policy.Insert(&pages[3], {nullptr,2}, 100, false);
+    REQUIRE(!policy.isFrequent(&pages[3]));
+}
+
+} // namespace
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
@@ -0,0 +1,88 @@
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "catch2/catch_test_macros.hpp"
+
+#include "andromeda/filesystem/filedata/MemoryAllocator.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+namespace { // anonymous
+
+/*****************************************************/
+TEST_CASE("Basic", "[MemoryAllocator]")
+{
+    MemoryAllocator alloc;
+    REQUIRE(!alloc.isHugePages());
+    REQUIRE(alloc.alloc(0) == nullptr);
+
+    void* const ptr { alloc.alloc(3) };
+    std::memset(ptr, 1, 3*alloc.getPageSize());
+    alloc.free(ptr, 1); // partial
+    alloc.free(static_cast<char*>(ptr) + alloc.getPageSize(), 2);
+}
+
+/*****************************************************/
+TEST_CASE("HugePages", "[MemoryAllocator]")
+{
+    MemoryAllocator alloc(true);
+    if (!alloc.isHugePages()) return; // not supported
+
+    const size_t pageSize { alloc.getPageSize() };
+    const size_t arenaPages { MemoryAllocator::ARENA_SIZE/pageSize };
+
+    // the first allocation starts a new aligned arena
+    char* const ptr1 { static_cast<char*>(alloc.alloc(4)) };
+    REQUIRE(reinterpret_cast<uintptr_t>(ptr1) % MemoryAllocator::HUGE_PAGE_SIZE == 0); // NOLINT(*-reinterpret-cast)
+
+    // later allocations are carved from the same arena
+    char* const ptr2 { static_cast<char*>(alloc.alloc(8)) };
+    char* const ptr3 { static_cast<char*>(alloc.alloc(4)) };
+    REQUIRE(ptr2 == ptr1 + 4*pageSize);
+    REQUIRE(ptr3 == ptr2 + 8*pageSize);
+    std::memset(ptr1, 1, 16*pageSize);
+
+    // freed ranges are re-used (first fit) and coalesced
+    alloc.free(ptr2, 8);
+    REQUIRE(alloc.alloc(2) == ptr2);
+    alloc.free(ptr2, 2);
+    alloc.free(ptr1, 4); // coalesces with ptr2's range
+    REQUIRE(alloc.alloc(12) == ptr1);
+    alloc.free(ptr1, 12);
+
+    // large allocations get their own aligned mapping
+    char* const big { static_cast<char*>(alloc.alloc(arenaPages)) };
+    REQUIRE(reinterpret_cast<uintptr_t>(big) % MemoryAllocator::HUGE_PAGE_SIZE == 0); // NOLINT(*-reinterpret-cast)
+    big[0] = 1; big[MemoryAllocator::ARENA_SIZE-1] = 1;
+    alloc.free(big, arenaPages);
+
+    alloc.free(ptr3, 4); // arena is now unmapped
+}
+
+/*****************************************************/
+TEST_CASE("HugeArenas", "[MemoryAllocator]")
+{
+    MemoryAllocator alloc(true);
+    if (!alloc.isHugePages()) return; // not supported
+
+    const size_t allocPages { MemoryAllocator::ARENA_SIZE/alloc.getPageSize()/2 };
+
+    std::vector<void*> ptrs; // fills 2 arenas
+    for (size_t i { 0 }; i < 4; ++i)
+    {
+        ptrs.push_back(alloc.alloc(allocPages));
+        static_cast<char*>(ptrs.back())[0] = 1;
+    }
+    REQUIRE(static_cast<char*>(ptrs[1]) == static_cast<char*>(ptrs[0]) + MemoryAllocator::ARENA_SIZE/2);
+
+    for (void* ptr : ptrs) 
+        alloc.free(ptr, allocPages);
+}
+
+} // namespace
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
@@ -0,0 +1,96 @@
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "catch2/catch_test_macros.hpp"
+
+#include "andromeda/TempPath.hpp"
+#include "andromeda/filesystem/filedata/MemoryPressure.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+namespace { // anonymous
+
+/** Removes the fake root directory when done */
+struct TempDir : public TempPath
+{
+    TempDir() : TempPath("mempressure") { }
+    ~TempDir() override { std::filesystem::remove_all(Get()); }
+    DELETE_COPY(TempDir)
+    DELETE_MOVE(TempDir)
+};
+
+/** Writes the given file under root, creating directories */
+void WriteFile(const std::filesystem::path& root, const std::string& path, const std::string& data)
+{
+    const std::filesystem::path fullPath { root/path };
+    std::filesystem::create_directories(fullPath.parent_path());
+    std::ofstream file(fullPath); file << data;
+}
+
+/*****************************************************/
+TEST_CASE("ParsePSI", "[MemoryPressure]")
+{
+    std::istringstream psi("some avg10=12.50 avg60=3.00 avg300=1.00 total=12345\n"
+                           "full avg10=2.00 avg60=0.50 avg300=0.10 total=678\n");
+    REQUIRE(MemoryPressure::ParsePSI(psi) == 12.5);
+
+    std::istringstream full("full avg10=2.00 avg60=0.50 avg300=0.10 total=678\n");
+    REQUIRE(!MemoryPressure::ParsePSI(full));
+
+    std::istringstream bad("some avg10=abc\n");
+    REQUIRE(!MemoryPressure::ParsePSI(bad));
+}
+
+/*****************************************************/
+TEST_CASE("ParseCgroup", "[MemoryPressure]")
+{
+    std::istringstream value("1073741824\n");
+    REQUIRE(MemoryPressure::ParseCgroupValue(value) == 1073741824);
+
+    std::istringstream max("max\n");
+    REQUIRE(!MemoryPressure::ParseCgroupValue(max));
+
+    std::istringstream path("12:memory:/docker/abc\n0::/system.slice/test.service\n");
+    REQUIRE(MemoryPressure::ParseCgroupPath(path) == "/system.slice/test.service");
+
+    std::istringstream v1("12:memory:/docker/abc\n");
+    REQUIRE(!MemoryPressure::ParseCgroupPath(v1));
+}
+
+/*****************************************************/
+TEST_CASE("GetSample", "[MemoryPressure]")
+{
+    TempDir root;
+
+    SECTION("Missing files")
+    {
+        const MemoryPressure pressure(root.Get());
+        const MemoryPressure::Sample sample { pressure.GetSample() };
+        REQUIRE(!sample.stallPercent);
+        REQUIRE(!sample.cgroupMax);
+        REQUIRE(!sample.cgroupCurrent);
+    }
+
+    SECTION("All files")
+    {
+        WriteFile(root.Get(), "proc/pressure/memory", "some avg10=5.25 avg60=0 avg300=0 total=0\n");
+        WriteFile(root.Get(), "proc/self/cgroup", "0::/test.slice\n");
+        WriteFile(root.Get(), "sys/fs/cgroup/test.slice/memory.max", "4096\n");
+        WriteFile(root.Get(), "sys/fs/cgroup/test.slice/memory.current", "1024\n");
+
+        const MemoryPressure pressure(root.Get());
+        const MemoryPressure::Sample sample { pressure.GetSample() };
+        REQUIRE(sample.stallPercent == 5.25);
+        REQUIRE(sample.cgroupMax == 4096);
+        REQUIRE(sample.cgroupCurrent == 1024);
+    }
+}
+
+} // namespace
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
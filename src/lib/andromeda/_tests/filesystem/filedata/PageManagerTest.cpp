@@ -0,0 +1,119 @@
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "catch2/catch_test_macros.hpp"
+#include "nlohmann/json.hpp"
+
+#include "andromeda/ConfigOptions.hpp"
+#include "andromeda/backend/BackendImpl.hpp"
+#include "andromeda/backend/BaseRunner.hpp"
+#include "andromeda/backend/RunnerInput.hpp"
+#include "andromeda/backend/RunnerPool.hpp"
+#include "andromeda/filesystem/File.hpp"
+#include "andromeda/filesystem/folders/SuperRoot.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+namespace { // anonymous
+
+using Backend::BackendImpl;
+using Backend::BaseRunner;
+using Backend::RunnerInput;
+using Backend::RunnerInput_FilesIn;
+using Backend::RunnerInput_StreamIn;
+using Backend::RunnerInput_StreamOut;
+using Backend::RunnerPool;
+
+/** The downloads requested from a FakeRunner (by start offset) */
+struct Downloads
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::set<uint64_t> starts;
+
+    /** Returns true if a download from the given offset is requested within a timeout */
+    bool WaitFor(const uint64_t start)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        return cv.wait_for(lock, std::chrono::seconds(5), [&]{ return starts.count(start) != 0; });
+    }
+};
+
+/** A runner that returns a minimal server config and zero-filled file data */
+class FakeRunner : public BaseRunner
+{
+public:
+    explicit FakeRunner(std::shared_ptr<Downloads> downloads) : mDownloads(std::move(downloads)) { }
+    ~FakeRunner() override = default;
+    DELETE_COPY(FakeRunner)
+    DELETE_MOVE(FakeRunner)
+
+    [[nodiscard]] std::unique_ptr<BaseRunner> Clone() const override { return std::make_unique<FakeRunner>(mDownloads); }
+    [[nodiscard]] std::string GetHostname() const override { return "fake"; }
+
+    std::string RunAction_Read(const RunnerInput& input) override
+    {
+        if (input.app == "core" && input.action == "getconfig") return R"({"ok":true,"appdata":
+            {"api":2,"apps":{"core":1,"accounts":1,"files":1},"features":{"read_only":false}}})";
+        if (input.app == "files" && input.action == "getconfig") return R"({"ok":true,"appdata":
+            {"upload_maxbytes":null}})";
+        return R"({"ok":true,"appdata":null})";
+    }
+
+    std::string RunAction_Write(const RunnerInput& input) override { return R"({"ok":true,"appdata":null})"; }
+    std::string RunAction_FilesIn(const RunnerInput_FilesIn& input) override { return R"({"ok":true,"appdata":null})"; }
+    std::string RunAction_StreamIn(const RunnerInput_StreamIn& input) override { return R"({"ok":true,"appdata":null})"; }
+
+    void RunAction_StreamOut(const RunnerInput_StreamOut& input) override
+    {
+        const uint64_t start { std::stoull(input.dataParams.at("fstart")) };
+        const uint64_t last { std::stoull(input.dataParams.at("flast")) };
+
+        const std::vector<char> data(static_cast<size_t>(last-start+1), '\0');
+        input.streamer(0, data.data(), data.size());
+
+        { const std::lock_guard<std::mutex> lock(mDownloads->mutex);
+            mDownloads->starts.insert(start); }
+        mDownloads->cv.notify_all();
+    }
+
+    [[nodiscard]] bool RequiresSession() const override { return false; }
+
+private:
+    const std::shared_ptr<Downloads> mDownloads;
+};
+
+/*****************************************************/
+TEST_CASE("ReadAheadNoBuffer", "[PageManager]")
+{
+    const std::shared_ptr<Downloads> downloads { std::make_shared<Downloads>() };
+    FakeRunner runner(downloads); ConfigOptions options;
+    options.pageSize = 4096;
+    options.readAheadBuffer = 0;
+    RunnerPool pool(runner, options);
+    BackendImpl backend(options, pool);
+
+    Folders::SuperRoot parent(backend);
+    const nlohmann::json data {{"id","file1"}, {"name","file1"}, {"size",options.pageSize*8}, {"filesystem","fs1"}};
+    File file(backend, data, parent);
+
+    // a sequential miss still starts the read-ahead window after the missed page
+    std::vector<char> buf(options.pageSize);
+    { const SharedLockR lock { file.GetReadLock() };
+        file.ReadBytes(buf.data(), options.pageSize, buf.size(), lock); }
+    REQUIRE(downloads->WaitFor(options.pageSize));
+    REQUIRE(downloads->WaitFor(options.pageSize*2));
+}
+
+} // namespace
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
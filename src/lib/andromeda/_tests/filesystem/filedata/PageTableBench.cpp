@@ -0,0 +1,72 @@
+
+#include <cstdint>
+#include <map>
+
+#include "catch2/catch_test_macros.hpp"
+#include "catch2/benchmark/catch_benchmark.hpp"
+
+#include "andromeda/filesystem/filedata/PageTable.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+namespace { // anonymous
+
+/** A value about the size of a Page */
+struct BenchValue
+{
+    explicit BenchValue(uint64_t val) : mVal(val) { }
+    uint64_t mVal; char mPad[72] {};
+};
+
+constexpr uint64_t NUM_PAGES { 1 << 18 }; // 32G of 128K pages
+constexpr uint64_t STEP { 7919 }; // prime, scatters lookups
+
+/** Fills the given map type with NUM_PAGES entries */
+template<typename MapT>
+void FillMap(MapT& map)
+{
+    for (uint64_t i { 0 }; i < NUM_PAGES; ++i)
+        map.try_emplace(i, i);
+}
+
+/** Looks up all entries in a scattered order */
+template<typename MapT>
+uint64_t FindAll(const MapT& map)
+{
+    uint64_t sum { 0 };
+    for (uint64_t i { 0 }, idx { 0 }; i < NUM_PAGES; ++i, idx = (idx+STEP) % NUM_PAGES)
+        sum += map.find(idx)->second.mVal;
+    return sum;
+}
+
+/** Iterates all entries in order */
+template<typename MapT>
+uint64_t IterateAll(const MapT& map)
+{
+    uint64_t sum { 0 };
+    for (const typename MapT::value_type& pair : map)
+        sum += pair.second.mVal;
+    return sum;
+}
+
+/*****************************************************/
+TEST_CASE("Benchmark", "[PageTable][!benchmark]")
+{
+    std::map<uint64_t, BenchValue> map; FillMap(map);
+    PageTable<BenchValue> table; FillMap(table);
+
+    BENCHMARK("map insert") { std::map<uint64_t, BenchValue> m; FillMap(m); return m.size(); };
+    BENCHMARK("PageTable insert") { PageTable<BenchValue> t; FillMap(t); return t.size(); };
+
+    BENCHMARK("map find") { return FindAll(map); };
+    BENCHMARK("PageTable find") { return FindAll(table); };
+
+    BENCHMARK("map iterate") { return IterateAll(map); };
+    BENCHMARK("PageTable iterate") { return IterateAll(table); };
+}
+
+} // namespace
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
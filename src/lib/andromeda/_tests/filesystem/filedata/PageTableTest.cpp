@@ -0,0 +1,102 @@
+
+#include <string>
+#include <vector>
+
+#include "catch2/catch_test_macros.hpp"
+
+#include "andromeda/filesystem/filedata/PageTable.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+namespace { // anonymous
+
+using TestTable = PageTable<std::string>;
+constexpr uint64_t CHUNK { TestTable::CHUNK_SIZE };
+
+/*****************************************************/
+TEST_CASE("Basic", "[PageTable]")
+{
+    TestTable table;
+    REQUIRE(table.empty());
+    REQUIRE(table.begin() == table.end());
+    REQUIRE(table.find(0) == table.end());
+    REQUIRE(table.find(12345) == table.end());
+
+    REQUIRE(table.try_emplace(5, "five").second);
+    REQUIRE(!table.try_emplace(5, "other").second); // no replace
+    REQUIRE(table.emplace(CHUNK*3+1, "far").second);
+    REQUIRE(table.size() == 2);
+
+    REQUIRE(table.find(5)->second == "five");
+    REQUIRE(table.find(CHUNK*3+1)->first == CHUNK*3+1);
+    REQUIRE(table.find(6) == table.end());
+    REQUIRE(table.find(CHUNK*2) == table.end());
+
+    const std::string& ref { table.find(5)->second };
+    for (uint64_t i { 0 }; i < CHUNK*10; i += 3) // grow the top level
+        table.try_emplace(i, std::to_string(i));
+    REQUIRE(&ref == &table.find(5)->second); // stable references
+    REQUIRE(table.find(CHUNK*9)->second == std::to_string(CHUNK*9));
+}
+
+/*****************************************************/
+TEST_CASE("Iterate", "[PageTable]")
+{
+    TestTable table;
+    const std::vector<uint64_t> keys { 0, 1, 2, CHUNK-1, CHUNK*4, CHUNK*4+7, CHUNK*100 };
+    for (std::vector<uint64_t>::const_reverse_iterator it { keys.rbegin() }; it != keys.rend(); ++it)
+        table.try_emplace(*it, std::to_string(*it));
+
+    std::vector<uint64_t> found;
+    for (const TestTable::value_type& pair : table)
+    {
+        REQUIRE(pair.second == std::to_string(pair.first));
+        found.push_back(pair.first);
+    }
+    REQUIRE(found == keys); // in order
+
+    REQUIRE(table.upper_bound(2)->first == CHUNK-1);
+    REQUIRE(table.upper_bound(CHUNK-1)->first == CHUNK*4);
+    REQUIRE(table.lower_bound(CHUNK*4)->first == CHUNK*4);
+    REQUIRE(table.upper_bound(CHUNK*100) == table.end());
+
+    const TestTable& ctable { table };
+    TestTable::const_iterator cit { ctable.find(CHUNK*4) };
+    REQUIRE((++cit)->first == CHUNK*4+7);
+    cit = table.find(1); // convert
+    REQUIRE(cit->second == "1");
+}
+
+/*****************************************************/
+TEST_CASE("Erase", "[PageTable]")
+{
+    TestTable table;
+    for (uint64_t i { 0 }; i < CHUNK*3; ++i)
+        table.try_emplace(i, std::to_string(i));
+    REQUIRE(table.size() == CHUNK*3);
+
+    REQUIRE(table.erase(1) == 1);
+    REQUIRE(table.erase(1) == 0);
+    REQUIRE(table.erase(CHUNK*50) == 0);
+    REQUIRE(table.find(1) == table.end());
+    REQUIRE(table.upper_bound(0)->first == 2);
+
+    // erase while iterating, freeing all chunks
+    size_t count { 0 };
+    for (TestTable::iterator it { table.begin() }; it != table.end(); ++count)
+        it = table.erase(it);
+    REQUIRE(count == CHUNK*3-1);
+    REQUIRE(table.empty());
+    REQUIRE(table.begin() == table.end());
+
+    table.try_emplace(CHUNK*2, "again");
+    REQUIRE(table.begin()->second == "again");
+    table.clear();
+    REQUIRE(table.empty());
+}
+
+} // namespace
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
@@ -0,0 +1,165 @@
+
+#include <algorithm>
+#include <vector>
+
+#include "catch2/catch_test_macros.hpp"
+
+#include "andromeda/filesystem/filedata/CachingAllocator.hpp"
+#include "andromeda/filesystem/filedata/Page.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+namespace { // anonymous
+
+/*****************************************************/
+TEST_CASE("Valid", "[Page]")
+{
+    CachingAllocator alloc(0);
+    Page page(10000, alloc); // 3 blocks, last is short
+    REQUIRE(!page.isPartial());
+    REQUIRE(page.isValid(0, 10000));
+
+    page.setPartial(4096);
+    REQUIRE(page.isPartial());
+    REQUIRE(page.getBlockSize() == 4096);
+    REQUIRE(!page.isValid(0, 1));
+    REQUIRE(page.getInvalidRange(100, 10) == std::make_pair<size_t,size_t>(0, 4096));
+    REQUIRE(page.getInvalidRange(4000, 200) == std::make_pair<size_t,size_t>(0, 8192));
+    REQUIRE(page.getInvalidRange(9000, 1000) == std::make_pair<size_t,size_t>(8192, 1808));
+
+    page.setValid(4096, 4096);
+    REQUIRE(page.isBlockValid(1));
+    REQUIRE(page.isValid(5000, 100));
+    REQUIRE(!page.isValid(4000, 200));
+    REQUIRE(page.getInvalidRange(4000, 5000) == std::make_pair<size_t,size_t>(0, 10000));
+    REQUIRE(page.getInvalidRange(5000, 100).second == 0);
+
+    page.setValid(100, 100); // not a whole block
+    REQUIRE(!page.isBlockValid(0));
+
+    page.setValid(8192, 1808); // through the page end
+    REQUIRE(page.isBlockValid(2));
+    REQUIRE(page.isPartial());
+
+    page.setValid(0, 4096);
+    REQUIRE(!page.isPartial());
+    REQUIRE(page.isValid(0, 10000));
+}
+
+/*****************************************************/
+TEST_CASE("ResizePartial", "[Page]")
+{
+    CachingAllocator alloc(0);
+    Page page(4096, alloc);
+    page.setPartial(1024);
+    page.setValid(0, 4096);
+    REQUIRE(!page.isPartial());
+
+    page.setPartial(1024);
+    page.setValid(0, 1024);
+    page.resize(6000); // new blocks are invalid
+    REQUIRE(page.isBlockValid(0));
+    REQUIRE(!page.isBlockValid(5));
+    REQUIRE(page.getInvalidRange(5000, 1000) == std::make_pair<size_t,size_t>(4096, 1904));
+
+    page.resize(1000); // shrink to the valid part
+    REQUIRE(page.isValid(0, 1000));
+}
+
+/*****************************************************/
+TEST_CASE("DirtyRanges", "[Page]")
+{
+    CachingAllocator alloc(0);
+    Page page(10000, alloc);
+
+    page.addDirtyRange(100, 100); // not partial, no-op
+    REQUIRE(page.getDirtyRanges().empty());
+
+    page.setPartial(1024);
+    page.addDirtyRange(100, 100);
+    page.addDirtyRange(300, 100);
+    REQUIRE(page.getDirtyRanges().size() == 2);
+    page.addDirtyRange(150, 150); // merge all three
+    REQUIRE(page.getDirtyRanges() == Page::DirtyRanges{{100, 400}});
+    page.addDirtyRange(400, 50); // adjacent
+    REQUIRE(page.getDirtyRanges() == Page::DirtyRanges{{100, 450}});
+
+    REQUIRE(!page.isBlockValid(0));
+    REQUIRE(page.isValid(100, 350));
+    REQUIRE(page.isValid(200, 10));
+    REQUIRE(!page.isValid(50, 100));
+    REQUIRE(!page.isValid(400, 100));
+    REQUIRE(page.getInvalidRange(100, 350).second == 0);
+    REQUIRE(page.getInvalidRange(0, 2048) == std::make_pair<size_t,size_t>(0, 2048));
+
+    page.addDirtyRange(1024, 2048); // covers blocks 1 and 2
+    REQUIRE(page.isBlockValid(1));
+    REQUIRE(page.isBlockValid(2));
+    REQUIRE(page.getInvalidRange(1000, 2072) == std::make_pair<size_t,size_t>(0, 1024));
+
+    page.setDirty();
+    page.setDirty(false);
+    REQUIRE(page.getDirtyRanges().empty());
+    REQUIRE(page.isPartial());
+}
+
+/*****************************************************/
+TEST_CASE("DirtyRangesFill", "[Page]")
+{
+    CachingAllocator alloc(0);
+    Page page(4000, alloc);
+    page.setPartial(1000);
+
+    std::fill(page.data()+100, page.data()+200, 'w');
+    page.addDirtyRange(100, 100);
+    std::fill(page.data()+500, page.data()+600, 'w');
+    page.addDirtyRange(500, 100);
+
+    const std::vector<char> fetched(1000, 'r');
+    page.fillClean(0, fetched.data(), fetched.size());
+    page.setValid(0, 1000);
+
+    for (size_t i { 0 }; i < 1000; ++i)
+        REQUIRE(page.data()[i] == (((i >= 100 && i < 200) || (i >= 500 && i < 600)) ? 'w' : 'r'));
+
+    page.resize(550); // trims the second range
+    REQUIRE(page.getDirtyRanges() == Page::DirtyRanges{{100, 200}, {500, 550}});
+
+    page.addDirtyRange(0, 550); // now entirely valid
+    REQUIRE(!page.isPartial());
+    REQUIRE(page.getDirtyRanges().empty());
+}
+
+/*****************************************************/
+TEST_CASE("Sparse", "[Page]")
+{
+    CachingAllocator alloc(0);
+    Page page(10000, alloc, true);
+    REQUIRE(page.isSparse());
+    REQUIRE(page.size() == 10000);
+    REQUIRE(page.capacity() == 0);
+    REQUIRE(page.data() == nullptr);
+
+    page.resize(20000); // no memory
+    REQUIRE(page.size() == 20000);
+    REQUIRE(page.capacity() == 0);
+
+    Page page2(std::move(page));
+    REQUIRE(page2.isSparse());
+    REQUIRE(page2.size() == 20000);
+
+    page2.materialize();
+    REQUIRE(!page2.isSparse());
+    REQUIRE(page2.size() == 20000);
+    REQUIRE(page2.capacity() >= 20000);
+    REQUIRE(std::all_of(page2.data(), page2.data()+page2.size(), [](const char chr){ return chr == 0; }));
+
+    page2.materialize(); // no-op
+    REQUIRE(!page2.isSparse());
+}
+
+} // namespace
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
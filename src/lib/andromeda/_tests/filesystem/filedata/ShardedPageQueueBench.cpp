@@ -0,0 +1,66 @@
+
+#include <deque>
+#include <thread>
+#include <vector>
+
+#include "catch2/catch_test_macros.hpp"
+#include "catch2/benchmark/catch_benchmark.hpp"
+
+#include "andromeda/filesystem/filedata/CachingAllocator.hpp"
+#include "andromeda/filesystem/filedata/LRUPolicy.hpp"
+#include "andromeda/filesystem/filedata/Page.hpp"
+#include "andromeda/filesystem/filedata/ShardedPageQueue.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+namespace { // anonymous
+
+/** Stands in for a PageManager (one file) */
+struct BenchOwner { int mDummy { 0 }; };
+
+using BenchQueue = ShardedPageQueue<BenchOwner>;
+
+constexpr size_t NUM_THREADS { 8 };
+constexpr size_t NUM_PAGES { 64 }; // per thread
+constexpr size_t NUM_ACCESSES { 20000 }; // per thread
+
+/** N threads each repeatedly informing about pages of their own file, like N readers of N files */
+size_t ReadFiles(BenchQueue& queue, std::deque<BenchOwner>& owners, std::vector<std::deque<Page>>& pages)
+{
+    std::vector<std::thread> threads;
+    for (size_t thread { 0 }; thread < NUM_THREADS; ++thread)
+        threads.emplace_back([&, thread]()
+        {
+            for (size_t i { 0 }; i < NUM_ACCESSES; ++i)
+            {
+                const size_t index { i % NUM_PAGES };
+                queue.Enqueue(owners[thread], index, pages[thread][index], false, false);
+            }
+        });
+
+    for (std::thread& thread : threads) thread.join();
+    return queue.GetTotal();
+}
+
+/*****************************************************/
+TEST_CASE("Benchmark", "[ShardedPageQueue][!benchmark]")
+{
+    CachingAllocator alloc(0);
+    std::deque<BenchOwner> owners(NUM_THREADS);
+    std::vector<std::deque<Page>> pages(NUM_THREADS);
+    for (std::deque<Page>& filePages : pages)
+        for (size_t i { 0 }; i < NUM_PAGES; ++i)
+            filePages.emplace_back(4096, alloc);
+
+    BenchQueue queue1(1, []{ return std::make_unique<LRUPolicy>(); });
+    BenchQueue queue16(16, []{ return std::make_unique<LRUPolicy>(); });
+
+    BENCHMARK("1 shard") { return ReadFiles(queue1, owners, pages); };
+    BENCHMARK("16 shards") { return ReadFiles(queue16, owners, pages); };
+}
+
+} // namespace
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
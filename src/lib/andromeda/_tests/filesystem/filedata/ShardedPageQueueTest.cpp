@@ -0,0 +1,235 @@
+
+#include <chrono>
+#include <deque>
+#include <thread>
+#include <vector>
+
+#include "catch2/catch_test_macros.hpp"
+
+#include "andromeda/filesystem/filedata/ARCPolicy.hpp"
+#include "andromeda/filesystem/filedata/CachingAllocator.hpp"
+#include "andromeda/filesystem/filedata/LRUPolicy.hpp"
+#include "andromeda/filesystem/filedata/Page.hpp"
+#include "andromeda/filesystem/filedata/ShardedPageQueue.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+namespace { // anonymous
+
+/** Stands in for a PageManager */
+struct TestOwner { int mDummy { 0 }; };
+
+using TestQueue = ShardedPageQueue<TestOwner>;
+
+/** Returns a new queue with the given number of LRU shards */
+TestQueue MakeQueue(const size_t shards)
+{
+    return TestQueue(shards, []{ return std::make_unique<LRUPolicy>(); });
+}
+
+/*****************************************************/
+TEST_CASE("Accounting", "[ShardedPageQueue]")
+{
+    CachingAllocator alloc(0);
+    TestOwner owner1, owner2;
+    TestQueue queue { MakeQueue(4) };
+
+    Page page1(4096, alloc), page2(4096, alloc), page3(8192, alloc);
+    const size_t size1 { page1.capacity() }, size3 { page3.capacity() };
+
+    REQUIRE(queue.Enqueue(owner1, 0, page1, false, false) == 0);
+    REQUIRE(queue.Enqueue(owner1, 1, page2, true, false) == 0);
+    REQUIRE(queue.Enqueue(owner2, 0, page3, true, false) == 0);
+    REQUIRE(queue.GetTotal() == size1*2+size3);
+    REQUIRE(queue.GetDirty() == size1+size3);
+    REQUIRE(queue.GetPageCount() == 3);
+    REQUIRE(queue.GetDirtyCount() == 2);
+
+    // re-enqueue returns the old size, can change dirty
+    REQUIRE(queue.Enqueue(owner1, 1, page2, false, false) == size1);
+    REQUIRE(queue.GetTotal() == size1*2+size3);
+    REQUIRE(queue.GetDirty() == size3);
+
+    queue.RemoveDirty(owner2, page3);
+    REQUIRE(queue.GetDirty() == 0);
+    REQUIRE(queue.GetDirtyCount() == 0);
+
+    REQUIRE(queue.Remove(owner1, page1) == size1);
+    REQUIRE(queue.Remove(owner1, page1) == 0);
+    REQUIRE(queue.Remove(owner2, page3) == size3);
+    REQUIRE(queue.GetTotal() == size1);
+    REQUIRE(queue.GetPageCount() == 1);
+}
+
+/*****************************************************/
+TEST_CASE("Resize", "[ShardedPageQueue]")
+{
+    CachingAllocator alloc(0);
+    TestOwner owner;
+    TestQueue queue { MakeQueue(2) };
+
+    Page page(4096, alloc);
+    queue.Enqueue(owner, 0, page, true, false);
+    const size_t oldSize { page.capacity() };
+
+    page.resize(65536);
+    const TestQueue::ResizeResult grow { queue.Resize(owner, page) };
+    REQUIRE(grow.grew); REQUIRE(grow.grewDirty);
+    REQUIRE(queue.GetTotal() == page.capacity());
+    REQUIRE(queue.GetDirty() == page.capacity());
+
+    page.resize(4096);
+    const TestQueue::ResizeResult shrink { queue.Resize(owner, page) };
+    REQUIRE(!shrink.grew); REQUIRE(!shrink.grewDirty);
+    REQUIRE(queue.GetTotal() == oldSize);
+    REQUIRE(queue.GetDirty() == oldSize);
+
+    Page other(4096, alloc); // not enqueued
+    const TestQueue::ResizeResult none { queue.Resize(owner, other) };
+    REQUIRE(!none.grew); REQUIRE(!none.grewDirty);
+}
+
+/*****************************************************/
+TEST_CASE("GetNext", "[ShardedPageQueue]")
+{
+    CachingAllocator alloc(0);
+    TestOwner owner1, owner2;
+    TestQueue queue { MakeQueue(1) }; // all in one shard
+
+    Page page1(4096, alloc), page2(4096, alloc);
+    queue.Enqueue(owner1, 5, page1, true, false);
+    queue.Enqueue(owner2, 6, page2, true, false);
+
+    const std::optional<TestQueue::PageInfo> evict { queue.GetNextEvict(owner1, page2) };
+    REQUIRE(evict); REQUIRE(&evict->mOwner == &owner1); REQUIRE(evict->mPageIndex == 5);
+    REQUIRE(!queue.GetNextEvict(owner1, page1)); // skipped
+    REQUIRE(!queue.GetNextEvict(owner2, page2)); // not owned
+
+    const std::optional<TestQueue::PageInfo> flush { queue.GetNextFlush(owner1, page2) };
+    REQUIRE(flush); REQUIRE(flush->mPageIndex == 5);
+    REQUIRE(!queue.GetNextFlush(owner2, page2));
+}
+
+/*****************************************************/
+TEST_CASE("GetEvictions", "[ShardedPageQueue]")
+{
+    CachingAllocator alloc(0);
+    std::deque<TestOwner> owners(8);
+    std::deque<Page> pages;
+    TestQueue queue { MakeQueue(4) };
+
+    for (TestOwner& owner : owners)
+        for (uint64_t index { 0 }; index < 4; ++index)
+        {
+            pages.emplace_back(4096, alloc);
+            queue.Enqueue(owner, index, pages.back(), true, false);
+        }
+    const size_t pageSize { pages.front().capacity() };
+    REQUIRE(queue.GetTotal() == pageSize*32);
+
+    SECTION("Chooses at least the bytes requested")
+    {
+        size_t chosen { 0 };
+        queue.GetEvictions(pageSize*10, [&](const Page& page, const TestQueue::PageInfo& pageInfo){
+            chosen += pageInfo.mPageSize; return true; });
+        REQUIRE(chosen >= pageSize*10);
+        REQUIRE(chosen < pageSize*14); // rounded up per-shard
+        REQUIRE(queue.GetPageCount() == 32); // not removed
+    }
+
+    SECTION("Removes pages rejected by func")
+    {
+        queue.GetEvictions(pageSize*32, [&](const Page& page, const TestQueue::PageInfo& pageInfo){
+            return &pageInfo.mOwner != &owners.front(); });
+        REQUIRE(queue.GetPageCount() == 28);
+        REQUIRE(queue.GetTotal() == pageSize*28);
+        REQUIRE(queue.GetDirty() == pageSize*28);
+    }
+
+    SECTION("Flushes")
+    {
+        size_t chosen { 0 };
+        queue.GetFlushes(pageSize*32, TestQueue::Clock::time_point(), [&](const Page& page, const TestQueue::PageInfo& pageInfo){
+            chosen += pageInfo.mPageSize; return true; });
+        REQUIRE(chosen == pageSize*32);
+    }
+}
+
+/*****************************************************/
+TEST_CASE("ARCSingleOwner", "[ShardedPageQueue]")
+{
+    CachingAllocator alloc(0);
+    TestOwner owner;
+    std::deque<Page> pages;
+    for (size_t i { 0 }; i < 13; ++i) pages.emplace_back(4096, alloc);
+    const size_t pageSize { pages.front().capacity() };
+
+    std::vector<const ARCPolicy*> policies;
+    TestQueue queue(16, [&]{ std::unique_ptr<ARCPolicy> policy { std::make_unique<ARCPolicy>(0) };
+        policies.push_back(policy.get()); return policy; });
+    queue.SetCapacity(pageSize*8);
+
+    const auto enqueue { [&](const uint64_t index, const Page& page)
+    {
+        queue.Enqueue(owner, index, page, false, false);
+        if (queue.GetTotal() <= pageSize*8) return;
+
+        std::vector<const Page*> evicts;
+        queue.GetEvictions(queue.GetTotal()-pageSize*8, [&](const Page& evict, const TestQueue::PageInfo& pageInfo){
+            evicts.push_back(&evict); return true; });
+        for (const Page* evict : evicts) queue.Remove(owner, *evict, true);
+    }};
+
+    // a working set of 4 pages used twice, then a scan of 8 pages used once
+    for (uint64_t index { 0 }; index < 4; ++index) enqueue(index, pages[index]);
+    for (uint64_t index { 0 }; index < 4; ++index) enqueue(index, pages[index]);
+    for (uint64_t index { 4 }; index < 12; ++index) enqueue(index, pages[index]);
+    REQUIRE(queue.GetTotal() == pageSize*8);
+
+    // all of the owner's pages are in one shard, which must get the whole cache
+    // size to remember the scanned pages it evicted
+    enqueue(6, pages[12]);
+    size_t frequent { 0 };
+    for (const ARCPolicy* policy : policies)
+        if (policy->isFrequent(&pages[12])) ++frequent;
+    REQUIRE(frequent == 1);
+}
+
+/*****************************************************/
+TEST_CASE("DirtyAge", "[ShardedPageQueue]")
+{
+    CachingAllocator alloc(0);
+    TestOwner owner;
+    TestQueue queue { MakeQueue(2) };
+    REQUIRE(!queue.GetOldestDirty());
+
+    Page page1(4096, alloc), page2(4096, alloc);
+    queue.Enqueue(owner, 0, page1, true, false);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    const TestQueue::Clock::time_point between { TestQueue::Clock::now() };
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    queue.Enqueue(owner, 1, page2, true, false);
+
+    // re-writing a dirty page keeps its dirty time
+    queue.Enqueue(owner, 0, page1, true, false);
+    REQUIRE(queue.GetOldestDirty());
+    REQUIRE(*queue.GetOldestDirty() <= between);
+
+    // only the expired page is chosen when not over the limit
+    std::vector<uint64_t> chosen;
+    queue.GetFlushes(0, between, [&](const Page& page, const TestQueue::PageInfo& pageInfo){
+        chosen.push_back(pageInfo.mPageIndex); return true; });
+    REQUIRE(chosen == std::vector<uint64_t>{0});
+
+    // a clean page that is dirtied again gets a new time
+    queue.Enqueue(owner, 0, page1, false, false);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    queue.Enqueue(owner, 0, page1, true, false);
+    REQUIRE(*queue.GetOldestDirty() > between);
+}
+
+} // namespace
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
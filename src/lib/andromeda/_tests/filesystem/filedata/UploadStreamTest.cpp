@@ -0,0 +1,165 @@
+
+#include <string>
+#include "nlohmann/json.hpp"
+#include "catch2/catch_test_macros.hpp"
+
+#include "andromeda/backend/RunnerInput.hpp"
+#include "andromeda/filesystem/filedata/UploadStream.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+namespace { // anonymous
+
+using Backend::RunnerInput;
+using Backend::WriteFunc;
+
+/** Reads the whole stream in small chunks like an HTTP runner would */
+std::string ReadAll(const WriteFunc& writeFunc)
+{
+    std::string data; char buf[7];
+    for (bool more { true }; more; )
+    {
+        size_t read { 0 };
+        more = writeFunc(data.size(), buf, sizeof(buf), read);
+        data.append(buf, read);
+    }
+    return data;
+}
+
+/*****************************************************/
+TEST_CASE("Basic", "[UploadStream]")
+{
+    std::string uploaded;
+    UploadStream stream(16, 0, [&](const WriteFunc& writeFunc)->nlohmann::json
+    {
+        uploaded = ReadAll(writeFunc);
+        return {{"size", uploaded.size()}};
+    });
+
+    std::string expect;
+    for (size_t i { 0 }; i < 100; ++i) // much larger than the buffer
+    {
+        const std::string chunk(i % 10 + 1, static_cast<char>('a' + i % 26));
+        stream.Write(chunk.data(), chunk.size());
+        expect += chunk;
+    }
+    stream.Write(nullptr, 20); expect += std::string(20, '\0');
+    REQUIRE(stream.GetWritten() == expect.size());
+
+    const nlohmann::json result(stream.Finish());
+    REQUIRE(result.at("size").get<size_t>() == expect.size());
+    REQUIRE(uploaded == expect);
+}
+
+/*****************************************************/
+TEST_CASE("Empty", "[UploadStream]")
+{
+    std::string uploaded { "x" };
+    UploadStream stream(16, 0, [&](const WriteFunc& writeFunc)->nlohmann::json
+    {
+        uploaded = ReadAll(writeFunc); return {};
+    });
+
+    stream.Finish();
+    REQUIRE(uploaded.empty());
+}
+
+/*****************************************************/
+TEST_CASE("Failure", "[UploadStream]")
+{
+    UploadStream stream(16, 0, [&](const WriteFunc& writeFunc)->nlohmann::json
+    {
+        char buf[4]; size_t read { 0 };
+        writeFunc(0, buf, sizeof(buf), read);
+        throw RunnerInput::StreamFailException("Test");
+    });
+
+    const std::string data(64, 'a'); // more than the buffer, must not block forever
+    REQUIRE_THROWS_AS(stream.Write(data.data(), data.size()), RunnerInput::StreamFailException);
+    REQUIRE_THROWS_AS(stream.Finish(), RunnerInput::StreamFailException);
+    REQUIRE_THROWS_AS(stream.Finish(), RunnerInput::StreamFailException); // stays failed
+}
+
+/*****************************************************/
+TEST_CASE("Rewind", "[UploadStream]")
+{
+    UploadStream stream(16, 0, [&](const WriteFunc& writeFunc)->nlohmann::json
+    {
+        char buf[4]; size_t read { 0 };
+        writeFunc(0, buf, sizeof(buf), read);
+        writeFunc(0, buf, sizeof(buf), read); // e.g. a retry
+        return {};
+    });
+
+    stream.Write("abcdefgh", 8);
+    REQUIRE_THROWS_AS(stream.Finish(), RunnerInput::StreamSeekException);
+}
+
+/*****************************************************/
+TEST_CASE("Replay", "[UploadStream]")
+{
+    std::string uploaded;
+    UploadStream stream(4, 8, [&](const WriteFunc& writeFunc)->nlohmann::json
+    {
+        char buf[4]; size_t read { 0 };
+        writeFunc(0, buf, sizeof(buf), read);
+        writeFunc(read, buf, sizeof(buf), read);
+        uploaded = ReadAll(writeFunc); // e.g. a retry from the start
+        return {};
+    });
+
+    stream.Write("abcdefghijklmnop", 16); // must not need to keep more than the replay size
+    stream.Finish();
+    REQUIRE(uploaded == "abcdefghijklmnop");
+}
+
+/*****************************************************/
+TEST_CASE("ReplayTooFar", "[UploadStream]")
+{
+    UploadStream stream(4, 4, [&](const WriteFunc& writeFunc)->nlohmann::json
+    {
+        char buf[4]; size_t read { 0 };
+        for (size_t offset { 0 }; offset < 8; offset += read)
+            writeFunc(offset, buf, sizeof(buf), read);
+        writeFunc(0, buf, sizeof(buf), read); // beyond the replay size
+        return {};
+    });
+
+    stream.Write("abcdefgh", 8);
+    REQUIRE_THROWS_AS(stream.Finish(), RunnerInput::StreamSeekException);
+}
+
+/*****************************************************/
+TEST_CASE("EndedEarly", "[UploadStream]")
+{
+    UploadStream stream(16, 0, [&](const WriteFunc& writeFunc)->nlohmann::json
+    {
+        char buf[4]; size_t read { 0 };
+        writeFunc(0, buf, sizeof(buf), read);
+        return {};
+    });
+
+    stream.Write("abcdefgh", 8);
+    REQUIRE_THROWS_AS(stream.Finish(), RunnerInput::StreamFailException);
+}
+
+/*****************************************************/
+TEST_CASE("Abort", "[UploadStream]")
+{
+    bool aborted { false };
+    { UploadStream stream(16, 0, [&](const WriteFunc& writeFunc)->nlohmann::json
+    {
+        try { ReadAll(writeFunc); }
+        catch (const RunnerInput::StreamFailException& ex) { aborted = true; throw; }
+        return {};
+    });
+    stream.Write("abcd", 4); } // destruct without Finish()
+
+    REQUIRE(aborted);
+}
+
+} // namespace
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
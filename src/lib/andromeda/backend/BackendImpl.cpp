@@ -1,5 +1,7 @@
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <iostream>
 #include <map>
 #include <string>
@@ -8,10 +10,12 @@
 #include "nlohmann/json.hpp"
 
 #include "BackendImpl.hpp"
+#include "BandwidthEstimator.hpp"
 #include "HTTPRunner.hpp"
 #include "RunnerInput.hpp"
 #include "RunnerPool.hpp"
 #include "SessionStore.hpp"
+#include "WorkerPool.hpp"
 #include "andromeda/ConfigOptions.hpp"
 #include "andromeda/Crypto.hpp"
 #include "andromeda/PlatformUtil.hpp"
@@ -28,6 +32,8 @@ std::atomic<uint64_t> BackendImpl::sReqNext { 1 };
 /*****************************************************/
 BackendImpl::BackendImpl(const ConfigOptions& options, RunnerPool& runners) : 
     mOptions(options), mRunners(runners),
+    mWorkers(std::make_unique<WorkerPool>(options.workerPoolSize, options.workerQueueSize)),
+    mBandwidth(std::make_unique<BandwidthEstimator>()),
     mDebug("Backend",this) , mConfig(*this)
     // loading mConfig now has the nice side effect of making sure any potential
     // HTTP->HTTPS redirect is out of the way before trying other actions!
@@ -180,40 +186,91 @@ nlohmann::json BackendImpl::GetJSON(const std::string& resp)
     }
 }
 
+/*****************************************************/
+std::string BackendImpl::GetFlightKey(const RunnerInput& input)
+{
+    // control char separators so names/values cannot run together into another key
+    std::string key { input.app + '\0' + input.action };
+    for (const RunnerInput::Params* params : { &input.plainParams, &input.dataParams })
+    {
+        key += '\1';
+        for (const auto& [pkey,pval] : *params)
+            key += '\0' + pkey + '\0' + pval;
+    }
+    return key;
+}
+
+/*****************************************************/
+std::string BackendImpl::RunFlight_Read(const RunnerInput& input, const std::function<std::string()>& func)
+{
+    bool shared { false };
+    const std::string key { GetFlightKey(input) + '\2' + std::to_string(mWriteGen.load()) };
+    std::string resp { mReadFlights.Run(key, func, &shared) };
+
+    if (shared) { MDBG_INFO("... coalesced " << input.app << " " << input.action); }
+    return resp;
+}
+
+/*****************************************************/
+std::string BackendImpl::RunFlight_Write(const std::function<std::string()>& func)
+{
+    // also if it failed, it may have been partially done
+    try { std::string resp { func() }; ++mWriteGen; return resp; }
+    catch (...) { ++mWriteGen; throw; }
+}
+
 /*****************************************************/
 std::string BackendImpl::RunAction_ReadStr(RunnerInput& input)
 {
-    return mRunners.GetRunner()->RunAction_Read(FinalizeInput(input));
+    FinalizeInput(input);
+    return RunFlight_Read(input, [&]()->std::string {
+        return mRunners.GetRunner(RunnerPool::Priority::FOREGROUND)->RunAction_Read(input); }); // file data
 }
 
 /*****************************************************/
 nlohmann::json BackendImpl::RunAction_Read(RunnerInput& input)
 {
-    return GetJSON(mRunners.GetRunner()->RunAction_Read(FinalizeInput(input)));
+    FinalizeInput(input);
+    return GetJSON(RunFlight_Read(input, [&]()->std::string {
+        return mRunners.GetRunner(RunnerPool::Priority::INTERACTIVE)->RunAction_Read(input); }));
 }
 
 /*****************************************************/
 nlohmann::json BackendImpl::RunAction_Write(RunnerInput& input)
 {
-    return GetJSON(mRunners.GetRunner()->RunAction_Write(FinalizeInput(input)));
+    FinalizeInput(input);
+    return GetJSON(RunFlight_Write([&]()->std::string {
+        return mRunners.GetRunner(RunnerPool::Priority::INTERACTIVE)->RunAction_Write(input); }));
 }
 
 /*****************************************************/
 nlohmann::json BackendImpl::RunAction_FilesIn(RunnerInput_FilesIn& input)
 {
-    return GetJSON(mRunners.GetRunner()->RunAction_FilesIn(FinalizeInput(input)));
+    FinalizeInput(input);
+    return GetJSON(RunFlight_Write([&]()->std::string {
+        return mRunners.GetRunner(RunnerPool::Priority::FOREGROUND)->RunAction_FilesIn(input); }));
 }
 
 /*****************************************************/
-nlohmann::json BackendImpl::RunAction_StreamIn(RunnerInput_StreamIn& input)
+nlohmann::json BackendImpl::RunAction_StreamIn(RunnerInput_StreamIn& input, bool ownRunner)
 {
-    return GetJSON(mRunners.GetRunner()->RunAction_StreamIn(FinalizeInput(input)));
+    FinalizeInput(input);
+    return GetJSON(RunFlight_Write([&]()->std::string {
+        if (!ownRunner)
+            return mRunners.GetRunner(RunnerPool::Priority::FOREGROUND)->RunAction_StreamIn(input);
+
+        // a long-running stream must not hold a pooled runner that other requests are waiting on
+        RunnerPool::StreamRunner runner { mRunners.GetStreamRunner() };
+        return runner->RunAction_StreamIn(input);
+    }));
 }
 
 /*****************************************************/
-void BackendImpl::RunAction_StreamOut(RunnerInput_StreamOut& input)
+void BackendImpl::RunAction_StreamOut(RunnerInput_StreamOut& input, std::chrono::steady_clock::time_point* timeStart)
 {
-    mRunners.GetRunner()->RunAction_StreamOut(FinalizeInput(input));
+    RunnerPool::LockedRunner runner { mRunners.GetRunner(RunnerPool::Priority::FOREGROUND) };
+    if (timeStart != nullptr) *timeStart = std::chrono::steady_clock::now();
+    runner->RunAction_StreamOut(FinalizeInput(input));
 }
 
 /*****************************************************/
@@ -654,6 +711,9 @@ void BackendImpl::ReadFile(const std::string& id, const uint64_t offset, const s
 
     if (isMemory()) { userFunc(0, std::string(length,'\0').data(), length); return; } // debug only
 
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point timeStart, timeFirst; // waiting for a runner is not RTT
+
     size_t read = 0; RunnerInput_StreamOut input {{"files", "download", {{"file", id}}, // plainParams
         {{"fstart", fstart}, {"flast", flast}}}, // dataParams
         [&](const size_t soffset, const char* buf, const size_t buflen)->void
@@ -661,12 +721,15 @@ void BackendImpl::ReadFile(const std::string& id, const uint64_t offset, const s
         if (soffset+buflen > length) // too much data
             throw ReadSizeException(length, soffset+buflen);
         
+        if (!read) timeFirst = Clock::now();
         read = std::max(read, soffset+buflen);
         userFunc(soffset, buf, buflen); 
     }}; MDBG_BACKEND(input);
 
-    RunAction_StreamOut(input);
+    RunAction_StreamOut(input, &timeStart);
     if (read < length) throw ReadSizeException(length, read);
+
+    mBandwidth->AddSample(length, timeFirst-timeStart, Clock::now()-timeStart);
 }
 
 namespace { // anonymous
@@ -695,7 +758,7 @@ nlohmann::json BackendImpl::WriteFile(const std::string& id, const uint64_t offs
 
     if (isMemory()) return nullptr; // debug only
 
-    return SendFile(userFunc, id, offset, nullptr, false);
+    return SendFile(userFunc, id, offset, nullptr, false, false);
 }
 
 /*****************************************************/
@@ -709,7 +772,7 @@ nlohmann::json BackendImpl::UploadFile(const std::string& parent, const std::str
 }
 
 /*****************************************************/
-nlohmann::json BackendImpl::UploadFile(const std::string& parent, const std::string& name, const WriteFunc& userFunc, bool oneshot, bool overwrite)
+nlohmann::json BackendImpl::UploadFile(const std::string& parent, const std::string& name, const WriteFunc& userFunc, bool oneshot, bool overwrite, bool stream)
 {
     MDBG_INFO("(parent:" << parent << " name:" << name << ")");
 
@@ -728,11 +791,11 @@ nlohmann::json BackendImpl::UploadFile(const std::string& parent, const std::str
         return {{{"files", "upload", 
             {{"parent", parent}, {"overwrite", BOOLSTR(overwrite)}}}}, // plainParams
             {{"file", {name, writeFunc}}}}; // StreamIn
-    }, oneshot);
+    }, oneshot, stream);
 }
 
 /*****************************************************/
-nlohmann::json BackendImpl::SendFile(const WriteFunc& userFunc, std::string id, const uint64_t offset, const UploadInput& getUpload, bool oneshot)
+nlohmann::json BackendImpl::SendFile(const WriteFunc& userFunc, std::string id, const uint64_t offset, const UploadInput& getUpload, bool oneshot, bool stream)
 {
     nlohmann::json retval;    // last json response to return
     size_t byte { 0 };        // starting stream offset to read
@@ -740,7 +803,10 @@ nlohmann::json BackendImpl::SendFile(const WriteFunc& userFunc, std::string id,
     
     while (streamCont) // retry or chunk by MaxBytes
     {
-        const size_t maxSize { mConfig.GetUploadMaxBytes() };
+        size_t maxSize { mConfig.GetUploadMaxBytes() };
+        // a stream can only replay its last uploadStreamBuffer bytes, so a retry can't span more - 
+        // except oneshot, which can't be chunked so can only be retried if it fit in the buffer
+        if (stream && !oneshot) maxSize = maxSize ? std::min(maxSize, mOptions.uploadStreamBuffer) : mOptions.uploadStreamBuffer;
         MDBG_INFO("... byte:" << byte << " maxSize:" << maxSize);
 
         size_t streamSize { 0 }; // total bytes read during stream
@@ -752,7 +818,7 @@ nlohmann::json BackendImpl::SendFile(const WriteFunc& userFunc, std::string id,
                 else { sread = 0; return false; } // end of chunk
             }
 
-            const size_t strSize { maxSize ? std::min(buflen,maxSize) : buflen };
+            const size_t strSize { maxSize ? std::min(buflen,maxSize-soffset) : buflen };
             streamCont = userFunc(soffset+byte, buf, strSize, sread);
             streamSize += sread; return streamCont;
         }};
@@ -769,7 +835,7 @@ nlohmann::json BackendImpl::SendFile(const WriteFunc& userFunc, std::string id,
 
         try
         {
-            retval = RunAction_StreamIn(input);
+            retval = RunAction_StreamIn(input, stream);
             retval.at("id").get_to(id);
             byte += streamSize; // next chunk
         }
@@ -2,9 +2,11 @@
 #define LIBA2_BACKENDIMPL_H_
 
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <map>
+#include <memory>
 #include <string>
 
 #include "nlohmann/json_fwd.hpp"
@@ -15,6 +17,7 @@
 #include "andromeda/common.hpp"
 #include "andromeda/ConfigOptions.hpp"
 #include "andromeda/Debug.hpp"
+#include "andromeda/SingleFlight.hpp"
 
 namespace Andromeda {
 
@@ -23,6 +26,8 @@ namespace Filesystem { namespace Filedata { class CacheManager; class CachingAll
 namespace Backend {
 class RunnerPool;
 class SessionStore;
+class BandwidthEstimator;
+class WorkerPool;
 
 /** 
  * Manages communication with the backend API 
@@ -114,6 +119,12 @@ public:
     /** Returns the CachingAllocator to use for file data */
     Filesystem::Filedata::CachingAllocator& GetPageAllocator();
 
+    /** Returns the worker pool to use for background I/O tasks */
+    inline WorkerPool& GetWorkerPool() { return *mWorkers; }
+
+    /** Returns the download performance model shared by all files */
+    inline BandwidthEstimator& GetBandwidth() { return *mBandwidth; }
+
     /** Returns true if doing memory only */
     [[nodiscard]] bool isMemory() const;
 
@@ -358,11 +369,15 @@ public:
      * @param userFunc function to stream data
      * @param oneshot if true, can't split into multiple writes
      * @param overwrite whether to overwrite existing
+     * @param stream if true, userFunc produces data over a long time (e.g. as it is written), 
+     *    so the upload uses its own runner rather than holding one from the pool, and
+     *    is split into chunks no larger than uploadStreamBuffer that userFunc can replay on retry
+     *    (unless oneshot, which can then only be retried if it is no larger than uploadStreamBuffer)
      * @throws WriteSizeException if oneshot is true and too big for one upload
      * @throws BackendException for backend issues
      */
     nlohmann::json UploadFile(const std::string& parent, const std::string& name, const WriteFunc& userFunc, 
-        bool oneshot = false, bool overwrite = false);
+        bool oneshot = false, bool overwrite = false, bool stream = false);
 
     /**
      * Truncates a file
@@ -388,18 +403,40 @@ private:
     /** Parses and returns standard Andromeda JSON */
     nlohmann::json GetJSON(const std::string& resp);
 
-    /** Finalizes input, runs the action, returns string */
+    /** Returns a key uniquely identifying the given (finalized) input for mReadFlights */
+    static std::string GetFlightKey(const RunnerInput& input);
+    /**
+     * Runs a read action, sharing the response with any identical read already running
+     * that was started since the last write finished (see mWriteGen)
+     * @param input the finalized input identifying the action
+     * @param func function that runs the action and returns the response
+     */
+    std::string RunFlight_Read(const RunnerInput& input, const std::function<std::string()>& func);
+    /**
+     * Runs a write action, then makes later reads start a new flight rather than
+     * share one that started before the write finished (and may not see it)
+     * @param func function that runs the action and returns the response
+     */
+    std::string RunFlight_Write(const std::function<std::string()>& func);
+
+    /** Finalizes input, runs the action (coalesced), returns string */
     std::string RunAction_ReadStr(RunnerInput& input);
-    /** Finalizes input, runs the action, returns JSON */
+    /** Finalizes input, runs the action (coalesced), returns JSON */
     nlohmann::json RunAction_Read(RunnerInput& input);
     /** Finalizes input, runs the action, returns JSON */
     nlohmann::json RunAction_Write(RunnerInput& input);
     /** Finalizes input, runs the action, returns JSON */
     nlohmann::json RunAction_FilesIn(RunnerInput_FilesIn& input);
-    /** Finalizes input, runs the action, returns JSON */
-    nlohmann::json RunAction_StreamIn(RunnerInput_StreamIn& input);
-    /** Finalizes input, runs the action, returns JSON */
-    void RunAction_StreamOut(RunnerInput_StreamOut& input);
+    /** 
+     * Finalizes input, runs the action, returns JSON 
+     * @param ownRunner if true, run on a RunnerPool::StreamRunner rather than one from the pool
+     */
+    nlohmann::json RunAction_StreamIn(RunnerInput_StreamIn& input, bool ownRunner = false);
+    /** 
+     * Finalizes input, runs the action
+     * @param timeStart if not null, set to the time the runner was acquired (excludes queueing)
+     */
+    void RunAction_StreamOut(RunnerInput_StreamOut& input, std::chrono::steady_clock::time_point* timeStart = nullptr);
 
     /** Function that is given a WriteFunc and returns a RunnerInput_StreamIn for file upload */
     using UploadInput = std::function<RunnerInput_StreamIn (const WriteFunc&)>;
@@ -411,9 +448,10 @@ private:
      * @param offset offset of the file to write to if already created (getUpload=nullptr)
      * @param getUpload function to get an input for the initial upload if NOT already created (ignore id,offset)
      * @param oneshot if true, can't split into multiple writes
+     * @param stream if true, use a new runner for each request (see UploadFile)
      * @throws WriteSizeException if oneshot is true and too big for one upload
      */
-    nlohmann::json SendFile(const WriteFunc& userFunc, std::string id, uint64_t offset, const UploadInput& getUpload, bool oneshot);
+    nlohmann::json SendFile(const WriteFunc& userFunc, std::string id, uint64_t offset, const UploadInput& getUpload, bool oneshot, bool stream);
 
     /** True if the session in use should be deleted when done */
     bool mDeleteSession { false };
@@ -429,10 +467,21 @@ private:
     ConfigOptions mOptions;
     RunnerPool& mRunners;
 
+    /** Coalesces identical concurrent read actions (key from GetFlightKey and mWriteGen) */
+    SingleFlight<std::string, std::string> mReadFlights;
+    /** The number of write actions finished, so reads only share flights started after a write */
+    std::atomic<uint64_t> mWriteGen { 0 };
+
     Filesystem::Filedata::CacheManager* mCacheMgr { nullptr };
 
     /** Allocator to use for all file pages (null if no cacheMgr) */
     std::unique_ptr<Filesystem::Filedata::CachingAllocator> mPageAllocator;
+
+    /** Worker pool for background I/O tasks (never null) */
+    std::unique_ptr<WorkerPool> mWorkers;
+
+    /** Download performance model, updated by every streamed ReadFile() (never null) */
+    std::unique_ptr<BandwidthEstimator> mBandwidth;
     
     mutable Debug mDebug;
     Config mConfig;
@@ -0,0 +1,69 @@
+
+#include <algorithm>
+
+#include "BandwidthEstimator.hpp"
+
+namespace Andromeda {
+namespace Backend {
+
+namespace { // anonymous
+
+/** Returns the new moving average with the given sample, or the sample if first */
+inline double AddAverage(const double average, const double sample, const bool first)
+{
+    return first ? sample : (average + BandwidthEstimator::EWMA_WEIGHT*(sample-average));
+}
+
+} // namespace
+
+/*****************************************************/
+BandwidthEstimator::BandwidthEstimator() :
+    mDebug(__func__,this) { }
+
+/*****************************************************/
+void BandwidthEstimator::AddSample(const size_t bytes, const Duration& firstByte, const Duration& total)
+{
+    using seconds = std::chrono::duration<double>;
+
+    const double latency { seconds(firstByte).count() };
+    const double transfer { seconds(total - firstByte).count() };
+
+    const UniqueLock lock(mMutex);
+    MDBG_INFO("(bytes:" << bytes << " latency:" << latency << " transfer:" << transfer << ")");
+
+    mRTT = AddAverage(mRTT, std::max(latency, 0.0), mRTT < 0);
+
+    if (bytes >= MIN_SAMPLE_BYTES && transfer > 0)
+        mThroughput = AddAverage(mThroughput, static_cast<double>(bytes)/transfer, mThroughput <= 0);
+
+    MDBG_INFO("... rtt:" << mRTT << " throughput:" << (mThroughput/1048576) << " MiB/s");
+}
+
+/*****************************************************/
+double BandwidthEstimator::GetThroughput() const
+{
+    const UniqueLock lock(mMutex);
+    return mThroughput;
+}
+
+/*****************************************************/
+BandwidthEstimator::Duration BandwidthEstimator::GetRTT() const
+{
+    const UniqueLock lock(mMutex);
+    return std::chrono::duration_cast<Duration>(
+        std::chrono::duration<double>(std::max(mRTT, 0.0)));
+}
+
+/*****************************************************/
+size_t BandwidthEstimator::GetTargetBytes(const std::chrono::milliseconds& timeTarget) const
+{
+    const UniqueLock lock(mMutex);
+
+    const double transfer { std::chrono::duration<double>(timeTarget).count() - std::max(mRTT, 0.0) };
+    if (mThroughput <= 0 || transfer <= 0) return 0;
+
+    return static_cast<size_t>(mThroughput * transfer);
+}
+
+} // namespace Backend
+} // namespace Andromeda
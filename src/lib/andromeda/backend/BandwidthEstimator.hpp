@@ -0,0 +1,77 @@
+#ifndef LIBA2_BANDWIDTHESTIMATOR_H_
+#define LIBA2_BANDWIDTHESTIMATOR_H_
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#include "andromeda/common.hpp"
+#include "andromeda/Debug.hpp"
+
+namespace Andromeda {
+namespace Backend {
+
+/**
+ * A backend-wide model of download performance, shared by all files
+ * Each download is split into its latency (time to the first byte) and its transfer time, which are
+ * tracked as exponentially weighted moving averages of the round-trip time and the throughput.
+ * Newly opened files use this to choose their first read-ahead size rather than starting from a
+ * single page, then refine it with their own measurements (see Filedata::BandwidthMeasure)
+ * THREAD SAFE (INTERNAL LOCKS)
+ */
+class BandwidthEstimator
+{
+public:
+
+    using Duration = std::chrono::steady_clock::duration;
+
+    /** The weight of each new sample in the moving averages */
+    static constexpr double EWMA_WEIGHT { 0.25 };
+    /** The minimum download size used for throughput, smaller ones are dominated by latency */
+    static constexpr size_t MIN_SAMPLE_BYTES { 65536 }; // 64K
+
+    BandwidthEstimator();
+
+    virtual ~BandwidthEstimator() = default;
+    DELETE_COPY(BandwidthEstimator)
+    DELETE_MOVE(BandwidthEstimator)
+
+    /**
+     * Adds the measurement of a single completed download
+     * @param bytes the number of bytes downloaded
+     * @param firstByte the time until the first byte arrived
+     * @param total the total time of the download
+     */
+    void AddSample(size_t bytes, const Duration& firstByte, const Duration& total);
+
+    /** Returns the estimated throughput of a single download in bytes/sec (0 if unknown) */
+    [[nodiscard]] double GetThroughput() const;
+
+    /** Returns the estimated round-trip time (0 if unknown) */
+    [[nodiscard]] Duration GetRTT() const;
+
+    /** 
+     * Returns the number of bytes a single download is estimated to get within the 
+     * given time target, after its round-trip time (0 if unknown)
+     */
+    [[nodiscard]] size_t GetTargetBytes(const std::chrono::milliseconds& timeTarget) const;
+
+private:
+
+    using UniqueLock = std::unique_lock<std::mutex>;
+
+    /** The throughput average in bytes/sec, 0 if no samples */
+    double mThroughput { 0 };
+    /** The round-trip time average in seconds, negative if no samples */
+    double mRTT { -1 };
+
+    /** Mutex that protects the averages */
+    mutable std::mutex mMutex;
+
+    mutable Debug mDebug;
+};
+
+} // namespace Backend
+} // namespace Andromeda
+
+#endif // LIBA2_BANDWIDTHESTIMATOR_H_
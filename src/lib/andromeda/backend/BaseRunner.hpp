@@ -2,6 +2,7 @@
 #define LIBA2_BASERUNNER_H_
 
 #include <atomic>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
@@ -50,6 +51,9 @@ public:
     /** Returns whether retry is enabled or disabled */
     [[nodiscard]] inline bool GetCanRetry() const { return mCanRetry.load(); }
 
+    /** Returns the number of responses indicating the server is overloaded (see RunnerPool) */
+    [[nodiscard]] inline uint64_t GetOverloads() const { return mOverloads.load(); }
+
     /**
      * Runs an API call and returns the result
      * @param input input params struct
@@ -93,10 +97,16 @@ public:
 
     /** Returns true if the backend requires sessions */
     [[nodiscard]] virtual bool RequiresSession() const = 0;
+
+protected:
+
+    /** Records a response indicating the server is overloaded */
+    inline void AddOverload() { ++mOverloads; }
     
 private:
 
     std::atomic<bool> mCanRetry { false };
+    std::atomic<uint64_t> mOverloads { 0 };
 };
 
 } // namespace Backend
@@ -0,0 +1,71 @@
+
+#include <algorithm>
+
+#include "ConcurrencyLimit.hpp"
+
+namespace Andromeda {
+namespace Backend {
+
+/*****************************************************/
+ConcurrencyLimit::ConcurrencyLimit(const size_t minLimit, const size_t maxLimit) :
+    mMinLimit(std::max(static_cast<size_t>(1), minLimit)),
+    mMaxLimit(std::max(mMinLimit, maxLimit)),
+    mLimit(mMinLimit),
+    mDebug(__func__,this)
+{
+    MDBG_INFO("(minLimit:" << mMinLimit << " maxLimit:" << mMaxLimit << ")");
+}
+
+/*****************************************************/
+void ConcurrencyLimit::Decrease(const size_t newLimit, const Clock::time_point& now)
+{
+    if (mLastDecrease && now - *mLastDecrease < DECREASE_COOLDOWN) return;
+
+    mLimit = std::max(mMinLimit, newLimit);
+    mLastDecrease = now;
+    mSuccesses = 0; mWaited = false;
+
+    MDBG_INFO("() limit:" << mLimit);
+}
+
+/*****************************************************/
+void ConcurrencyLimit::AddResult(const bool overloaded, const std::optional<Clock::duration>& latency, const Clock::time_point& now)
+{
+    if (mMinLimit == mMaxLimit) return; // fixed
+
+    if (overloaded)
+    {
+        MDBG_INFO("... server overloaded");
+        Decrease(mLimit/2, now); return;
+    }
+
+    if (latency)
+    {
+        const double sample { std::chrono::duration<double>(*latency).count() };
+        if (mLatency < 0) { mLatency = sample; mBaseline = sample; }
+        else
+        {
+            mLatency += EWMA_WEIGHT*(sample-mLatency);
+            mBaseline = (sample < mBaseline) ? sample : (mBaseline + (sample-mBaseline)/BASELINE_DRIFT);
+        }
+
+        if (mLatency > mBaseline*LATENCY_FACTOR)
+        {
+            MDBG_INFO("... latency:" << mLatency << " baseline:" << mBaseline);
+            Decrease(mLimit-1, now); return;
+        }
+    }
+
+    if (++mSuccesses >= mLimit) // a full round
+    {
+        if (mWaited && mLimit < mMaxLimit)
+        {
+            ++mLimit;
+            MDBG_INFO("() limit:" << mLimit);
+        }
+        mSuccesses = 0; mWaited = false;
+    }
+}
+
+} // namespace Backend
+} // namespace Andromeda
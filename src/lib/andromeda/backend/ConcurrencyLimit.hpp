@@ -0,0 +1,91 @@
+#ifndef LIBA2_CONCURRENCYLIMIT_H_
+#define LIBA2_CONCURRENCYLIMIT_H_
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+
+#include "andromeda/common.hpp"
+#include "andromeda/Debug.hpp"
+
+namespace Andromeda {
+namespace Backend {
+
+/**
+ * Chooses how many backend requests to run concurrently, between a min and max (AIMD)
+ * The limit is increased by one after a full round (limit#) of successful requests if
+ * any request had to wait for a runner in that round. It is halved when the server says it
+ * is overloaded (HTTP 429/503), and decreased by one when the latency of small requests rises
+ * well above its baseline. Decreases are rate limited so concurrent failures count once.
+ * NOT THREAD SAFE (protect externally)
+ */
+class ConcurrencyLimit
+{
+public:
+
+    using Clock = std::chrono::steady_clock;
+
+    /** The minimum time between decreases of the limit */
+    static constexpr std::chrono::seconds DECREASE_COOLDOWN { 1 };
+    /** Latency above this multiple of the baseline is considered server congestion */
+    static constexpr double LATENCY_FACTOR { 4.0 };
+    /** The weight of each new sample in the latency moving average */
+    static constexpr double EWMA_WEIGHT { 0.25 };
+    /** The baseline moves up by 1/this of the difference per sample, so it can follow a slower network */
+    static constexpr double BASELINE_DRIFT { 256.0 };
+
+    /** 
+     * @param minLimit the minimum (and initial) limit, never zero
+     * @param maxLimit the maximum limit (the same as minLimit for a fixed limit)
+     */
+    ConcurrencyLimit(size_t minLimit, size_t maxLimit);
+
+    virtual ~ConcurrencyLimit() = default;
+    DELETE_COPY(ConcurrencyLimit)
+    DELETE_MOVE(ConcurrencyLimit)
+
+    /** Returns the current limit */
+    [[nodiscard]] size_t GetLimit() const { return mLimit; }
+
+    /** Records that a request had to wait because the limit was reached */
+    void AddWait() { mWaited = true; }
+
+    /**
+     * Records a finished request
+     * @param overloaded true if the server indicated it was overloaded
+     * @param latency the time taken, only for small requests where it is not dominated by transfer
+     * @param now the current time
+     */
+    void AddResult(bool overloaded, const std::optional<Clock::duration>& latency, const Clock::time_point& now);
+
+private:
+
+    /** Sets the limit to the given lower value (not below min) unless within the cooldown */
+    void Decrease(size_t newLimit, const Clock::time_point& now);
+
+    /** The minimum limit */
+    const size_t mMinLimit;
+    /** The maximum limit */
+    const size_t mMaxLimit;
+    /** The current limit */
+    size_t mLimit;
+
+    /** The number of successful requests since the last adjustment */
+    size_t mSuccesses { 0 };
+    /** True if a request waited since the last adjustment */
+    bool mWaited { false };
+    /** The time of the last decrease if any */
+    std::optional<Clock::time_point> mLastDecrease;
+
+    /** The latency moving average in seconds, negative if no samples */
+    double mLatency { -1 };
+    /** The baseline (uncongested) latency in seconds, negative if no samples */
+    double mBaseline { -1 };
+
+    mutable Debug mDebug;
+};
+
+} // namespace Backend
+} // namespace Andromeda
+
+#endif // LIBA2_CONCURRENCYLIMIT_H_
@@ -133,7 +133,7 @@ void HTTPRunner::AddFileParams(const RunnerInput_FilesIn& input, httplib::Multip
 }
 
 // We RETRY if either httplib gives no response (can't connect, etc.) or if we
-// get a response but it's a HTTP 503.  Other responses (404 etc.) don't get retried.
+// get a response but it's a HTTP 429/503.  Other responses (404 etc.) don't get retried.
 
 /*****************************************************/
 void HTTPRunner::DoRequestsSelf(const std::function<httplib::Result()>& getResult, HandleResponseData& respData)
@@ -221,7 +221,10 @@ std::string HTTPRunner::HandleResponse(const httplib::Response& response, bool&
 {
     MDBG_INFO("() HTTP:" << response.status);
 
-    const bool wantRetry { response.status == 500 || response.status == 503 }; // TODO remove me (don't retry on 500)
+    const bool overloaded { response.status == 429 || response.status == 503 };
+    if (overloaded) AddOverload(); // RunnerPool backs off
+
+    const bool wantRetry { response.status == 500 || overloaded }; // TODO remove me (don't retry on 500)
     respData.doRetry = (respData.canRetry && wantRetry);
     if (respData.doRetry) return ""; // early return
 
@@ -247,6 +250,7 @@ std::string HTTPRunner::HandleResponse(const httplib::Response& response, bool&
         case 403: throw EndpointException("403 Access Denied");
         case 404: throw EndpointException("404 Not Found");
         case 413: throw InputSizeException(); // can be handled
+        case 429: throw EndpointException("429 Too Many Requests");
         case 500: throw EndpointException("500 Server Error");
         case 503: throw EndpointException("503 Server Overloaded");
         default:  throw EndpointException(response.status);
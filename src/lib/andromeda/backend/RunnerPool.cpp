@@ -1,18 +1,38 @@
 
+#include <algorithm>
+
 #include "BaseRunner.hpp"
 #include "RunnerPool.hpp"
 #include "andromeda/ConfigOptions.hpp"
+#include "andromeda/StringUtil.hpp"
 
 namespace Andromeda {
 namespace Backend {
 
+thread_local std::optional<RunnerPool::Priority> RunnerPool::sThreadPriority;
+
+/*****************************************************/
+RunnerPool::PriorityScope::PriorityScope(const Priority priority) :
+    mPrevious(sThreadPriority)
+{
+    sThreadPriority = priority;
+}
+
+/*****************************************************/
+RunnerPool::PriorityScope::~PriorityScope()
+{
+    sThreadPriority = mPrevious;
+}
+
 /*****************************************************/
 RunnerPool::RunnerPool(BaseRunner& runner, const ConfigOptions& options) :
+    mReserveFirst(options.reserveRunner && options.runnerPoolSize > 1),
+    mLimit(options.runnerPoolMin ? std::min(options.runnerPoolMin, options.runnerPoolSize) : options.runnerPoolSize, options.runnerPoolSize),
     mRunnerPool(options.runnerPoolSize, nullptr),
     mRunnerLocks(options.runnerPoolSize),
     mDebug(__func__,this)
 {
-    MDBG_INFO("(poolSize:" << mRunnerPool.size() << ")");
+    MDBG_INFO("(poolSize:" << mRunnerPool.size() << " reserveFirst:" << BOOLSTR(mReserveFirst) << ")");
     mRunnerPool[0] = &runner; // first is never null
 }
 
@@ -20,52 +40,150 @@ RunnerPool::RunnerPool(BaseRunner& runner, const ConfigOptions& options) :
 const BaseRunner& RunnerPool::GetFirst() const { return *mRunnerPool[0]; }
 
 /*****************************************************/
-RunnerPool::LockedRunner RunnerPool::GetRunner()
+bool RunnerPool::isHigherWaiting(const Priority priority, const UniqueLock& llock) const
 {
-    UniqueLock llock(mMutex);
-    MDBG_INFO("()");
+    for (size_t prio { 0 }; prio < static_cast<size_t>(priority); ++prio)
+        if (mWaiting[prio]) return true;
+    return false;
+}
 
-    size_t idx { 0 }; while (true)
+/*****************************************************/
+size_t RunnerPool::WaitRunner(const Priority prio, UniqueLock& llock, UniqueLock& rlock)
+{
+    size_t& waiting { mWaiting[static_cast<size_t>(prio)] };
+    const bool background { prio >= Priority::READAHEAD };
+
+    bool isWaiting { false }; while (true)
     {
-        UniqueLock rlock(mRunnerLocks[idx], std::try_to_lock);
-        if (!rlock) // not locked
-        {
-            if (idx+1 == mRunnerPool.size()) // all busy, wait
-            {
-                MDBG_INFO("... waiting!");
-                idx = 0; // start over
-                mCV.wait(llock); 
-            }
-            else ++idx; // try next
-        }
-        else // have lock
+        // background work can't take the reserved runner, so foreground never waits behind it
+        const size_t limit { mLimit.GetLimit() };
+        const size_t firstIdx { (mReserveFirst && background && limit > 1) ? 1U : 0U };
+        // running streams count against the limit for background work, but never use it all up
+        const size_t lastIdx { background ? std::max(firstIdx+1, limit-std::min(limit,mStreams)) : limit };
+
+        // don't jump ahead of a higher priority waiter that was woken up for the free runner
+        for (size_t idx { firstIdx }; idx < lastIdx && !isHigherWaiting(prio, llock); ++idx)
         {
-            if (!mRunnerPool[idx]) // not initialized
-            {
-                MDBG_INFO("... new runner:" << idx);
-                mRunnersOwned.emplace_back(GetFirst().Clone());
-                mRunnerPool[idx] = mRunnersOwned.back().get();
-            }
-
-            MDBG_INFO("... return runner:" << idx);
-            return LockedRunner(*this, *mRunnerPool[idx], std::move(rlock));
+            rlock = UniqueLock(mRunnerLocks[idx], std::try_to_lock);
+            if (!rlock) continue; // busy, try next
+
+            if (isWaiting) --waiting;
+            return idx;
         }
+
+        MDBG_INFO("... waiting!");
+        if (!isWaiting) { ++waiting; isWaiting = true; mLimit.AddWait(); }
+        mCV.wait(llock);
     }
 }
 
 /*****************************************************/
-void RunnerPool::SignalWaiters()
+RunnerPool::LockedRunner RunnerPool::GetRunner(const Priority priority)
 {
-    const UniqueLock llock(mMutex);
+    const Priority prio { sThreadPriority.value_or(priority) };
+
+    UniqueLock llock(mMutex);
+    MDBG_INFO("(priority:" << static_cast<int>(prio) << ")");
+
+    UniqueLock rlock; const size_t idx { WaitRunner(prio, llock, rlock) };
+    if (!mRunnerPool[idx]) // not initialized
+    {
+        MDBG_INFO("... new runner:" << idx);
+        mRunnersOwned.emplace_back(GetFirst().Clone());
+        mRunnerPool[idx] = mRunnersOwned.back().get();
+    }
+
+    MDBG_INFO("... return runner:" << idx);
+    return LockedRunner(*this, idx, prio, std::move(rlock));
+}
+
+/*****************************************************/
+RunnerPool::StreamRunner RunnerPool::GetStreamRunner()
+{
+    UniqueLock llock(mMutex);
     MDBG_INFO("()");
-    mCV.notify_one();
+
+    // start when a WRITEBACK request could, but don't hold the pooled runner
+    { UniqueLock rlock; WaitRunner(Priority::WRITEBACK, llock, rlock); }
+
+    ++mStreams;
+    MDBG_INFO("... return stream runner, streams:" << mStreams);
+    return StreamRunner(*this, GetFirst().Clone());
+}
+
+/*****************************************************/
+void RunnerPool::ReleaseRunner(const size_t index, const Priority priority, const bool overloaded, const Clock::duration& time)
+{
+    const UniqueLock llock(mMutex);
+    MDBG_INFO("(index:" << index << " overloaded:" << BOOLSTR(overloaded) << ")");
+
+    // only metadata requests are small enough for their time to reflect the server's latency
+    std::optional<Clock::duration> latency;
+    if (priority == Priority::INTERACTIVE) latency = time;
+
+    mLimit.AddResult(overloaded, latency, Clock::now());
+    FreeRunners(llock);
+
+    // wake all so the highest priority waiter can take the runner
+    mCV.notify_all();
 }
 
+/*****************************************************/
+void RunnerPool::ReleaseStream(const bool overloaded)
+{
+    const UniqueLock llock(mMutex);
+    MDBG_INFO("(overloaded:" << BOOLSTR(overloaded) << ")");
+
+    --mStreams;
+    mLimit.AddResult(overloaded, std::nullopt, Clock::now());
+    FreeRunners(llock);
+
+    mCV.notify_all();
+}
+
+/*****************************************************/
+void RunnerPool::FreeRunners(const UniqueLock& llock)
+{
+    for (size_t idx { mLimit.GetLimit() }; idx < mRunnerPool.size(); ++idx)
+    {
+        BaseRunner* const runner { mRunnerPool[idx] };
+        if (runner == nullptr) continue;
+
+        const UniqueLock rlock(mRunnerLocks[idx], std::try_to_lock);
+        if (!rlock) continue; // in use, freed when released
+
+        MDBG_INFO("... free runner:" << idx);
+        mRunnerPool[idx] = nullptr;
+        mRunnersOwned.remove_if([&](const std::unique_ptr<BaseRunner>& owned){ return owned.get() == runner; });
+    }
+}
+
+/*****************************************************/
+RunnerPool::LockedRunner::LockedRunner(RunnerPool& pool, const size_t index, const Priority priority, UniqueLock&& lock) :
+    mPool(pool), mRunner(*pool.mRunnerPool[index]), mLock(std::move(lock)),
+    mIndex(index), mPriority(priority), 
+    mOverloads(mRunner.GetOverloads()), 
+    mStartTime(Clock::now()) { }
+
 /*****************************************************/
 RunnerPool::LockedRunner::~LockedRunner()
 {
+    const bool overloaded { mRunner.GetOverloads() != mOverloads };
+    const Clock::duration time { Clock::now() - mStartTime };
+
     mLock.unlock(); // BEFORE signal!
-    mPool.SignalWaiters();
+    mPool.ReleaseRunner(mIndex, mPriority, overloaded, time);
+}
+
+/*****************************************************/
+RunnerPool::StreamRunner::StreamRunner(RunnerPool& pool, std::unique_ptr<BaseRunner> runner) :
+    mPool(pool), mRunner(std::move(runner)),
+    mOverloads(mRunner->GetOverloads()) { }
+
+/*****************************************************/
+RunnerPool::StreamRunner::~StreamRunner()
+{
+    mPool.ReleaseStream(mRunner->GetOverloads() != mOverloads);
 }
 
 } // namespace Backend
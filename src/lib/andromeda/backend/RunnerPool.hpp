@@ -1,12 +1,17 @@
 #ifndef LIBA2_RUNNERPOOL_H_
 #define LIBA2_RUNNERPOOL_H_
 
+#include <array>
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <list>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <vector>
 
+#include "ConcurrencyLimit.hpp"
 #include "andromeda/common.hpp"
 #include "andromeda/Debug.hpp"
 
@@ -18,6 +23,10 @@ class BaseRunner;
 
 /** 
  * Manages a pool of concurrent backend runners 
+ * Threads waiting for a runner are served by priority class, and the first
+ * runner can be reserved so that background work never occupies the whole pool
+ * If a minimum pool size is set, the number of runners in use adapts between the min and max
+ * based on waiting and server feedback (see ConcurrencyLimit), idle extra runners are freed
  * THREAD SAFE (INTERNAL LOCKS)
  */
 class RunnerPool
@@ -25,15 +34,42 @@ class RunnerPool
 public:
 
     using UniqueLock = std::unique_lock<std::mutex>;
+    using Clock = std::chrono::steady_clock;
+
+    /** Request priority classes, highest priority first */
+    enum class Priority : uint8_t
+    {
+        /** metadata requests a user is waiting on */ INTERACTIVE,
+        /** file data a user is waiting on */         FOREGROUND,
+        /** speculative background reads */           READAHEAD,
+        /** background flushing of dirty data */      WRITEBACK,
+        /** the number of priority classes */         NUM_PRIORITIES
+    };
+
+    /** 
+     * Sets the priority of all GetRunner() calls on this thread while in scope,
+     * overriding the caller's default (used by background threads and tasks)
+     */
+    class PriorityScope
+    {
+    public:
+        explicit PriorityScope(Priority priority);
+        ~PriorityScope();
+        DELETE_COPY(PriorityScope)
+        DELETE_MOVE(PriorityScope)
+    private:
+        /** The thread's priority before this scope, to restore */
+        const std::optional<Priority> mPrevious;
+    };
 
     /** Scoped wrapper for accessing a runner under a lock */
     class LockedRunner
     {
     public:
-        explicit LockedRunner(RunnerPool& pool, BaseRunner& runner, UniqueLock&& lock) : 
-            mPool(pool), mRunner(runner), mLock(std::move(lock)) { }
+        /** @param index the index of the runner in the pool (must be initialized) */
+        LockedRunner(RunnerPool& pool, size_t index, Priority priority, UniqueLock&& lock);
 
-        ~LockedRunner();
+        ~LockedRunner(); // reports the result to the pool
         DELETE_COPY(LockedRunner)
         DELETE_MOVE(LockedRunner)
 
@@ -43,11 +79,42 @@ public:
         RunnerPool& mPool;
         BaseRunner& mRunner;
         UniqueLock mLock;
+        /** The index of the runner in the pool */
+        const size_t mIndex;
+        /** The priority class of the request */
+        const Priority mPriority;
+        /** The runner's overload count when acquired */
+        const uint64_t mOverloads;
+        /** The time the runner was acquired */
+        const Clock::time_point mStartTime;
+    };
+
+    /** 
+     * Scoped runner for a long-running stream, e.g. an upload fed as a file is written
+     * The runner is cloned rather than taken from the pool since the stream may be waiting
+     * on other requests for its data, but it counts against the limit for background requests
+     */
+    class StreamRunner
+    {
+    public:
+        StreamRunner(RunnerPool& pool, std::unique_ptr<BaseRunner> runner);
+
+        ~StreamRunner(); // reports the result to the pool
+        DELETE_COPY(StreamRunner)
+        DELETE_MOVE(StreamRunner)
+
+        BaseRunner& operator*() { return *mRunner; }
+        BaseRunner* operator->() { return mRunner.get(); }
+    private:
+        RunnerPool& mPool;
+        const std::unique_ptr<BaseRunner> mRunner;
+        /** The runner's overload count when created */
+        const uint64_t mOverloads;
     };
 
     /** 
      * Initialize the pool from a single runner that will be cloned as necessary
-     * @param options ConfigOptions containing the max pool size
+     * @param options ConfigOptions containing the min/max pool size and runner reservation
      */
     explicit RunnerPool(BaseRunner& runner, const Andromeda::ConfigOptions& options);
 
@@ -55,16 +122,62 @@ public:
     DELETE_COPY(RunnerPool)
     DELETE_MOVE(RunnerPool)
 
-    /** Returns a reference to a runner and accompanying lock */
-    LockedRunner GetRunner();
+    /** 
+     * Returns a reference to a runner and accompanying lock, waiting if none are available
+     * @param priority the request's priority class, unless a PriorityScope is set on this thread
+     */
+    LockedRunner GetRunner(Priority priority = Priority::FOREGROUND);
+
+    /** 
+     * Returns a new runner for a long-running stream, waiting until a WRITEBACK request could run
+     * so that streams are started behind higher priorities and within the current limit
+     */
+    StreamRunner GetStreamRunner();
 
     /** Returns a const reference to the first runner */
     [[nodiscard]] const BaseRunner& GetFirst() const;
 
 private:
 
-    /** Signal waiting threads */
-    void SignalWaiters();
+    /** 
+     * Feeds the result of a request to the limit and signals waiting threads
+     * @param index the index of the runner that was used
+     * @param priority the priority class of the request
+     * @param overloaded true if the server responded that it is overloaded
+     * @param time the time the runner was held
+     */
+    void ReleaseRunner(size_t index, Priority priority, bool overloaded, const Clock::duration& time);
+
+    /** 
+     * Waits until a runner is available for the given priority
+     * @param rlock set to the runner's lock, which is held
+     * @return the index of the runner in the pool
+     */
+    size_t WaitRunner(Priority prio, UniqueLock& llock, UniqueLock& rlock);
+
+    /** 
+     * Feeds the result of a stream to the limit and signals waiting threads
+     * @param overloaded true if the server responded that it is overloaded
+     */
+    void ReleaseStream(bool overloaded);
+
+    /** Destroys idle cloned runners beyond the current limit */
+    void FreeRunners(const UniqueLock& llock);
+
+    /** Returns true if any threads with a priority higher than the given are waiting */
+    bool isHigherWaiting(Priority priority, const UniqueLock& llock) const;
+
+    /** The priority set by the current thread's PriorityScope, if any */
+    static thread_local std::optional<Priority> sThreadPriority;
+
+    /** True if the first runner may not be used for background priorities */
+    const bool mReserveFirst;
+    /** The number of threads waiting for a runner, by priority */
+    std::array<size_t, static_cast<size_t>(Priority::NUM_PRIORITIES)> mWaiting {};
+    /** The number of running StreamRunners */
+    size_t mStreams { 0 };
+    /** The number of runners that may be used at once (protected by mMutex) */
+    ConcurrencyLimit mLimit;
 
     /** Array of possibly-null pointers to runners to use */
     std::vector<BaseRunner*> mRunnerPool;
@@ -0,0 +1,193 @@
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+#include "WorkerPool.hpp"
+
+namespace Andromeda {
+namespace Backend {
+
+/*****************************************************/
+WorkerPool::WorkerPool(const size_t maxWorkers, const size_t maxQueue) :
+    mMaxWorkers(std::max(static_cast<size_t>(1), maxWorkers)),
+    mMaxQueue(maxQueue),
+    mDebug(__func__,this)
+{
+    MDBG_INFO("(maxWorkers:" << mMaxWorkers << " maxQueue:" << mMaxQueue << ")");
+}
+
+/*****************************************************/
+WorkerPool::~WorkerPool()
+{
+    MDBG_INFO("() waiting for workers");
+
+    { const UniqueLock lock(mMutex);
+        if (!mQueue.empty()) { MDBG_ERROR("... " << mQueue.size() << " tasks still queued!"); }
+        mRunning = false;
+        mQueueCV.notify_all(); }
+
+    for (std::thread& worker : mWorkers)
+        worker.join();
+
+    MDBG_INFO("... returning!");
+}
+
+/*****************************************************/
+WorkerPool::Stats& WorkerPool::GetStats(const TaskType type, const UniqueLock& lock)
+{
+    return mStats[static_cast<size_t>(type)];
+}
+
+/*****************************************************/
+WorkerPool::Stats WorkerPool::GetStats(const TaskType type) const
+{
+    const UniqueLock lock(mMutex);
+    return mStats[static_cast<size_t>(type)];
+}
+
+/*****************************************************/
+size_t WorkerPool::GetWorkerCount() const
+{
+    const UniqueLock lock(mMutex);
+    return mWorkers.size();
+}
+
+namespace { // anonymous
+
+/** Prints the given task type's metrics */
+void PrintTypeStats(std::ostream& out, const WorkerPool::Stats& stats)
+{
+    out << "(queued:" << stats.queued << " running:" << stats.running
+        << " submitted:" << stats.submitted << " rejected:" << stats.rejected
+        << " cancelled:" << stats.cancelled << " completed:" << stats.completed;
+
+    if (stats.completed)
+    {
+        out << " avgWait:" << static_cast<uint64_t>(stats.waitTime.count())/stats.completed << "us"
+            << " avgRun:" << static_cast<uint64_t>(stats.runTime.count())/stats.completed << "us";
+    }
+    out << " maxWait:" << stats.maxWaitTime.count() << "us)";
+}
+
+} // namespace
+
+/*****************************************************/
+void WorkerPool::PrintStats(std::ostream& out) const
+{
+    const UniqueLock lock(mMutex);
+    out << "workers: " << mWorkers.size();
+    out << ", fetch: "; PrintTypeStats(out, mStats[static_cast<size_t>(TaskType::FETCH)]);
+    out << ", flush: "; PrintTypeStats(out, mStats[static_cast<size_t>(TaskType::FLUSH)]);
+}
+
+/*****************************************************/
+bool WorkerPool::TrySubmit(const TaskType type, const void* owner, Task&& task)
+{
+    const UniqueLock lock(mMutex);
+    Stats& stats { GetStats(type, lock) };
+
+    if (mQueue.size() >= mMaxQueue)
+    {
+        MDBG_INFO("(owner:" << owner << ") queue full!");
+        ++stats.rejected; return false;
+    }
+
+    mQueue.push_back({ type, owner, std::move(task), Clock::now() });
+    ++stats.queued; ++stats.submitted;
+
+    // start a new worker only if the existing ones are all busy
+    if (mIdleWorkers < mQueue.size() && mWorkers.size() < mMaxWorkers)
+    {
+        MDBG_INFO("... starting worker " << mWorkers.size());
+        mWorkers.emplace_back(&WorkerPool::WorkerMain, this);
+    }
+    else mQueueCV.notify_one();
+
+    return true;
+}
+
+/*****************************************************/
+bool WorkerPool::RunQueued(const void* owner)
+{
+    UniqueLock lock(mMutex);
+
+    const TaskQueue::iterator it { std::find_if(mQueue.begin(), mQueue.end(),
+        [&](const QueuedTask& qtask){ return qtask.owner == owner; }) };
+    if (it == mQueue.end()) return false;
+
+    MDBG_INFO("(owner:" << owner << ") running inline");
+    RunTask(it, lock); return true;
+}
+
+/*****************************************************/
+size_t WorkerPool::CancelQueued(const void* owner)
+{
+    const UniqueLock lock(mMutex);
+
+    size_t count { 0 };
+    for (TaskQueue::iterator it { mQueue.begin() }; it != mQueue.end(); )
+    {
+        if (it->owner == owner)
+        {
+            Stats& stats { GetStats(it->type, lock) };
+            --stats.queued; ++stats.cancelled;
+            it = mQueue.erase(it); ++count;
+        }
+        else ++it;
+    }
+
+    MDBG_INFO("(owner:" << owner << ") cancelled:" << count);
+    return count;
+}
+
+/*****************************************************/
+void WorkerPool::RunTask(const TaskQueue::iterator it, UniqueLock& lock)
+{
+    const TaskType type { it->type };
+    const Task task { std::move(it->task) };
+    const Clock::time_point startTime { Clock::now() };
+
+    { Stats& stats { GetStats(type, lock) };
+        const std::chrono::microseconds waitTime { std::chrono::duration_cast
+            <std::chrono::microseconds>(startTime - it->queueTime) };
+        stats.waitTime += waitTime;
+        stats.maxWaitTime = std::max(stats.maxWaitTime, waitTime);
+        --stats.queued; ++stats.running; }
+    mQueue.erase(it);
+
+    lock.unlock();
+    try { task(); }
+    catch (const std::exception& ex)
+    {
+        MDBG_ERROR("... task threw: " << ex.what());
+    }
+    lock.lock();
+
+    Stats& stats { GetStats(type, lock) };
+    stats.runTime += std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - startTime);
+    --stats.running; ++stats.completed;
+}
+
+/*****************************************************/
+void WorkerPool::WorkerMain()
+{
+    UniqueLock lock(mMutex);
+    MDBG_INFO("()");
+
+    while (mRunning)
+    {
+        if (mQueue.empty())
+        {
+            ++mIdleWorkers;
+            mQueueCV.wait(lock);
+            --mIdleWorkers;
+        }
+        else RunTask(mQueue.begin(), lock);
+    }
+
+    MDBG_INFO("... returning!");
+}
+
+} // namespace Backend
+} // namespace Andromeda
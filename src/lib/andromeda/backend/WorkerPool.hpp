@@ -0,0 +1,161 @@
+#ifndef LIBA2_WORKERPOOL_H_
+#define LIBA2_WORKERPOOL_H_
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <ostream>
+#include <thread>
+
+#include "andromeda/common.hpp"
+#include "andromeda/Debug.hpp"
+
+namespace Andromeda {
+namespace Backend {
+
+/**
+ * A bounded pool of worker threads that run background backend I/O tasks
+ * Workers are started on demand up to the maximum and then kept for re-use,
+ * and the number of queued (not yet running) tasks is limited
+ * THREAD SAFE (INTERNAL LOCKS)
+ */
+class WorkerPool
+{
+public:
+
+    /** A task to run - must not throw */
+    using Task = std::function<void()>;
+
+    /** The category of a task (for metrics) */
+    enum class TaskType : uint8_t
+    {
+        /** reading pages from the backend */ FETCH,
+        /** writing pages to the backend */   FLUSH,
+        /** the number of task types */       NUM_TYPES
+    };
+
+    /**
+     * @param maxWorkers the maximum number of worker threads, never zero!
+     * @param maxQueue the maximum number of tasks waiting for a worker
+     */
+    WorkerPool(size_t maxWorkers, size_t maxQueue);
+
+    /** Stops and joins all workers - all queued tasks must be already cancelled */
+    ~WorkerPool();
+    DELETE_COPY(WorkerPool)
+    DELETE_MOVE(WorkerPool)
+
+    /**
+     * Queues a task to be run on a worker thread
+     * @param type the category of the task for metrics
+     * @param owner opaque pointer identifying the task owner (see RunQueued/CancelQueued)
+     * @param task the function to run
+     * @return false if the task was not queued because the queue is full
+     */
+    bool TrySubmit(TaskType type, const void* owner, Task&& task);
+
+    /**
+     * Runs the oldest queued task with the given owner in the calling thread (if any)
+     * Useful to avoid waiting on a task that does not have a worker yet
+     * @return true if a task was run
+     */
+    bool RunQueued(const void* owner);
+
+    /**
+     * Removes all queued (not yet running) tasks with the given owner
+     * @return the number of tasks that were removed
+     */
+    size_t CancelQueued(const void* owner);
+
+    /** Metrics for a single task type */
+    struct Stats
+    {
+        /** The number of tasks currently queued */
+        size_t queued { 0 };
+        /** The number of tasks currently running */
+        size_t running { 0 };
+        /** The total number of tasks accepted */
+        uint64_t submitted { 0 };
+        /** The total number of tasks rejected due to the queue limit */
+        uint64_t rejected { 0 };
+        /** The total number of tasks removed by CancelQueued */
+        uint64_t cancelled { 0 };
+        /** The total number of tasks that finished running */
+        uint64_t completed { 0 };
+        /** The total time that tasks spent waiting in the queue */
+        std::chrono::microseconds waitTime { 0 };
+        /** The longest time a task spent waiting in the queue */
+        std::chrono::microseconds maxWaitTime { 0 };
+        /** The total time that tasks spent running */
+        std::chrono::microseconds runTime { 0 };
+    };
+
+    /** Returns a copy of the metrics for the given task type */
+    Stats GetStats(TaskType type) const;
+
+    /** Returns the current number of worker threads */
+    size_t GetWorkerCount() const;
+
+    /** Prints the worker count and the metrics for each task type to the given stream */
+    void PrintStats(std::ostream& out) const;
+
+private:
+
+    using UniqueLock = std::unique_lock<std::mutex>;
+    using Clock = std::chrono::steady_clock;
+
+    /** A task waiting to be run */
+    struct QueuedTask
+    {
+        TaskType type;
+        const void* owner;
+        Task task;
+        Clock::time_point queueTime;
+    };
+    using TaskQueue = std::list<QueuedTask>;
+
+    /** Returns the stats for the given task type (already have the lock) */
+    Stats& GetStats(TaskType type, const UniqueLock& lock);
+
+    /**
+     * Removes the given task from the queue and runs it with the lock unlocked
+     * @param lock the mMutex lock, will be re-locked when returning
+     */
+    void RunTask(TaskQueue::iterator it, UniqueLock& lock);
+
+    /** The main loop for a worker thread */
+    void WorkerMain();
+
+    /** The maximum number of worker threads */
+    const size_t mMaxWorkers;
+    /** The maximum number of queued tasks */
+    const size_t mMaxQueue;
+
+    /** Queue of tasks waiting to run (oldest first) */
+    TaskQueue mQueue;
+    /** List of started worker threads */
+    std::list<std::thread> mWorkers;
+    /** The number of workers waiting for a task */
+    size_t mIdleWorkers { 0 };
+    /** Set to false to stop the workers */
+    bool mRunning { true };
+
+    /** Metrics for each task type */
+    std::array<Stats, static_cast<size_t>(TaskType::NUM_TYPES)> mStats;
+
+    /** Mutex to protect the queue, workers and stats */
+    mutable std::mutex mMutex;
+    /** Condition variable for workers to wait for tasks */
+    std::condition_variable mQueueCV;
+
+    mutable Andromeda::Debug mDebug;
+};
+
+} // namespace Backend
+} // namespace Andromeda
+
+#endif // LIBA2_WORKERPOOL_H_
@@ -42,7 +42,7 @@ File::File(BackendImpl& backend, const nlohmann::json& data, Folder& parent) :
     MDBG_INFO("... ID:" << mId << " name:" << mName);
 
     const size_t pageSize { CalcPageSize() };
-    mPageBackend = std::make_unique<PageBackend>(*this, mId, fileSize, pageSize);
+    mPageBackend = std::make_unique<PageBackend>(*this, mId, fileSize, mModified, pageSize);
     mPageManager = std::make_unique<PageManager>(*this, fileSize, pageSize, *mPageBackend);
 }
 
@@ -89,6 +89,12 @@ uint64_t File::GetSize(const SharedLock& thisLock) const
     return mPageManager->GetFileSize(thisLock);
 }
 
+/*****************************************************/
+Filedata::CacheStats::Values File::GetCacheStats() const
+{
+    return mPageManager->GetCacheStats().GetValues();
+}
+
 /*****************************************************/
 size_t File::GetPageSize() const
 {
@@ -112,10 +118,8 @@ void File::Refresh(const nlohmann::json& data, const SharedLockW& thisLock)
 
         uint64_t newSize = 0;
         data.at("size").get_to(newSize);
-        // TODO use server mtime once supported here to check for changing
-        // will also need a mBackendTime in case of dirty writes
-        if (newSize != mPageBackend->GetBackendSize(thisLock))
-            mPageManager->RemoteChanged(newSize, thisLock);
+        // mModified was updated by Item::Refresh() - keeps the cache if the version is unchanged
+        mPageManager->RemoteRefreshed(newSize, mModified, thisLock);
     }
     catch (const nlohmann::json::exception& ex) {
         throw BackendImpl::JSONErrorException(ex.what()); }
@@ -139,6 +143,9 @@ void File::SubRename(const std::string& newName, const SharedLockW& thisLock, bo
 
     if (isReadOnlyFS()) throw ReadOnlyFSException();
 
+    if (mPageBackend->isStreaming(thisLock))
+        FlushCache(thisLock); // the upload was started with the old name
+
     if (ExistsOnBackend(thisLock))
         mBackend.RenameFile(GetID(), newName, overwrite);
 }
@@ -201,6 +208,10 @@ void File::ReadBytes(char* buffer, const uint64_t offset, const size_t length, c
     if (offset + length > mPageManager->GetFileSize(thisLock))
         throw ReadBoundsException();
 
+    // data already sent to a streaming upload is no longer cached
+    if (offset < mPageBackend->GetStreamedSize(thisLock))
+        throw WriteTypeException();
+
     if (mBackend.GetOptions().cacheType == ConfigOptions::CacheType::NONE)
     {
         const std::string data { mBackend.ReadFile(GetID(), offset, length) };
@@ -246,6 +257,10 @@ void File::WriteBytes(const char* buffer, uint64_t offset, size_t length, const
         return; // early return
     }
     
+    // data already sent to a streaming upload can't be changed
+    if (offset < mPageBackend->GetStreamedSize(thisLock))
+        throw WriteTypeException();
+
     if (writeMode == FSConfig::WriteMode::UPLOAD)
     {
         if (mPageBackend->ExistsOnBackend(thisLock)) 
@@ -323,13 +338,9 @@ void File::FillWriteHole(const uint64_t offset, const SharedLockW& thisLock)
     const uint64_t fileSize { mPageManager->GetFileSize(thisLock) };
     if (offset > fileSize) // need to fill in holes to guarantee sequential upload
     {
-        std::vector<char> holeBuf(GetPageSize(), 0); // chunked fill to avoid consuming too much memory
-        for (uint64_t holeOffset = fileSize; holeOffset < offset; holeOffset += holeBuf.size())
-        {
-            const size_t holeSize { Filedata::min64st(offset-holeOffset, holeBuf.size()) };
-            ITDBG_INFO("... fill write hole:" << holeSize << "@" << holeOffset);
-            WriteBytes(holeBuf.data(), holeOffset, holeSize, thisLock);
-        }
+        // sparse pages are uploaded as zeroes but don't use memory until then
+        ITDBG_INFO("... fill write hole:" << offset-fileSize << "@" << fileSize);
+        mPageManager->WriteHole(offset, thisLock);
     }
 }
 
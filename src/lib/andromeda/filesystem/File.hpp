@@ -10,6 +10,7 @@
 
 #include "Item.hpp"
 #include "FSConfig.hpp"
+#include "filedata/CacheStats.hpp"
 #include "andromeda/common.hpp"
 #include "andromeda/Debug.hpp"
 #include "andromeda/ScopeLocked.hpp"
@@ -59,6 +60,9 @@ public:
     /** Returns the file's data page size */
     virtual size_t GetPageSize() const;
 
+    /** Returns a copy of the page cache counters for this file */
+    Filedata::CacheStats::Values GetCacheStats() const;
+
     /** Checks the FS and account limits for the allowed write mode */
     FSConfig::WriteMode GetWriteMode() const;
 
@@ -73,8 +77,8 @@ public:
 
     /** Function to create the file on the backend and return its JSON */
     using CreateFunc = std::function<nlohmann::json (const std::string&)>;
-    /** Function to upload the file on the backend and return its JSON */
-    using UploadFunc = std::function<nlohmann::json (const std::string&, const Andromeda::Backend::WriteFunc&, bool)>;
+    /** Function to upload the file on the backend and return its JSON - args are (name, data, oneshot, stream) */
+    using UploadFunc = std::function<nlohmann::json (const std::string&, const Andromeda::Backend::WriteFunc&, bool, bool)>;
 
     /**
      * @brief Construct a new file in memory only to be created on the backend when flushed
@@ -161,7 +165,7 @@ private:
      */
     size_t FixPageAlignment(const char* buffer, uint64_t offset, size_t length, const SharedLockW& thisLock);
 
-    /** Calls WriteBytes() with zeroes until the file size equals offset */
+    /** Extends the file with zeroes (sparse pages) until the file size equals offset */
     void FillWriteHole(uint64_t offset, const SharedLockW& thisLock);
 
     std::unique_ptr<Filedata::PageManager> mPageManager;
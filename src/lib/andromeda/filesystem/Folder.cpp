@@ -181,14 +181,42 @@ void Folder::SyncContents(const NewItemMap& newItems, ItemLockMap& itemsLocks, c
 {
     ITDBG_INFO("()");
 
+    // map the IDs of items that are gone by name, in case they were renamed
+    std::map<std::string, std::string> goneIDs;
+    for (const ItemMap::value_type& oldIt : mItemMap)
+    {
+        if (newItems.find(oldIt.first) == newItems.end() && !oldIt.second->GetID().empty())
+            goneIDs.emplace(oldIt.second->GetID(), oldIt.first);
+    }
+
     for (const NewItemMap::value_type& newIt : newItems)
     {
         const std::string& name(newIt.first);
         const nlohmann::json& data(newIt.second.first);
         ValidateName(name, true); // throw if bad
 
-        // TODO this could go based on ID, would avoid dumping a file's cache when renamed
-        const ItemMap::const_iterator existIt(mItemMap.find(name));
+        ItemMap::iterator existIt(mItemMap.find(name));
+
+        if (existIt == mItemMap.end() && !goneIDs.empty())
+        {
+            // match a renamed item by ID so we keep it (and its cache) rather than replace it
+            const nlohmann::json::const_iterator idIt(data.find("id"));
+            const decltype(goneIDs)::iterator goneIt { (idIt != data.end() && idIt->is_string())
+                ? goneIDs.find(idIt->get<std::string>()) : goneIDs.end() };
+
+            if (goneIt != goneIDs.end())
+            {
+                const std::string& oldName { goneIt->second };
+                ITDBG_INFO("... remote renamed: " << oldName << " to " << name);
+
+                existIt = mItemMap.emplace(name, std::move(mItemMap.at(oldName))).first;
+                mItemMap.erase(oldName);
+
+                itemsLocks.emplace(name, std::move(itemsLocks.at(oldName)));
+                itemsLocks.erase(oldName);
+                goneIDs.erase(goneIt);
+            }
+        }
 
         if (existIt == mItemMap.end()) // insert new item
         {
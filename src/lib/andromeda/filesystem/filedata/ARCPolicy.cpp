@@ -0,0 +1,229 @@
+
+#include <algorithm>
+#include <vector>
+
+#include "ARCPolicy.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+
+namespace { // anonymous
+
+/** Returns the ARC target adjustment multiplier - the ratio of the other ghost list to the hit one (at least 1) */
+size_t GhostRatio(const size_t otherBytes, const size_t hitBytes)
+{
+    return (hitBytes != 0) ? std::max(static_cast<size_t>(1), otherBytes/hitBytes) : 1;
+}
+
+} // namespace
+
+/*****************************************************/
+ARCPolicy::ARCPolicy(const size_t capacity) :
+    mCapacity(capacity) { }
+
+/*****************************************************/
+void ARCPolicy::Insert(const Page* page, const PageKey& key, const size_t size, const bool lowPriority)
+{
+    const Entry entry { key, size };
+    if (lowPriority)
+    {
+        // not a real reference yet, don't check the ghosts until accessed
+        mPrefetch.enqueue_front(page, entry);
+        mPrefetchBytes += size;
+    }
+    else AddEntry(page, entry);
+}
+
+/*****************************************************/
+void ARCPolicy::AddEntry(const Page* page, const Entry& entry)
+{
+    size_t ghostSize { 0 };
+    if (mRecentGhosts.exists(entry.key))
+    {
+        // evicted from recent too soon, grow the recent target
+        const size_t delta { entry.size * GhostRatio(mFrequentGhostBytes, mRecentGhostBytes) };
+        mTarget = std::min(mCapacity, mTarget + delta);
+
+        mRecentGhosts.pop(entry.key, ghostSize);
+        mRecentGhostBytes -= ghostSize;
+        mFrequent.enqueue_front(page, entry);
+        mFrequentBytes += entry.size;
+    }
+    else if (mFrequentGhosts.exists(entry.key))
+    {
+        // evicted from frequent too soon, shrink the recent target
+        const size_t delta { entry.size * GhostRatio(mRecentGhostBytes, mFrequentGhostBytes) };
+        mTarget = (mTarget > delta) ? mTarget - delta : 0;
+
+        mFrequentGhosts.pop(entry.key, ghostSize);
+        mFrequentGhostBytes -= ghostSize;
+        mFrequent.enqueue_front(page, entry);
+        mFrequentBytes += entry.size;
+    }
+    else
+    {
+        mRecent.enqueue_front(page, entry);
+        mRecentBytes += entry.size;
+    }
+
+    TrimGhosts();
+}
+
+/*****************************************************/
+void ARCPolicy::Access(const Page* page)
+{
+    Entry entry {};
+    if (mPrefetch.pop(page, entry))
+    {
+        mPrefetchBytes -= entry.size;
+        AddEntry(page, entry); // first real reference
+    }
+    else if (mRecent.exists(page))
+    {
+        if (mRecent.front().first == page) return; // same reference continuing
+
+        mRecent.pop(page, entry);
+        mRecentBytes -= entry.size;
+        mFrequent.enqueue_front(page, entry);
+        mFrequentBytes += entry.size;
+    }
+    else if (mFrequent.pop(page, entry))
+        mFrequent.enqueue_front(page, entry);
+}
+
+/*****************************************************/
+void ARCPolicy::Resize(const Page* page, const size_t size)
+{
+    const auto resize { [&](EntryList& list, size_t& bytes)->bool
+    {
+        const EntryList::iterator it { list.find(page) };
+        if (it == list.end()) return false;
+
+        bytes += size - it->second.size;
+        it->second.size = size;
+        return true;
+    }};
+
+    if (!resize(mRecent, mRecentBytes) && !resize(mFrequent, mFrequentBytes))
+        resize(mPrefetch, mPrefetchBytes);
+}
+
+/*****************************************************/
+void ARCPolicy::Erase(const Page* page, const bool evicted)
+{
+    Entry entry {};
+    if (mPrefetch.pop(page, entry))
+    {
+        // never used, not worth remembering
+        mPrefetchBytes -= entry.size;
+    }
+    else if (mRecent.pop(page, entry))
+    {
+        mRecentBytes -= entry.size;
+        if (evicted)
+        {
+            mRecentGhosts.enqueue_front(entry.key, entry.size);
+            mRecentGhostBytes += entry.size;
+        }
+    }
+    else if (mFrequent.pop(page, entry))
+    {
+        mFrequentBytes -= entry.size;
+        if (evicted)
+        {
+            mFrequentGhosts.enqueue_front(entry.key, entry.size);
+            mFrequentGhostBytes += entry.size;
+        }
+    }
+    else return; // not found
+
+    TrimGhosts();
+}
+
+/*****************************************************/
+void ARCPolicy::Requeue(const Page* page)
+{
+    // stays in the same list, it was not used again
+    Entry entry {};
+    if (mPrefetch.pop(page, entry))
+        mPrefetch.enqueue_front(page, entry);
+    else if (mRecent.pop(page, entry))
+        mRecent.enqueue_front(page, entry);
+    else if (mFrequent.pop(page, entry))
+        mFrequent.enqueue_front(page, entry);
+}
+
+/*****************************************************/
+size_t ARCPolicy::EraseGhosts(GhostList& ghosts, const void* owner)
+{
+    std::vector<PageKey> keys;
+    for (const GhostList::value_type& ghost : ghosts)
+        if (ghost.first.owner == owner) keys.push_back(ghost.first);
+
+    size_t erased { 0 };
+    for (const PageKey& key : keys)
+    {
+        size_t size { 0 };
+        ghosts.pop(key, size);
+        erased += size;
+    }
+    return erased;
+}
+
+/*****************************************************/
+void ARCPolicy::EraseOwner(const void* owner)
+{
+    // a new owner at the same address must not hit these
+    mRecentGhostBytes -= EraseGhosts(mRecentGhosts, owner);
+    mFrequentGhostBytes -= EraseGhosts(mFrequentGhosts, owner);
+}
+
+/*****************************************************/
+void ARCPolicy::SetCapacity(const size_t capacity)
+{
+    mCapacity = capacity;
+    mTarget = std::min(mTarget, mCapacity);
+    TrimGhosts();
+}
+
+/*****************************************************/
+void ARCPolicy::TrimGhosts()
+{
+    // as in ARC, remember up to the cache size of recent pages, and twice that in total
+    while (!mRecentGhosts.empty() && mRecentBytes + mRecentGhostBytes > mCapacity)
+        mRecentGhostBytes -= mRecentGhosts.pop_back().second;
+
+    while (!mFrequentGhosts.empty() && mRecentBytes + mFrequentBytes + 
+        mRecentGhostBytes + mFrequentGhostBytes > 2*mCapacity)
+            mFrequentGhostBytes -= mFrequentGhosts.pop_back().second;
+}
+
+/*****************************************************/
+void ARCPolicy::ForEachVictim(const std::function<bool(const Page*)>& func) const
+{
+    // unused read-ahead pages go first, oldest first
+    for (EntryList::const_reverse_iterator it { mPrefetch.crbegin() }; it != mPrefetch.crend(); ++it)
+        if (!func(it->first)) return;
+
+    // then the LRU of the recent list while it is over its target, else the LRU of the frequent list
+    size_t recentBytes { mRecentBytes };
+    EntryList::const_reverse_iterator itRecent { mRecent.crbegin() };
+    EntryList::const_reverse_iterator itFrequent { mFrequent.crbegin() };
+    while (itRecent != mRecent.crend() || itFrequent != mFrequent.crend())
+    {
+        const bool fromRecent { itFrequent == mFrequent.crend() ||
+            (itRecent != mRecent.crend() && recentBytes > mTarget) };
+
+        if (fromRecent)
+        {
+            recentBytes -= itRecent->second.size;
+            if (!func((itRecent++)->first)) return;
+        }
+        else if (!func((itFrequent++)->first)) return;
+    }
+}
+
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
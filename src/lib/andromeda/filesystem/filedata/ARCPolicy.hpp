@@ -0,0 +1,95 @@
+
+#ifndef LIBA2_ARCPOLICY_H_
+#define LIBA2_ARCPOLICY_H_
+
+#include "EvictPolicy.hpp"
+#include "andromeda/OrderedMap.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+
+/** 
+ * A scan-resistant Adaptive Replacement Cache (ARC) eviction policy, tracking sizes in bytes
+ * Pages accessed once are kept in a "recent" list, pages accessed again move to a "frequent" list.
+ * Evicted (not deleted) pages are remembered in "ghost" lists - a new page that hits a ghost goes straight to
+ * the frequent list and adapts the target size of the recent list, so a large scan only replaces
+ * other recent pages rather than the whole working set.
+ * Read-ahead (low priority) pages go in a separate FIFO that is evicted first, and only enter
+ * the recent list when actually accessed. An access to the page that is already the most
+ * recent is not counted again (e.g. many small reads of the same page).
+ * NOT THREAD SAFE (protect externally)
+ */
+class ARCPolicy : public EvictPolicy
+{
+public:
+
+    /** @param capacity the size of the cache in bytes (limits the ghost lists) */
+    explicit ARCPolicy(size_t capacity);
+
+    void Insert(const Page* page, const PageKey& key, size_t size, bool lowPriority) override;
+    void Access(const Page* page) override;
+    void Resize(const Page* page, size_t size) override;
+    void Erase(const Page* page, bool evicted) override;
+    void Requeue(const Page* page) override;
+    void EraseOwner(const void* owner) override;
+    void ForEachVictim(const std::function<bool(const Page*)>& func) const override;
+    void SetCapacity(size_t capacity) override;
+
+    /** Returns the current target size of the recent list in bytes */
+    [[nodiscard]] inline size_t GetTarget() const { return mTarget; }
+
+    /** Returns true if the given page is in the frequent list */
+    [[nodiscard]] inline bool isFrequent(const Page* page) const { return mFrequent.exists(page); }
+
+private:
+
+    /** A cached page's key and size */
+    struct Entry
+    {
+        PageKey key;
+        size_t size;
+    };
+
+    /** List of cached pages, most recent first */
+    using EntryList = OrderedMap<const Page*, Entry>;
+    /** List of evicted page keys and their sizes, most recent first */
+    using GhostList = OrderedMap<PageKey, size_t>;
+
+    /** Adds a page to the recent list, or the frequent list if it hits a ghost */
+    void AddEntry(const Page* page, const Entry& entry);
+
+    /** Removes all ghosts of the given owner from the list, returning their total size */
+    static size_t EraseGhosts(GhostList& ghosts, const void* owner);
+
+    /** Removes ghosts until the history is within the ARC limits */
+    void TrimGhosts();
+
+    /** The size of the cache in bytes */
+    size_t mCapacity;
+    /** The adaptive target size of the recent list in bytes */
+    size_t mTarget { 0 };
+
+    /** Read-ahead pages that have not been accessed (T0) */
+    EntryList mPrefetch;
+    size_t mPrefetchBytes { 0 };
+    /** Pages that have been accessed once (T1) */
+    EntryList mRecent;
+    size_t mRecentBytes { 0 };
+    /** Pages that have been accessed more than once (T2) */
+    EntryList mFrequent;
+    size_t mFrequentBytes { 0 };
+
+    /** Pages evicted from the recent list (B1) */
+    GhostList mRecentGhosts;
+    size_t mRecentGhostBytes { 0 };
+    /** Pages evicted from the frequent list (B2) */
+    GhostList mFrequentGhosts;
+    size_t mFrequentGhostBytes { 0 };
+};
+
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
+
+#endif // LIBA2_ARCPOLICY_H_
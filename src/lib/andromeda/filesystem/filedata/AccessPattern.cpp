@@ -0,0 +1,98 @@
+
+#include "AccessPattern.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+
+/*****************************************************/
+AccessPattern::AccessPattern(const char* debugName) :
+    mDebug(std::string(__func__)+"_"+debugName,this) { }
+
+/*****************************************************/
+const char* AccessPattern::TypeString(const Type type)
+{
+    switch (type)
+    {
+        case Type::SEQUENTIAL: return "sequential";
+        case Type::STRIDED:    return "strided";
+        case Type::REVERSE:    return "reverse";
+        case Type::RANDOM:     return "random";
+        default: return "unknown";
+    }
+}
+
+/*****************************************************/
+AccessPattern::Type AccessPattern::Access(const uint64_t index)
+{
+    if (mHaveLast && index == mLastIndex) { mJump = false; return mType; } // same page
+    
+    if (mHaveLast)
+    {
+        // unsigned wraparound gives the correct two's complement difference
+        const int64_t delta { static_cast<int64_t>(index - mLastIndex) };
+        mJump = (delta < -SEQUENTIAL_SLACK || delta > SEQUENTIAL_SLACK) &&
+            !(mType == Type::STRIDED && delta == mStride);
+
+        mDeltas[mDeltaIdx] = delta;
+        mDeltaIdx = (mDeltaIdx+1) % HISTORY_SIZE;
+        if (mDeltaCount < HISTORY_SIZE) ++mDeltaCount;
+        Classify();
+    }
+
+    mLastIndex = index;
+    mHaveLast = true;
+    return mType;
+}
+
+/*****************************************************/
+void AccessPattern::Classify()
+{
+    const Type oldType { mType };
+
+    if (mDeltaCount < HISTORY_MIN)
+    {
+        mType = Type::SEQUENTIAL; mStride = 0; return;
+    }
+
+    // small deltas in either direction count as (maybe reordered) sequential access
+    size_t nearCount { 0 }; int64_t nearSum { 0 };
+    for (size_t i { 0 }; i < mDeltaCount; ++i)
+    {
+        if (mDeltas[i] >= -SEQUENTIAL_SLACK && mDeltas[i] <= SEQUENTIAL_SLACK)
+            { ++nearCount; nearSum += mDeltas[i]; }
+    }
+
+    // a pattern must account for at least half of the history
+    if (nearCount*2 >= mDeltaCount)
+    {
+        mType = (nearSum >= 0) ? Type::SEQUENTIAL : Type::REVERSE; mStride = 0;
+    }
+    else
+    {
+        // find the most common delta (history is tiny so N^2 is fine)
+        int64_t bestDelta { 0 }; size_t bestCount { 0 };
+        for (size_t i { 0 }; i < mDeltaCount; ++i)
+        {
+            size_t count { 0 };
+            for (size_t j { 0 }; j < mDeltaCount; ++j)
+                if (mDeltas[j] == mDeltas[i]) ++count;
+
+            if (count > bestCount) 
+            {
+                bestCount = count; 
+                bestDelta = mDeltas[i];
+            }
+        }
+
+        if (bestCount*2 >= mDeltaCount) 
+            { mType = Type::STRIDED; mStride = bestDelta; }
+        else { mType = Type::RANDOM; mStride = 0; }
+    }
+
+    if (mType != oldType) { MDBG_INFO("() new type:" << TypeString(mType) << " stride:" << mStride); }
+}
+
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
@@ -0,0 +1,93 @@
+
+#ifndef LIBA2_ACCESSPATTERN_H_
+#define LIBA2_ACCESSPATTERN_H_
+
+#include <array>
+#include <cstdint>
+
+#include "andromeda/Debug.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+
+/** 
+ * Keeps a short history of page accesses to classify the access 
+ * stream as sequential, strided, reverse or random (for read-ahead)
+ * Repeated accesses to the same page are not counted, and
+ * sequential/reverse allow for slightly out of order access
+ * NOT THREAD SAFE (protect externally)
+ */
+class AccessPattern
+{
+public:
+
+    /** The type of access stream */
+    enum class Type : uint8_t
+    {
+        /** consecutive increasing pages */    SEQUENTIAL,
+        /** pages with a constant larger gap */ STRIDED,
+        /** consecutive decreasing pages */    REVERSE,
+        /** no detectable pattern */           RANDOM
+    };
+
+    /** @param debugName name to use for debug output */
+    explicit AccessPattern(const char* debugName);
+
+    /** Records an access to the given page index and returns the new classification */
+    Type Access(uint64_t index);
+
+    /** Returns the current classification (SEQUENTIAL until there is enough history) */
+    [[nodiscard]] Type GetType() const { return mType; }
+
+    /** Returns the page distance between accesses if STRIDED (else 0) */
+    [[nodiscard]] int64_t GetStride() const { return mStride; }
+
+    /** 
+     * Returns true if the last access jumped away from the pattern in effect before it
+     * (more than the sequential slack, and not the current stride) - read-ahead for the old position is stale
+     */
+    [[nodiscard]] bool isJump() const { return mJump; }
+
+    /** Returns the string name of a type for debug */
+    static const char* TypeString(Type type);
+
+private:
+
+    /** Re-calculates mType and mStride from the history */
+    void Classify();
+
+    /** The number of access deltas to keep */
+    static constexpr size_t HISTORY_SIZE { 8 };
+    /** The minimum number of deltas before not defaulting to SEQUENTIAL */
+    static constexpr size_t HISTORY_MIN { 3 };
+    /** The max page delta considered sequential (concurrent readers can be slightly out of order) */
+    static constexpr int64_t SEQUENTIAL_SLACK { 2 };
+
+    /** Ring buffer of the differences between consecutive accessed pages */
+    std::array<int64_t, HISTORY_SIZE> mDeltas { };
+    /** The number of valid entries in mDeltas */
+    size_t mDeltaCount { 0 };
+    /** The next index of mDeltas to write */
+    size_t mDeltaIdx { 0 };
+
+    /** The last page index accessed */
+    uint64_t mLastIndex { 0 };
+    /** True if mLastIndex is valid */
+    bool mHaveLast { false };
+    /** True if the last access was a jump (see isJump) */
+    bool mJump { false };
+
+    /** The current classification */
+    Type mType { Type::SEQUENTIAL };
+    /** The current stride if STRIDED */
+    int64_t mStride { 0 };
+
+    mutable Debug mDebug;
+};
+
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
+
+#endif // LIBA2_ACCESSPATTERN_H_
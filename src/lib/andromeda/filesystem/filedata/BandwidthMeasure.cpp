@@ -35,6 +35,13 @@ size_t BandwidthMeasure::UpdateBandwidth(const size_t bytes, const std::chrono::
     MDBG_INFO("... return targetBytes:" << targetBytes); return targetBytes;
 }
 
+/*****************************************************/
+void BandwidthMeasure::SetTargetBytes(const size_t targetBytes)
+{
+    MDBG_INFO("(targetBytes:" << targetBytes << ")");
+    mBandwidthHistory.fill(targetBytes);
+}
+
 } // namespace Filedata
 } // namespace Filesystem
 } // namespace Andromeda
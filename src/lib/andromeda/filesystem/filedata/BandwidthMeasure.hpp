@@ -28,6 +28,9 @@ public:
     /** Updates the bandwidth history with the given measure and returns the estimated targetBytes */
     size_t UpdateBandwidth(size_t bytes, const std::chrono::steady_clock::duration& time);
 
+    /** Fills the bandwidth history with the given targetBytes, e.g. from a previous estimate */
+    void SetTargetBytes(size_t targetBytes);
+
 private:
 
     /** The desired time target for the transfer */
@@ -1,16 +1,26 @@
 
 #include <cassert>
 #include <chrono>
+#include <optional>
 
+#include "ARCPolicy.hpp"
 #include "CacheManager.hpp"
 #include "CacheOptions.hpp"
 #include "CachingAllocator.hpp"
+#include "CompressedCache.hpp"
+#include "DiskCache.hpp"
+#include "LRUPolicy.hpp"
+#include "MemoryPressure.hpp"
 #include "Page.hpp"
 #include "PageManager.hpp"
 
 #include "andromeda/StringUtil.hpp"
 #include "andromeda/backend/BackendException.hpp"
 using Andromeda::Backend::BackendException;
+#include "andromeda/backend/RunnerPool.hpp"
+using Andromeda::Backend::RunnerPool;
+#include "andromeda/backend/WorkerPool.hpp"
+using Andromeda::Backend::WorkerPool;
 
 namespace Andromeda {
 namespace Filesystem {
@@ -19,14 +29,34 @@ namespace Filedata {
 /*****************************************************/
 CacheManager::CacheManager(const CacheOptions& cacheOptions, bool startThreads) : 
     mDebug(__func__,this),
+    mPageQueue(SHARD_COUNT, [&]()->std::unique_ptr<EvictPolicy> {
+        if (cacheOptions.evictType == CacheOptions::EvictType::ARC)
+            return std::make_unique<ARCPolicy>(cacheOptions.memoryLimit); // see SetCapacity
+        else return std::make_unique<LRUPolicy>(); }),
     mCacheOptions(cacheOptions),
+    mMemoryLimit(cacheOptions.memoryLimit),
+    mPressureLimit(cacheOptions.memoryLimit),
     mBandwidth(__func__, cacheOptions.maxDirtyTime)
 { 
     MDBG_INFO("()");
 
     const size_t memoryLimit { mCacheOptions.memoryLimit };
+    mPageQueue.SetCapacity(memoryLimit);
     const size_t allocBaseline { memoryLimit - memoryLimit/mCacheOptions.evictSizeFrac };
-    mPageAllocator = std::make_unique<CachingAllocator>(allocBaseline);
+    mPageAllocator = std::make_unique<CachingAllocator>(allocBaseline, mCacheOptions.hugePages);
+
+    if (!mCacheOptions.diskCachePath.empty())
+        mDiskCache = std::make_unique<DiskCache>(mCacheOptions.diskCachePath, mCacheOptions.diskCacheLimit);
+
+    if (mCacheOptions.compressLimit)
+    {
+        if (CompressedCache::isSupported())
+            mCompressedCache = std::make_unique<CompressedCache>(mCacheOptions.compressLimit);
+        else { MDBG_ERROR("... compressed tier not supported (built without liblz4)"); }
+    }
+
+    if (mCacheOptions.memoryPressure)
+        mMemoryPressure = std::make_unique<MemoryPressure>();
 
     if (startThreads) StartThreads();
 }
@@ -34,7 +64,49 @@ CacheManager::CacheManager(const CacheOptions& cacheOptions, bool startThreads)
 /*****************************************************/
 size_t CacheManager::GetMemoryLimit() const
 { 
-    return mCacheOptions.memoryLimit; 
+    return mMemoryLimit.load(); 
+}
+
+/*****************************************************/
+void CacheManager::UpdateMemoryLimit()
+{
+    const MemoryPressure::Sample sample { mMemoryPressure->GetSample() };
+    const size_t maxLimit { mCacheOptions.memoryLimit };
+    const size_t minLimit { maxLimit/PRESSURE_MIN_FRAC };
+
+    // shrink quickly while processes are stalling on memory, grow back slowly once they're not
+    const std::chrono::steady_clock::time_point now { std::chrono::steady_clock::now() };
+    if (sample.stallPercent && *sample.stallPercent >= PRESSURE_HIGH)
+    {
+        if (!mPressureShrink || now - *mPressureShrink >= PRESSURE_WINDOW)
+        {
+            mPressureLimit = std::max(minLimit, mPressureLimit/2);
+            mPressureShrink = now;
+        }
+    }
+    else if (!sample.stallPercent || *sample.stallPercent < PRESSURE_LOW)
+        mPressureLimit = std::min(maxLimit, mPressureLimit + maxLimit/PRESSURE_MIN_FRAC);
+
+    size_t limit { mPressureLimit };
+    if (sample.cgroupMax && sample.cgroupCurrent)
+    {
+        // our own pages are counted in the cgroup's usage, leave some room for everything else
+        const uint64_t ours { std::min(static_cast<uint64_t>(mPageQueue.GetTotal()), *sample.cgroupCurrent) };
+        const uint64_t others { *sample.cgroupCurrent - ours + *sample.cgroupMax/CGROUP_RESERVE_FRAC };
+        const uint64_t room { (*sample.cgroupMax > others) ? *sample.cgroupMax - others : 0 };
+        if (room < limit) limit = static_cast<size_t>(room);
+    }
+    limit = std::max(minLimit, limit);
+
+    const size_t oldLimit { mMemoryLimit.exchange(limit) };
+    if (limit != oldLimit)
+    {
+        MDBG_INFO("... memory limit changed! old:" << oldLimit << " new:" << limit);
+        mPageQueue.SetCapacity(limit);
+    }
+
+    // give the allocator's free pool back to the OS rather than holding it for re-use
+    if (limit < oldLimit) mPageAllocator->Trim(0);
 }
 
 /*****************************************************/
@@ -72,120 +144,79 @@ void CacheManager::StartThreads()
 }
 
 /*****************************************************/
-void CacheManager::InformPage(PageManager& pageMgr, const uint64_t index, const Page& page, bool dirty, bool canWait, const SharedLockW* mgrLock)
+void CacheManager::InformPage(PageManager& pageMgr, const uint64_t index, const Page& page, bool dirty, bool canWait, const SharedLockW* mgrLock, bool lowPriority)
 {
-    MDBG_INFO("(page:" << index << " " << &page << " canWait:" << BOOLSTR(canWait) << ")");
+    MDBG_INFO("(page:" << index << " " << &page << " canWait:" << BOOLSTR(canWait) << " lowPriority:" << BOOLSTR(lowPriority) << ")");
 
-    UniqueLock lock(mMutex);
+    const size_t oldSize { mPageQueue.Enqueue(pageMgr, index, page, dirty, lowPriority) };
 
-    const size_t oldSize { EnqueuePage(pageMgr, index, page, dirty, lock) };
+    PrintStatus(__func__);
+    if (dirty) PrintDirtyStatus(__func__);
 
     if (page.capacity() > oldSize)
     {
-        HandleMemory(pageMgr, page, canWait, lock, mgrLock);
-        if (dirty) HandleDirtyMemory(pageMgr, page, canWait, lock, mgrLock);
+        HandleMemory(pageMgr, page, canWait, mgrLock);
+        if (dirty) HandleDirtyMemory(pageMgr, page, canWait, mgrLock);
     }
 
     MDBG_INFO("... return!");
 }
 
-/*****************************************************/
-size_t CacheManager::EnqueuePage(PageManager& pageMgr, const uint64_t index, const Page& page, bool dirty, const UniqueLock& lock) // cppcheck-suppress constParameterReference
-{
-    const size_t oldSize { RemovePage(page, lock) };
-    const size_t newSize { page.capacity() }; // real memory usage
-
-    const PageInfo pageInfo { pageMgr, index, newSize };
-
-    mPageQueue.enqueue_front(&page, pageInfo);
-    mCurrentTotal += newSize;
-
-    PrintStatus(__func__, lock);
-
-    if (dirty)
-    {
-        mDirtyQueue.enqueue_front(&page, pageInfo);
-        mCurrentDirty += newSize;
-        PrintDirtyStatus(__func__, lock);
-    }
-
-    MDBG_INFO("... pageSize:" << page.size() 
-        << " newSize:" << newSize << " oldSize:" << oldSize);
-    return oldSize;
-}
-
 /*****************************************************/
 void CacheManager::ResizePage(const PageManager& pageMgr, const Page& page, const SharedLockW* mgrLock)
 {
-    const size_t newSize = page.capacity(); // real memory usage
-    MDBG_INFO("... pageSize:" << page.size() << " newSize:" << newSize);
-
-    UniqueLock lock(mMutex);
+    MDBG_INFO("... pageSize:" << page.size() << " newSize:" << page.capacity());
 
-    { const PageQueue::iterator itQueue { mPageQueue.find(&page) };
-    if (itQueue != mPageQueue.end()) 
-    {
-        const size_t oldSize { itQueue->second.mPageSize };
-        mCurrentTotal += newSize-oldSize;
-        itQueue->second.mPageSize = newSize;
+    const PageQueue::ResizeResult resized { mPageQueue.Resize(pageMgr, page) };
 
-        PrintStatus(__func__, lock);
-        
-        if (newSize > oldSize)
-            HandleMemory(pageMgr, page, true, lock, mgrLock);
-    } }
+    PrintStatus(__func__);
+    PrintDirtyStatus(__func__);
 
-    { const PageQueue::iterator itQueue { mDirtyQueue.find(&page) };
-    if (itQueue != mDirtyQueue.end()) 
-    {
-        const size_t oldSize { itQueue->second.mPageSize };
-        mCurrentDirty += newSize-oldSize;
-        itQueue->second.mPageSize = newSize;
-        
-        PrintDirtyStatus(__func__, lock);
-
-        if (newSize > oldSize)
-            HandleDirtyMemory(pageMgr, page, true, lock, mgrLock);
-    } }
+    if (resized.grew)
+        HandleMemory(pageMgr, page, true, mgrLock);
+    if (resized.grewDirty)
+        HandleDirtyMemory(pageMgr, page, true, mgrLock);
 }
 
 /*****************************************************/
-void CacheManager::HandleMemory(const PageManager& pageMgr, const Page& page, bool canWait, UniqueLock& lock, const SharedLockW* mgrLock)
+void CacheManager::HandleMemory(const PageManager& pageMgr, const Page& page, bool canWait, const SharedLockW* mgrLock)
 {
+    if (!ShouldEvict()) return; // fast path, no global lock
+
     MDBG_INFO("(canWait:" << BOOLSTR(canWait) << ")");
 
     if (mgrLock != nullptr && canWait)
     {
         // in this case we can evict synchronously rather than the background thread
-        // so we can directly pick up errors (they could be missed due to mSkipEvictWait)
-        while (ShouldEvict(lock) && 
-            &mPageQueue.back().second.mPageMgr == &pageMgr &&
-            mPageQueue.back().first != &page)
+        // so we can directly pick up errors (they could be missed due to mSkipEvictWaits)
+        while (ShouldEvict())
         {
+            const std::optional<PageInfo> pageInfo { mPageQueue.GetNextEvict(pageMgr, page) };
+            if (!pageInfo) break; // nothing evictable
             MDBG_INFO("... memory limit! synchronous evict");
-
-            PrintStatus(__func__, lock);
-            PageInfo pageInfo { mPageQueue.back().second }; // copy
-
-            lock.unlock(); // don't hold lock during evict
-            pageInfo.mPageMgr.EvictPage(pageInfo.mPageIndex, *mgrLock); // throws
-            lock.lock();
+            PrintStatus(__func__);
+            pageInfo->mOwner.EvictPage(pageInfo->mPageIndex, *mgrLock); // throws
         }
     }
 
+    UniqueLock lock(mMutex);
     if (mEvictThread.joinable())
     {
         if (canWait)
         {
             mEvictFailure = nullptr; // reset error
+            const std::chrono::steady_clock::time_point waitStart { std::chrono::steady_clock::now() };
+            bool waited { false };
             while (ShouldAwaitEvict(pageMgr, lock))
             {
                 MDBG_INFO("... waiting for memory");
                 mEvictThreadCV.notify_one();
                 mEvictWaitCV.wait(lock);
+                waited = true;
             }
+            if (waited) pageMgr.GetCacheStats().AddMemoryWait(std::chrono::steady_clock::now()-waitStart);
         }
-        else if (ShouldEvict(lock))
+        else if (ShouldEvict())
         {
             MDBG_INFO("... memory limit! signal");
             mEvictThreadCV.notify_one();
@@ -194,42 +225,44 @@ void CacheManager::HandleMemory(const PageManager& pageMgr, const Page& page, bo
 }
 
 /*****************************************************/
-void CacheManager::HandleDirtyMemory(const PageManager& pageMgr, const Page& page, bool canWait, UniqueLock& lock, const SharedLockW* mgrLock)
+void CacheManager::HandleDirtyMemory(const PageManager& pageMgr, const Page& page, bool canWait, const SharedLockW* mgrLock)
 {
+    if (!ShouldFlush()) return; // fast path, no global lock
+
     MDBG_INFO("(canWait:" << BOOLSTR(canWait) << ")");
 
     if (mgrLock != nullptr && canWait)
     {
         // in this case we can evict synchronously rather than the background thread
-        // so we can directly pick up errors (they could be missed due to mSkipFlushWait)
-        while (ShouldFlush(lock) && 
-            &mDirtyQueue.back().second.mPageMgr == &pageMgr &&
-            mDirtyQueue.back().first != &page)
+        // so we can directly pick up errors (they could be missed due to mSkipFlushWaits)
+        while (ShouldFlush())
         {
+            const std::optional<PageInfo> pageInfo { mPageQueue.GetNextFlush(pageMgr, page) };
+            if (!pageInfo) break; // nothing flushable
             MDBG_INFO("... dirty limit! synchronous flush");
-
-            PrintDirtyStatus(__func__, lock);
-            PageInfo pageInfo { mDirtyQueue.back().second }; // copy
-
-            lock.unlock(); // don't hold lock during flush
-            FlushPage(pageInfo.mPageMgr, pageInfo.mPageIndex, *mgrLock); // throws
-            lock.lock();
+            PrintDirtyStatus(__func__);
+            FlushPage(pageInfo->mOwner, pageInfo->mPageIndex, *mgrLock); // throws
         }
     }
 
+    UniqueLock lock(mMutex);
     if (mFlushThread.joinable())
     {
         if (canWait)
         {
             mFlushFailure = nullptr; // reset error
+            const std::chrono::steady_clock::time_point waitStart { std::chrono::steady_clock::now() };
+            bool waited { false };
             while (ShouldAwaitFlush(pageMgr, lock))
             {
                 MDBG_INFO("... waiting for dirty memory");
                 mFlushThreadCV.notify_one();
                 mFlushWaitCV.wait(lock);
+                waited = true;
             }
+            if (waited) pageMgr.GetCacheStats().AddDirtyWait(std::chrono::steady_clock::now()-waitStart);
         }
-        else if (ShouldFlush(lock))
+        else if (ShouldFlush())
         {
             MDBG_INFO("... dirty limit! signal");
             mFlushThreadCV.notify_one();
@@ -240,7 +273,7 @@ void CacheManager::HandleDirtyMemory(const PageManager& pageMgr, const Page& pag
 /*****************************************************/
 bool CacheManager::ShouldAwaitEvict(const PageManager& pageMgr, const UniqueLock& lock) const
 {
-    const bool shouldEvict { ShouldEvict(lock) };
+    const bool shouldEvict { ShouldEvict() };
     if (shouldEvict && mEvictFailure != nullptr)
         throw MemoryException("evict");
 
@@ -251,7 +284,7 @@ bool CacheManager::ShouldAwaitEvict(const PageManager& pageMgr, const UniqueLock
 /*****************************************************/
 bool CacheManager::ShouldAwaitFlush(const PageManager& pageMgr, const UniqueLock& lock) const
 {
-    const bool shouldFlush { ShouldFlush(lock) };
+    const bool shouldFlush { ShouldFlush() };
     if (shouldFlush && mFlushFailure != nullptr)
         throw MemoryException("flush");
 
@@ -260,83 +293,51 @@ bool CacheManager::ShouldAwaitFlush(const PageManager& pageMgr, const UniqueLock
 }
 
 /*****************************************************/
-void CacheManager::RemovePage(const Page& page)
-{
-    const UniqueLock lock(mMutex);
-    RemovePage(page, lock);
-
-    PrintStatus(__func__, lock);
-    PrintDirtyStatus(__func__, lock);
-}
-
-/*****************************************************/
-void CacheManager::RemoveDirty(const Page& page)
+void CacheManager::RemovePage(const PageManager& pageMgr, const Page& page, bool evicted)
 {
-    const UniqueLock lock(mMutex);
-    RemoveDirty(page, lock);
-
-    PrintDirtyStatus(__func__, lock);
-}
-
-/*****************************************************/
-size_t CacheManager::RemovePage(const Page& page, const UniqueLock& lock)
-{
-    size_t pageSize { 0 }; // size of page removed
-    const PageQueue::lookup_iterator itLookup { mPageQueue.lookup(&page) };
-    if (itLookup != mPageQueue.lend())
+    if (mPageQueue.Remove(pageMgr, page, evicted))
     {
         MDBG_INFO("(page:" << &page << ")");
-        pageSize = itLookup->second->second.mPageSize;
-        mCurrentTotal -= pageSize;
-        mPageQueue.erase(itLookup);
+        PrintStatus(__func__);
+        PrintDirtyStatus(__func__);
     }
+}
 
-    RemoveDirty(page, lock);
-    return pageSize;
+/*****************************************************/
+void CacheManager::RemovePageManager(const PageManager& pageMgr)
+{
+    MDBG_INFO("(pageMgr:" << &pageMgr << ")");
+    mPageQueue.RemoveOwner(pageMgr);
 }
 
 /*****************************************************/
-void CacheManager::RemoveDirty(const Page& page, const UniqueLock& lock)
+void CacheManager::RemoveDirty(const PageManager& pageMgr, const Page& page)
 {
-    const PageQueue::lookup_iterator itLookup { mDirtyQueue.lookup(&page) };
-    if (itLookup != mDirtyQueue.lend())
-    {
-        MDBG_INFO("(page:" << &page << ")");
-        mCurrentDirty -= itLookup->second->second.mPageSize;
-        mDirtyQueue.erase(itLookup);
-    }
+    mPageQueue.RemoveDirty(pageMgr, page);
+    PrintDirtyStatus(__func__);
 }
 
 /*****************************************************/
-void CacheManager::PrintStatus(const char* const fname, const UniqueLock& lock)
+void CacheManager::PrintStatus(const char* const fname)
 {
     mDebug.Info([&](std::ostream& str){ str << fname << "..."
-        << " pages:" << mPageQueue.size() << ", memory:" << mCurrentTotal; });
-
-#if DEBUG // this will kill performance
-    size_t total = 0; for (const PageQueue::value_type& pageInfo : mPageQueue) total += pageInfo.second.mPageSize;
-    if (total != mCurrentTotal){ MDBG_ERROR(": BAD MEMORY TRACKING! " << total << " != " << mCurrentTotal); assert(false); }
-#endif // DEBUG
+        << " memory:" << mPageQueue.GetTotal(); });
 }
 
 /*****************************************************/
-void CacheManager::PrintDirtyStatus(const char* const fname, const UniqueLock& lock)
+void CacheManager::PrintDirtyStatus(const char* const fname)
 {
     mDebug.Info([&](std::ostream& str){ str << fname << "..."
-        << " dirtyPages:" << mDirtyQueue.size() << ", dirtyMemory:" << mCurrentDirty; });
-
-#if DEBUG // this will kill performance
-    size_t total = 0; for (const PageQueue::value_type& pageInfo : mDirtyQueue) total += pageInfo.second.mPageSize;
-    if (total != mCurrentDirty){ MDBG_ERROR(": BAD DIRTY TRACKING! " << total << " != " << mCurrentDirty); assert(false); }
-#endif // DEBUG
+        << " dirtyMemory:" << mPageQueue.GetDirty(); });
 }
 
 /*****************************************************/
-SharedLockW CacheManager::GetPageManagerLock(PageManager& pageMgr, PageManager*& waitPtr)
+SharedLockW CacheManager::GetPageManagerLock(PageManager& pageMgr, SkipSet& skipSet)
 {
+    SkipSet::iterator skipIt;
     { // let waiters on this file continue so we can lock it
         const UniqueLock lock(mMutex);
-        waitPtr = &pageMgr;
+        skipIt = skipSet.insert(&pageMgr);
 
         // ShouldAwait() will check both to avoid deadlock
         mEvictWaitCV.notify_all();
@@ -347,7 +348,7 @@ SharedLockW CacheManager::GetPageManagerLock(PageManager& pageMgr, PageManager*&
     
     { // have the mgrLock now
         const UniqueLock lock(mMutex);
-        waitPtr = nullptr;
+        skipSet.erase(skipIt);
     }
 
     return mgrLock;
@@ -357,18 +358,26 @@ SharedLockW CacheManager::GetPageManagerLock(PageManager& pageMgr, PageManager*&
 void CacheManager::EvictThread()
 {
     MDBG_INFO("()");
+    const RunnerPool::PriorityScope priority(RunnerPool::Priority::WRITEBACK); // evicting dirty pages flushes
 
     while (true)
     {
         { // lock scope
+            if (mMemoryPressure) UpdateMemoryLimit();
+
             UniqueLock lock(mMutex);
-            while (mRunCleanup.load() && (mCurrentTotal <= mCacheOptions.memoryLimit || mEvictFailure != nullptr))
+            bool timedOut { false };
+            while (mRunCleanup.load() && !timedOut && (!ShouldEvict() || mEvictFailure != nullptr))
             {
                 MDBG_INFO("... waiting");
                 mEvictWaitCV.notify_all();
-                mEvictThreadCV.wait(lock);
+
+                if (mMemoryPressure) // wake up periodically to check the memory pressure
+                    timedOut = (mEvictThreadCV.wait_for(lock, PRESSURE_INTERVAL) == std::cv_status::timeout);
+                else mEvictThreadCV.wait(lock);
             }
             if (!mRunCleanup.load()) break; // stop loop
+            if (timedOut) continue; // check pressure again
             MDBG_INFO("... DOING EVICTS!");
         }
 
@@ -382,16 +391,26 @@ void CacheManager::EvictThread()
 void CacheManager::FlushThread()
 {
     MDBG_INFO("()");
+    const RunnerPool::PriorityScope priority(RunnerPool::Priority::WRITEBACK);
 
     while (true)
     {
         { // lock scope
             UniqueLock lock(mMutex);
-            while (mRunCleanup.load() && (mCurrentDirty <= mDirtyLimit || mFlushFailure != nullptr))
+            while (mRunCleanup.load() && (mFlushFailure != nullptr || !ShouldFlush()))
             {
+                // also wake up when the oldest dirty page reaches its max age
+                const std::optional<PageQueue::Clock::time_point> oldest { mPageQueue.GetOldestDirty() };
+                const PageQueue::Clock::time_point deadline { oldest ? 
+                    *oldest + GetMaxDirtyAge() : PageQueue::Clock::now() + GetMaxDirtyAge() };
+                if (mFlushFailure == nullptr && oldest && deadline <= PageQueue::Clock::now()) break;
+
                 MDBG_INFO("... waiting");
                 mFlushWaitCV.notify_all();
-                mFlushThreadCV.wait(lock);
+
+                // after a failure, wait for a caller to reset it rather than retrying old pages right away
+                if (mFlushFailure != nullptr) mFlushThreadCV.wait(lock);
+                else mFlushThreadCV.wait_until(lock, deadline);
             }
             if (!mRunCleanup.load()) break; // stop loop
             MDBG_INFO("... DOING FLUSHES!");
@@ -411,31 +430,25 @@ void CacheManager::DoPageEvictions() noexcept // thread cannot throw
     // FIRST build a list of pages to evict
     PageMgrPageMap currentEvicts;
     { // lock scope
-        const UniqueLock lock(mMutex);
+        PrintStatus(__func__);
 
-        PrintStatus(__func__, lock);
-        size_t cleaned { 0 };
+        const size_t memoryLimit { mMemoryLimit.load() };
+        const size_t margin { memoryLimit/mCacheOptions.evictSizeFrac };
+        const size_t total { mPageQueue.GetTotal() + margin };
+        const size_t evictBytes { (total > memoryLimit) ? total - memoryLimit : 0 };
 
-        PageQueue::reverse_iterator pageIt { mPageQueue.rbegin() };
-        const size_t margin { mCacheOptions.memoryLimit/mCacheOptions.evictSizeFrac };
-        for (; mCurrentTotal + margin > mCacheOptions.memoryLimit + cleaned; ++pageIt)
+        mPageQueue.GetEvictions(evictBytes, [&](const Page& pageRef, const PageInfo& pageInfo)->bool
         {
-            const Page& pageRef { *pageIt->first };
-            PageInfo& pageInfo { pageIt->second };
-
-            const PageMgrPageMap::iterator evictIt { currentEvicts.find(&pageInfo.mPageMgr) };
-            // get ScopeLock to make sure pageManager stays in scope between mMutex release and getting pageMgrW lock
+            const PageMgrPageMap::iterator evictIt { currentEvicts.find(&pageInfo.mOwner) };
+            // get ScopeLock to make sure pageManager stays in scope between the shard lock release and getting pageMgrW lock
             LockedPageList& evictSet { (evictIt != currentEvicts.end()) ? evictIt->second : currentEvicts.emplace(
-                &pageInfo.mPageMgr, std::make_pair(pageInfo.mPageMgr.TryLockScope(), PageList())).first->second };
+                &pageInfo.mOwner, std::make_pair(pageInfo.mOwner.TryLockScope(), PageList())).first->second };
 
-            if (!evictSet.first) // scope lock
-                RemovePage(pageRef, lock); // being deleted
-            else
-            {
-                evictSet.second.emplace_back(pageRef, pageInfo); // copy
-                cleaned += pageInfo.mPageSize;
-            }
-        }
+            if (!evictSet.first) return false; // scope lock, being deleted
+
+            evictSet.second.emplace_back(pageRef, pageInfo); // copy
+            return true;
+        });
     }
 
     // THEN evict all the pages in the set
@@ -443,24 +456,23 @@ void CacheManager::DoPageEvictions() noexcept // thread cannot throw
     {
         LockedPageList& evictSet { evictIt->second };
         MDBG_INFO("... evicting pages:" << evictSet.second.size() << " pageMgr:" << evictIt->first);
-        const SharedLockW mgrLock { GetPageManagerLock(*evictIt->first, mSkipEvictWait) };
+        const SharedLockW mgrLock { GetPageManagerLock(*evictIt->first, mSkipEvictWaits) };
 
         for (const PageList::value_type& pagePair : evictSet.second)
         {
             const Page& pageRef { pagePair.first };
             const PageInfo& pageInfo { pagePair.second };
 
-            try { pageInfo.mPageMgr.EvictPage(pageInfo.mPageIndex, mgrLock); }
+            try { pageInfo.mOwner.EvictPage(pageInfo.mPageIndex, mgrLock); }
             catch (const BackendException& ex)
             {
-                const UniqueLock lock(mMutex);
                 MDBG_ERROR("... " << ex.what());
                 
                 // move the failed page to the end so we try a different (maybe non-dirty) one next
                 // evicting a non-dirty page doesn't use the backend so we can likely still evict those
-                if (RemovePage(pageRef, lock)) // only if it's still enqueued (lock was released above)
-                    EnqueuePage(pageInfo.mPageMgr, pageInfo.mPageIndex, pageRef, pageRef.isDirty(), lock);
+                mPageQueue.Requeue(pageInfo.mOwner, pageRef); // only if it's still enqueued (lock was released above)
 
+                const UniqueLock lock(mMutex);
                 mEvictFailure = std::current_exception();
                 mEvictWaitCV.notify_all();
                 return; // early return
@@ -479,73 +491,104 @@ void CacheManager::DoPageFlushes() noexcept // thread cannot throw
 {
     MDBG_INFO("()");
 
-    // FIRST build a list of pages to evict
+    // FIRST build a list of pages to flush
     PageMgrPageMap currentFlushes;
     { // lock scope
-        const UniqueLock lock(mMutex);
+        PrintDirtyStatus(__func__);
 
-        PrintDirtyStatus(__func__, lock);
-        size_t cleaned { 0 };
+        const size_t dirty { mPageQueue.GetDirty() };
+        const size_t dirtyLimit { mDirtyLimit.load() };
+        const size_t flushBytes { (dirty > dirtyLimit) ? dirty - dirtyLimit : 0 };
+        const PageQueue::Clock::time_point expired { PageQueue::Clock::now() - GetMaxDirtyAge() };
 
-        PageQueue::reverse_iterator pageIt { mDirtyQueue.rbegin() };
-        for (; mCurrentDirty > mDirtyLimit + cleaned; ++pageIt)
+        mPageQueue.GetFlushes(flushBytes, expired, [&](const Page& pageRef, const PageInfo& pageInfo)->bool
         {
-            const Page& pageRef { *pageIt->first };
-            PageInfo& pageInfo { pageIt->second };
-
-            const PageMgrPageMap::iterator flushIt { currentFlushes.find(&pageInfo.mPageMgr) };
-            // get ScopeLock to make sure pageManager stays in scope between mMutex release and getting pageMgrW lock
+            const PageMgrPageMap::iterator flushIt { currentFlushes.find(&pageInfo.mOwner) };
+            // get ScopeLock to make sure pageManager stays in scope between the shard lock release and getting pageMgrW lock
             LockedPageList& flushSet { (flushIt != currentFlushes.end()) ? flushIt->second : currentFlushes.emplace(
-                &pageInfo.mPageMgr, std::make_pair(pageInfo.mPageMgr.TryLockScope(), PageList())).first->second };
+                &pageInfo.mOwner, std::make_pair(pageInfo.mOwner.TryLockScope(), PageList())).first->second };
 
-            if (!flushSet.first) // scope lock
-                RemovePage(pageRef, lock); // being deleted
-            else
-            {
-                flushSet.second.emplace_back(pageRef, pageInfo); // copy
-                cleaned += pageInfo.mPageSize;
-            }
-        }
+            if (!flushSet.first) return false; // scope lock, being deleted
+
+            flushSet.second.emplace_back(pageRef, pageInfo); // copy
+            return true;
+        });
     }
 
-    // THEN flush all the pages in the set
-    for (PageMgrPageMap::iterator flushIt { currentFlushes.begin() }; flushIt != currentFlushes.end(); )
+    // THEN flush each page manager's set concurrently on its backend's worker pool
+    std::mutex doneMutex;
+    std::condition_variable doneCV;
+    size_t running { 0 }; // protected by doneMutex
+    std::exception_ptr failure; // protected by doneMutex
+
+    for (PageMgrPageMap::value_type& flushPair : currentFlushes)
     {
-        LockedPageList& flushSet { flushIt->second };
-        MDBG_INFO("... flushing pages:" << flushSet.second.size() << " pageMgr:" << flushIt->first);
-        const SharedLockW mgrLock { GetPageManagerLock(*flushIt->first, mSkipFlushWait) };
+        PageManager& pageMgr { *flushPair.first };
+        const PageList& flushList { flushPair.second.second };
+        MDBG_INFO("... flushing pages:" << flushList.size() << " pageMgr:" << &pageMgr);
 
-        for (const PageList::value_type& pagePair : flushSet.second)
+        WorkerPool::Task task { [&]() noexcept
         {
-            const PageInfo& pageInfo { pagePair.second };
-
-            try { FlushPage(pageInfo.mPageMgr, pageInfo.mPageIndex, mgrLock); }
+            const RunnerPool::PriorityScope priority(RunnerPool::Priority::WRITEBACK);
+            std::exception_ptr taskFailure;
+            try { FlushPageList(pageMgr, flushList); }
             catch (const BackendException& ex)
             {
-                const UniqueLock lock(mMutex);
                 MDBG_ERROR("... " << ex.what());
-
-                mFlushFailure = std::current_exception();
-                mFlushWaitCV.notify_all();
-                return; // early return
+                taskFailure = std::current_exception();
             }
-        }
 
-        flushIt = currentFlushes.erase(flushIt); // release scopeLock
-        mFlushWaitCV.notify_all();
+            const UniqueLock doneLock(doneMutex);
+            if (taskFailure && !failure) failure = taskFailure;
+            --running; doneCV.notify_all(); // while locked, we may go out of scope
+        } };
+
+        { const UniqueLock doneLock(doneMutex); ++running; }
+        if (!pageMgr.GetWorkerPool().TrySubmit(WorkerPool::TaskType::FLUSH, &flushList, std::move(task)))
+            task(); // queue is full (task was not moved), run inline
     }
 
+    { UniqueLock doneLock(doneMutex);
+    while (running > 0)
+    {
+        // run our own tasks that don't have a worker yet rather than waiting on them
+        bool ranTask { false };
+        doneLock.unlock();
+        for (PageMgrPageMap::value_type& flushPair : currentFlushes)
+            ranTask |= flushPair.first->GetWorkerPool().RunQueued(&flushPair.second.second);
+        doneLock.lock();
+        
+        if (!ranTask && running > 0) doneCV.wait(doneLock);
+    } }
+
+    currentFlushes.clear(); // release scopeLocks
+
+    const UniqueLock lock(mMutex);
+    if (failure) mFlushFailure = failure;
+    mFlushWaitCV.notify_all();
+
     MDBG_INFO("... return!");
 }
 
+/*****************************************************/
+void CacheManager::FlushPageList(PageManager& pageMgr, const PageList& pages)
+{
+    const SharedLockW mgrLock { GetPageManagerLock(pageMgr, mSkipFlushWaits) };
+
+    // FlushPage() writes out the whole dirty run after each page so later pages may already be clean
+    for (const PageList::value_type& pagePair : pages)
+        FlushPage(pageMgr, pagePair.second.mPageIndex, mgrLock);
+}
+
 /*****************************************************/
 void CacheManager::FlushPage(PageManager& pageMgr, const uint64_t index, const SharedLockW& mgrLock)
 {
     const std::chrono::steady_clock::time_point timeStart { std::chrono::steady_clock::now() };
     const size_t written { pageMgr.FlushPage(index, mgrLock) };
 
-    const UniqueLock lock(mMutex); // protect mBandwidth/mDirtyLimit
-    mDirtyLimit = mBandwidth.UpdateBandwidth(written, std::chrono::steady_clock::now()-timeStart);
+    const UniqueLock lock(mMutex); // protect mBandwidth
+    mDirtyLimit.store(mBandwidth.UpdateBandwidth(written, std::chrono::steady_clock::now()-timeStart));
+    mFlushWaitCV.notify_all(); // other flushes may still be running
 }
 
 } // namespace Filedata
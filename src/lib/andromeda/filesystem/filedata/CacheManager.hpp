@@ -3,21 +3,25 @@
 #define LIBA2_CACHEMANAGER_H_
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstdint>
 #include <exception>
 #include <list>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <optional>
+#include <set>
 #include <thread>
-#include <unordered_map>
 #include <utility>
 
 #include "BandwidthMeasure.hpp"
 #include "CacheOptions.hpp"
+#include "CacheStats.hpp"
+#include "ShardedPageQueue.hpp"
 #include "andromeda/common.hpp"
 #include "andromeda/Debug.hpp"
-#include "andromeda/OrderedMap.hpp"
 #include "andromeda/ScopeLocked.hpp"
 #include "andromeda/SharedMutex.hpp"
 #include "andromeda/filesystem/Item.hpp"
@@ -29,11 +33,19 @@ namespace Filedata {
 class Page;
 class PageManager;
 class CachingAllocator;
+class CompressedCache;
+class DiskCache;
+class MemoryPressure;
 
 /** 
- * Manages pages as an LRU cache to limit memory usage, by calling EvictPage()
+ * Manages pages as a cache to limit memory usage, by calling EvictPage()
+ * The order of eviction is chosen by an EvictPolicy (see CacheOptions.evictType)
+ * Page bookkeeping is sharded by PageManager so informing about pages of different files
+ *     doesn't contend on one lock, the global totals are atomic (see ShardedPageQueue)
  * Also tracks dirty pages to limit the total dirty memory, by calling FlushPage()
  * The maximum dirty pages is in terms of time, determined by bandwidth measurement
+ * Pages that stay dirty longer than DIRTY_AGE_FACTOR*maxDirtyTime are flushed regardless.
+ * Background flushes of different files run concurrently on their backend's WorkerPool.
  * Fully thread-safe. Evict/Flush are synchronous if possible when writing for
  *     error-catching - otherwise, they happen on background threads.
  * Callers adding new/bigger pages will block until memory is available
@@ -60,7 +72,7 @@ public:
     /** Runs the cleanup threads */
     void StartThreads();
 
-    /** Returns the maximum cache memory size */
+    /** Returns the maximum cache memory size (may change if CacheOptions.memoryPressure) */
     size_t GetMemoryLimit() const;
 
     /** A copy of some member variables for debugging */
@@ -75,16 +87,26 @@ public:
     /** Returns a copy of some member variables for debugging */
     inline Stats GetStats() const 
     { 
-        const UniqueLock lock(mMutex); 
-        return { mCurrentTotal, mPageQueue.size(), 
-            mCurrentDirty, mDirtyLimit, mDirtyQueue.size() }; 
+        return { mPageQueue.GetTotal(), mPageQueue.GetPageCount(), 
+            mPageQueue.GetDirty(), mDirtyLimit.load(), mPageQueue.GetDirtyCount() }; 
     }
 
+    /** Returns the page cache counters for all files */
+    inline CacheStats& GetCacheStats() { return mCacheStats; }
+    /** Returns the page cache counters for all files */
+    inline const CacheStats& GetCacheStats() const { return mCacheStats; }
+
     /** Returns the allocator to use for all file data */
     inline CachingAllocator& GetPageAllocator(){ return *mPageAllocator; }
+
+    /** Returns the on-disk page cache or nullptr if not enabled */
+    inline DiskCache* GetDiskCache(){ return mDiskCache.get(); }
+
+    /** Returns the compressed in-memory page tier or nullptr if not enabled */
+    inline CompressedCache* GetCompressedCache(){ return mCompressedCache.get(); }
     
     /** 
-     * Inform us that a page was used, putting at the front of the LRU
+     * Inform us that a page was used, recording an access with the EvictPolicy
      * if mgrLock is given, may synchronously evict or flush pages on this manager
      * IF this fails, the caller must call RemovePage() or ResizePage(oldSize)
      * @param pageMgr the page manager that owns the page
@@ -93,11 +115,12 @@ public:
      * @param dirty if true, consider dirty memory also
      * @param canWait wait if memory is not below limits
      * @param mgrLock the W lock for the page manager if available
+     * @param lowPriority if true and the page is new, it was read ahead and can be evicted early
      * @throws BackendException if canWait and synchronous failure to free memory
      * @throws MemoryException if canWait and non-synchronous failure to free memory
      */
     void InformPage(PageManager& pageMgr, uint64_t index, const Page& page, bool dirty,
-        bool canWait = true, const SharedLockW* mgrLock = nullptr);
+        bool canWait = true, const SharedLockW* mgrLock = nullptr, bool lowPriority = false);
 
     /**
      * Inform us that a page has changed size
@@ -111,16 +134,31 @@ public:
      */
     void ResizePage(const PageManager& pageMgr, const Page& page, const SharedLockW* mgrLock = nullptr);
 
-    /** Inform us that a page has been erased */
-    void RemovePage(const Page& page);
+    /** 
+     * Inform us that a page has been erased
+     * @param evicted true if the page was evicted to free memory rather than deleted
+     */
+    void RemovePage(const PageManager& pageMgr, const Page& page, bool evicted = false);
+
+    /** Inform us that a page manager is being deleted (after removing its pages) */
+    void RemovePageManager(const PageManager& pageMgr);
 
     /** Inform us that a page is no longer dirty */
-    void RemoveDirty(const Page& page);
+    void RemoveDirty(const PageManager& pageMgr, const Page& page);
     
 private:
 
     using UniqueLock = std::unique_lock<std::mutex>;
 
+    /** All pages and dirty pages, sharded by PageManager */
+    using PageQueue = ShardedPageQueue<PageManager>;
+    using PageInfo = PageQueue::PageInfo;
+
+    // structures used in Page Evict/Flush
+    using PageList = std::list<std::pair<const Page&, PageInfo>>;
+    using LockedPageList = std::pair<ScopeLocked<PageManager>, PageList>;
+    using PageMgrPageMap = std::map<PageManager*, LockedPageList>;
+
     /** 
      * Returns true if we should wait for a page eviction
      * @throws MemoryException if over limit and mEvictFailure is set
@@ -134,15 +172,15 @@ private:
     inline bool ShouldAwaitFlush(const PageManager& pageMgr, const UniqueLock& lock) const;
 
     /** Returns true if evict should run (memory is over the limit) */
-    inline bool ShouldEvict(const UniqueLock& lock) const { return mCurrentTotal > mCacheOptions.memoryLimit; }
+    inline bool ShouldEvict() const { return mPageQueue.GetTotal() > mMemoryLimit.load(); }
 
     /** Returns true if flush should run (dirty memory is over the limit) */
-    inline bool ShouldFlush(const UniqueLock& lock) const { return mCurrentDirty > mDirtyLimit; }
+    inline bool ShouldFlush() const { return mPageQueue.GetDirty() > mDirtyLimit.load(); }
 
     /** Returns true if evict/flush waiting should be skipped for the given page manager */
     inline bool ShouldSkipWait(const PageManager& pageMgr, const UniqueLock& lock) const
     {
-        return mSkipEvictWait == &pageMgr || mSkipFlushWait == &pageMgr;
+        return mSkipEvictWaits.count(&pageMgr) || mSkipFlushWaits.count(&pageMgr);
     }
 
     /**
@@ -155,7 +193,7 @@ private:
      * @throws MemoryException on non-synchronous failure if canWait
      */
     void HandleMemory(const PageManager& pageMgr, const Page& page, 
-        bool canWait, UniqueLock& lock, const SharedLockW* mgrLock = nullptr);
+        bool canWait, const SharedLockW* mgrLock = nullptr);
 
     /**
      * Signals the flush thread and checks dirty memory
@@ -167,38 +205,28 @@ private:
      * @throws MemoryException on non-synchronous failure if canWait
      */
     void HandleDirtyMemory(const PageManager& pageMgr, const Page& page, 
-        bool canWait, UniqueLock& lock, const SharedLockW* mgrLock = nullptr);
-
-    /** 
-     * Inform us that a page was used, putting at the front of the LRU
-     * @param pageMgr the page manager that owns the page
-     * @param index the page manager page index
-     * @param page reference to the page
-     * @param dirty if true, consider dirty memory also
-     * @return size_t the size of the old page or 0 if it didn't exist
-     */
-    size_t EnqueuePage(PageManager& pageMgr, uint64_t index, const Page& page, bool dirty, const UniqueLock& lock);
-
-    /** 
-     * Inform us that a page has been erased (already have the lock) 
-     * @return size_t size of the page that was erased or 0 if it didn't exist
-     */
-    size_t RemovePage(const Page& page, const UniqueLock& lock);
-
-    /** Inform us that a page is no longer dirty (already have the lock) */
-    void RemoveDirty(const Page& page, const UniqueLock& lock);
+        bool canWait, const SharedLockW* mgrLock = nullptr);
 
     /** Send some stats about memory to debug */
-    void PrintStatus(const char* fname, const UniqueLock& lock);
+    void PrintStatus(const char* fname);
 
     /** Send some stats about the dirty memory to debug */
-    void PrintDirtyStatus(const char* fname, const UniqueLock& lock);
+    void PrintDirtyStatus(const char* fname);
+
+    /** Set of page managers that can skip evict/flush waiting */
+    using SkipSet = std::multiset<const PageManager*>;
 
     /**
      * Returns an exclusive lock for the given page manager, with deadlock avoidance
-     * @param waitPtr ref to mSkipEvictWait or mSkipFlushWait for deadlock avoidable
+     * @param skipSet ref to mSkipEvictWaits or mSkipFlushWaits for deadlock avoidance
+     */
+    SharedLockW GetPageManagerLock(PageManager& pageMgr, SkipSet& skipSet);
+
+    /** 
+     * Reads the memory pressure and updates mMemoryLimit
+     * Trims the allocator's free pool if the limit shrinks (evict thread only)
      */
-    SharedLockW GetPageManagerLock(PageManager& pageMgr, PageManager*& waitPtr);
+    void UpdateMemoryLimit();
 
     /** Run the page evict task in a loop while mRunCleanup */
     void EvictThread();
@@ -216,36 +244,49 @@ private:
      */
     inline void DoPageFlushes() noexcept;
 
+    /** Returns the time a page can stay dirty before it is flushed regardless of the dirty limit */
+    [[nodiscard]] inline std::chrono::milliseconds GetMaxDirtyAge() const { 
+        return mCacheOptions.maxDirtyTime * DIRTY_AGE_FACTOR; }
+
     /** 
      * Calls flush on a page and updates the bandwidth measurement
      * @throws BackendException for backend issues
      */
     void FlushPage(PageManager& pageMgr, uint64_t index, const SharedLockW& mgrLock);
 
+    /** 
+     * Locks the given page manager and flushes the given list of its pages
+     * @throws BackendException for backend issues
+     */
+    void FlushPageList(PageManager& pageMgr, const PageList& pages);
+
     mutable Debug mDebug;
 
-    /** Mutex to guard writing data structures */
+    /** Mutex to guard the cleanup threads' state and waiting (not the page bookkeeping) */
     mutable std::mutex mMutex;
 
-    using PageInfo = struct
-    {
-        /** Reference to the page manager owner of the page */
-        PageManager& mPageMgr;
-        /** Index of the page in the pageMgr */
-        const uint64_t mPageIndex;
-        /** Size of the page when it was added */
-        size_t mPageSize;
-    };
-
-    /** LIFO queue of pages for an LRU cache */
-    using PageQueue = OrderedMap<const Page*, PageInfo>;
+    /** The number of shards for page bookkeeping */
+    static constexpr size_t SHARD_COUNT { 16 };
+    /** Multiple of maxDirtyTime after which a dirty page is flushed regardless */
+    static constexpr int DIRTY_AGE_FACTOR { 10 };
+
+    /** How often to check the memory pressure (if enabled) */
+    static constexpr std::chrono::seconds PRESSURE_INTERVAL { 1 };
+    /** The PSI stall percent at or above which the memory limit is halved */
+    static constexpr double PRESSURE_HIGH { 10.0 };
+    /** The PSI averaging window (avg10) - the limit is halved at most once per window, as one stall stays in the average */
+    static constexpr std::chrono::seconds PRESSURE_WINDOW { 10 };
+    /** The PSI stall percent below which the memory limit grows back */
+    static constexpr double PRESSURE_LOW { 1.0 };
+    /** The memory limit never shrinks below memoryLimit/PRESSURE_MIN_FRAC, also the growth step */
+    static constexpr size_t PRESSURE_MIN_FRAC { 16 };
+    /** The fraction of the cgroup limit left free for everything else */
+    static constexpr uint64_t CGROUP_RESERVE_FRAC { 8 };
+
+    /** All pages and dirty pages, sharded by PageManager */
     PageQueue mPageQueue;
-    PageQueue mDirtyQueue;
-
-    // structures used in Page Evict/Flush
-    using PageList = std::list<std::pair<const Page&, PageInfo>>;
-    using LockedPageList = std::pair<ScopeLocked<PageManager>, PageList>;
-    using PageMgrPageMap = std::map<PageManager*, LockedPageList>;
+    /** Counters for all files (parent of each PageManager's) */
+    CacheStats mCacheStats;
 
     /** Set to false to stop the cleanup threads */
     std::atomic<bool> mRunCleanup { true };
@@ -264,21 +305,25 @@ private:
     /** CV to signal when dirty memory is available */
     std::condition_variable mFlushWaitCV;
 
-    /** PageManager that can skip the evict wait (need it to clear its lock queue) */
-    PageManager* mSkipEvictWait { nullptr };
-    /** PageManager that can skip the flush wait (need it to clear its lock queue) */
-    PageManager* mSkipFlushWait { nullptr };
+    /** PageManagers that can skip the evict wait (need it to clear its lock queue) */
+    SkipSet mSkipEvictWaits;
+    /** PageManagers that can skip the flush wait (need it to clear its lock queue) */
+    SkipSet mSkipFlushWaits;
 
     /** Reference to CacheOptions */
     const CacheOptions& mCacheOptions;
 
-    /** The current total memory usage */
-    size_t mCurrentTotal { 0 };
+    /** The effective memory limit (CacheOptions.memoryLimit unless memoryPressure) */
+    std::atomic<size_t> mMemoryLimit;
+    /** Memory pressure reader (null if disabled) */
+    std::unique_ptr<MemoryPressure> mMemoryPressure;
+    /** The memory limit based on PSI alone (evict thread only) */
+    size_t mPressureLimit;
+    /** The last time mPressureLimit was halved (evict thread only) */
+    std::optional<std::chrono::steady_clock::time_point> mPressureShrink;
 
     /** The maximum in-memory dirty page usage before flushing (dynamic) */
-    size_t mDirtyLimit { 0 };
-    /** The current total dirty page memory */
-    size_t mCurrentDirty { 0 };
+    std::atomic<size_t> mDirtyLimit { 0 };
 
     /** Exception encountered while evicting */
     std::exception_ptr mEvictFailure;
@@ -289,6 +334,10 @@ private:
     BandwidthMeasure mBandwidth;
     /** Allocator to use for all file pages (never null) */
     std::unique_ptr<CachingAllocator> mPageAllocator;
+    /** Persistent on-disk cache for evicted pages (null if disabled) */
+    std::unique_ptr<DiskCache> mDiskCache;
+    /** Compressed in-memory tier for evicted pages (null if disabled) */
+    std::unique_ptr<CompressedCache> mCompressedCache;
 };
 
 } // namespace Filedata
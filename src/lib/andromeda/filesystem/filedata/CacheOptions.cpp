@@ -20,7 +20,9 @@ std::string CacheOptions::HelpText()
 
     output << "Cache Advanced:  [--no-cachemgr] [--max-dirty ms(" << defDirty << ")]"
         << " [--memory-limit bytes"<<stBits<<"(" << StringUtil::bytesToString(optDefault.memoryLimit) << ")]"
-        << " [--evict-frac uint32(" << optDefault.evictSizeFrac << ")]";
+        << " [--evict-frac uint32(" << optDefault.evictSizeFrac << ")] [--evict-policy lru|arc] [--memory-pressure] [--huge-pages]" << std::endl
+        << "Disk Cache:      [--disk-cache path] [--disk-cache-limit bytes64(" << StringUtil::bytesToString(optDefault.diskCacheLimit) << ")]" << std::endl
+        << "Compressed Tier: [--compress-limit bytes"<<stBits<<"(0=disabled)]";
 
     return output.str();
 }
@@ -30,6 +32,10 @@ bool CacheOptions::AddFlag(const std::string& flag)
 {
     if (flag == "no-cachemgr")
         disable = true;
+    else if (flag == "memory-pressure")
+        memoryPressure = true;
+    else if (flag == "huge-pages")
+        hugePages = true;
     else return false; // not used
 
     return true;
@@ -58,6 +64,28 @@ bool CacheOptions::AddOption(const std::string& option, const std::string& value
 
         if (!evictSizeFrac) throw BaseOptions::BadValueException(option);
     }
+    else if (option == "evict-policy")
+    {
+        if      (value == "lru") evictType = EvictType::LRU;
+        else if (value == "arc") evictType = EvictType::ARC;
+        else throw BaseOptions::BadValueException(option);
+    }
+    else if (option == "disk-cache")
+    {
+        diskCachePath = value;
+    }
+    else if (option == "disk-cache-limit")
+    {
+        try { diskCacheLimit = StringUtil::stringToBytes(value); }
+        catch (const std::logic_error& e) { 
+            throw BaseOptions::BadValueException(option); }
+    }
+    else if (option == "compress-limit")
+    {
+        try { compressLimit = static_cast<size_t>(StringUtil::stringToBytes(value)); }
+        catch (const std::logic_error& e) { 
+            throw BaseOptions::BadValueException(option); }
+    }
     else return false; // not used
 
     return true; 
@@ -40,6 +40,19 @@ struct CacheOptions
      */
     uint32_t evictSizeFrac { 16 };
 
+    /** Page eviction policies */
+    enum class EvictType : uint8_t
+    {
+        /** least recently used */                  LRU,
+        /** adaptive replacement, scan-resistant */ ARC
+    };
+
+    /** 
+     * The policy for choosing which pages to evict
+     * ARC keeps pages that are used repeatedly when large files are read through once
+     */
+    EvictType evictType { EvictType::ARC };
+
     using milliseconds = std::chrono::milliseconds;
 
     /** 
@@ -49,6 +62,35 @@ struct CacheOptions
      */
     milliseconds maxDirtyTime { 1000 };
 
+    /** 
+     * The directory for the persistent on-disk page cache (empty to disable)
+     * Pages evicted from memory are stored here and re-used instead of downloading again,
+     * as long as the file has not changed on the backend. Can be shared between mounts.
+     */
+    std::string diskCachePath;
+
+    /** The maximum total size of the on-disk page cache (bytes) */
+    uint64_t diskCacheLimit { static_cast<uint64_t>(1024)*1024*1024 };
+
+    /** 
+     * The maximum total size of the compressed in-memory tier (bytes, 0 to disable)
+     * Clean pages evicted from memory are LZ4-compressed and kept here, so they can be
+     * decompressed instead of downloaded again. Separate from (in addition to) memoryLimit.
+     */
+    size_t compressLimit { 0 };
+
+    /** 
+     * True to adjust the memory limit to the system memory pressure (Linux PSI and cgroup limits)
+     * memoryLimit is then the maximum - the effective limit shrinks when memory is tight and grows back when not
+     */
+    bool memoryPressure { false };
+
+    /** 
+     * True to back the page cache with transparent huge pages (Linux), carving pages out of 2MB-aligned arenas
+     * Reduces TLB misses when copying data with large caches, but freed memory is only reclaimed lazily
+     */
+    bool hugePages { false };
+
     /** True to disable the CacheManager */
     bool disable { false };
 };
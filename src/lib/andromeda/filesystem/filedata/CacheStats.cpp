@@ -0,0 +1,86 @@
+
+#include "CacheStats.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+
+/*****************************************************/
+void CacheStats::AddEviction(const EvictReason reason, const bool unusedReadAhead)
+{
+    const size_t idx { static_cast<size_t>(reason) };
+    for (CacheStats* stats { this }; stats != nullptr; stats = stats->mParent)
+    {
+        stats->mEvictions[idx].fetch_add(1, std::memory_order_relaxed);
+        if (unusedReadAhead) stats->mReadAheadUnused.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/*****************************************************/
+void CacheStats::AddFlush(const uint64_t bytes, const Duration& time)
+{
+    const auto millis { static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(time).count()) };
+    size_t bucket { 0 }; // first bucket with millis < 2^bucket
+    while (bucket < LATENCY_BUCKETS-1 && millis >= (static_cast<uint64_t>(1) << bucket)) ++bucket;
+
+    for (CacheStats* stats { this }; stats != nullptr; stats = stats->mParent)
+    {
+        stats->mFlushCount.fetch_add(1, std::memory_order_relaxed);
+        stats->mFlushBytes.fetch_add(bytes, std::memory_order_relaxed);
+        stats->mFlushLatency[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/*****************************************************/
+CacheStats::Values CacheStats::GetValues() const
+{
+    Values values;
+    values.pageHits = mPageHits.load();
+    values.pageMisses = mPageMisses.load();
+    values.pendingWaits = mPendingWaits.load();
+    values.pagesFetched = mPagesFetched.load();
+    values.readAheadUsed = mReadAheadUsed.load();
+    values.readAheadUnused = mReadAheadUnused.load();
+    values.readAheadCancelled = mReadAheadCancelled.load();
+    for (size_t i { 0 }; i < mEvictions.size(); ++i)
+        values.evictions[i] = mEvictions[i].load();
+    values.flushCount = mFlushCount.load();
+    values.flushBytes = mFlushBytes.load();
+    for (size_t i { 0 }; i < mFlushLatency.size(); ++i)
+        values.flushLatency[i] = mFlushLatency[i].load();
+    values.memoryWaitTime = mMemoryWaitTime.load();
+    values.dirtyWaitTime = mDirtyWaitTime.load();
+    return values;
+}
+
+/*****************************************************/
+void CacheStats::Print(std::ostream& out, const Values& values)
+{
+    const uint64_t reads { values.pageHits + values.pageMisses + values.pendingWaits };
+    out << "reads: " << reads << " (hits:" << values.pageHits
+        << " misses:" << values.pageMisses << " pendingWaits:" << values.pendingWaits << ")";
+    if (reads) out << " hitRate:" << (values.pageHits*100/reads) << "%";
+
+    out << ", fetched: " << values.pagesFetched << " (readAheadUsed:" << values.readAheadUsed
+        << " readAheadUnused:" << values.readAheadUnused << " readAheadCancelled:" << values.readAheadCancelled << ")";
+
+    out << ", evictions: (memory:" << values.evictions[static_cast<size_t>(EvictReason::MEMORY)]
+        << " changed:" << values.evictions[static_cast<size_t>(EvictReason::CHANGED)]
+        << " truncate:" << values.evictions[static_cast<size_t>(EvictReason::TRUNCATE)] << ")";
+
+    out << ", flushes: " << values.flushCount << " (" << values.flushBytes << " bytes) latency:";
+    for (size_t i { 0 }; i < LATENCY_BUCKETS; ++i)
+    {
+        if (!values.flushLatency[i]) continue;
+        if (i < LATENCY_BUCKETS-1) out << " <" << (static_cast<uint64_t>(1) << i) << "ms:";
+        else out << " >=" << (static_cast<uint64_t>(1) << (i-1)) << "ms:";
+        out << values.flushLatency[i];
+    }
+
+    out << ", waits: (memory:" << values.memoryWaitTime/1000
+        << "ms dirty:" << values.dirtyWaitTime/1000 << "ms)";
+}
+
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
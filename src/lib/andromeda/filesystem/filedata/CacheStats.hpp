@@ -0,0 +1,142 @@
+
+#ifndef LIBA2_CACHESTATS_H_
+#define LIBA2_CACHESTATS_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+#include "andromeda/common.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+
+/**
+ * Counters about cache effectiveness, for tuning e.g. readAheadTime, pageSize and memoryLimit
+ * Each PageManager has its own (per-file) that also counts in its parent, the CacheManager's (whole cache)
+ * THREAD SAFE (atomic counters)
+ */
+class CacheStats
+{
+public:
+
+    /** The reason a page was dropped from the cache */
+    enum class EvictReason : uint8_t
+    {
+        /** over the memory limit (CacheManager) */   MEMORY,
+        /** the file changed on the backend */        CHANGED,
+        /** the file was truncated */                 TRUNCATE,
+        /** the number of reasons */                  NUM_REASONS
+    };
+
+    /** The number of flush latency histogram buckets - bucket N counts flushes under 2^N ms, the last is the rest */
+    static constexpr size_t LATENCY_BUCKETS { 12 };
+
+    /** A copy of all counters */
+    struct Values
+    {
+        /** Page reads that found the page in memory */
+        uint64_t pageHits { 0 };
+        /** Page reads that had to start a fetch */
+        uint64_t pageMisses { 0 };
+        /** Page reads that waited on a fetch already in progress (read-ahead) */
+        uint64_t pendingWaits { 0 };
+        /** Pages added from the backend or disk cache */
+        uint64_t pagesFetched { 0 };
+        /** Read-ahead pages that were later read */
+        uint64_t readAheadUsed { 0 };
+        /** Read-ahead pages that were dropped without ever being read */
+        uint64_t readAheadUnused { 0 };
+        /** Read-ahead pages whose fetch was cancelled as the reader jumped away */
+        uint64_t readAheadCancelled { 0 };
+        /** Pages dropped from the cache, by EvictReason */
+        std::array<uint64_t, static_cast<size_t>(EvictReason::NUM_REASONS)> evictions {};
+        /** The number of flushes (consecutive page lists) written */
+        uint64_t flushCount { 0 };
+        /** The total bytes of dirty pages written */
+        uint64_t flushBytes { 0 };
+        /** Histogram of flush latencies (see LATENCY_BUCKETS) */
+        std::array<uint64_t, LATENCY_BUCKETS> flushLatency {};
+        /** Total time writers were blocked waiting for memory (microseconds) */
+        uint64_t memoryWaitTime { 0 };
+        /** Total time writers were blocked waiting for dirty memory (microseconds) */
+        uint64_t dirtyWaitTime { 0 };
+    };
+
+    /** @param parent stats to also count everything in (or nullptr) */
+    explicit CacheStats(CacheStats* parent = nullptr) : mParent(parent) { }
+
+    virtual ~CacheStats() = default;
+    DELETE_COPY(CacheStats)
+    DELETE_MOVE(CacheStats)
+
+    using Duration = std::chrono::steady_clock::duration;
+
+    /** Counts a page read that found the page */
+    inline void AddHit() { Add(&CacheStats::mPageHits, 1); }
+    /** Counts a page read that started a fetch */
+    inline void AddMiss() { Add(&CacheStats::mPageMisses, 1); }
+    /** Counts a page read that waited on a pending fetch */
+    inline void AddPendingWait() { Add(&CacheStats::mPendingWaits, 1); }
+    /** Counts a page added by a fetch */
+    inline void AddFetched() { Add(&CacheStats::mPagesFetched, 1); }
+    /** Counts a read-ahead page being read for the first time */
+    inline void AddReadAheadUsed() { Add(&CacheStats::mReadAheadUsed, 1); }
+    /** Counts the given number of read-ahead pages not fetched due to cancellation */
+    inline void AddReadAheadCancelled(const uint64_t pages) { Add(&CacheStats::mReadAheadCancelled, pages); }
+    /** Counts a page being dropped, and whether it was read-ahead and never read */
+    void AddEviction(EvictReason reason, bool unusedReadAhead);
+    /** Counts a flush of the given bytes that took the given time */
+    void AddFlush(uint64_t bytes, const Duration& time);
+    /** Counts time spent blocked on memory */
+    inline void AddMemoryWait(const Duration& time) { Add(&CacheStats::mMemoryWaitTime, ToMicros(time)); }
+    /** Counts time spent blocked on dirty memory */
+    inline void AddDirtyWait(const Duration& time) { Add(&CacheStats::mDirtyWaitTime, ToMicros(time)); }
+
+    /** Returns a copy of all counters (each read atomically, not all together) */
+    [[nodiscard]] Values GetValues() const;
+
+    /** Prints the given values in a human-readable form */
+    static void Print(std::ostream& out, const Values& values);
+
+private:
+
+    using Counter = std::atomic<uint64_t>;
+
+    /** Adds the given amount to the given counter and the parent's */
+    inline void Add(Counter CacheStats::* counter, const uint64_t amount)
+    {
+        for (CacheStats* stats { this }; stats != nullptr; stats = stats->mParent)
+            (stats->*counter).fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    /** Returns the given duration in microseconds */
+    static inline uint64_t ToMicros(const Duration& time) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(time).count()); }
+
+    /** Stats to also count everything in (or nullptr) */
+    CacheStats* const mParent;
+
+    Counter mPageHits { 0 };
+    Counter mPageMisses { 0 };
+    Counter mPendingWaits { 0 };
+    Counter mPagesFetched { 0 };
+    Counter mReadAheadUsed { 0 };
+    Counter mReadAheadUnused { 0 };
+    Counter mReadAheadCancelled { 0 };
+    std::array<Counter, static_cast<size_t>(EvictReason::NUM_REASONS)> mEvictions {};
+    Counter mFlushCount { 0 };
+    Counter mFlushBytes { 0 };
+    std::array<Counter, LATENCY_BUCKETS> mFlushLatency {};
+    Counter mMemoryWaitTime { 0 };
+    Counter mDirtyWaitTime { 0 };
+};
+
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
+
+#endif // LIBA2_CACHESTATS_H_
@@ -1,6 +1,8 @@
 
 #include <cassert>
 #include <cstring>
+#include <functional>
+#include <thread>
 
 #include "CachingAllocator.hpp"
 #include "andromeda/Debug.hpp"
@@ -10,70 +12,113 @@ namespace Filesystem {
 namespace Filedata {
 
 /*****************************************************/
-CachingAllocator::CachingAllocator(const size_t baseline) : 
-    mDebug(__func__,this), mBaseline(baseline) { }
+CachingAllocator::CachingAllocator(const size_t baseline, const bool hugePages) : 
+    MemoryAllocator(hugePages), mDebug(__func__,this), mBaseline(baseline) { }
 
 /*****************************************************/
 CachingAllocator::~CachingAllocator()
 {
+    for (MagazineShard& shard : mShards)
+        for (const decltype(shard.mMagazines)::value_type& pair : shard.mMagazines)
+            for (void* ptr : pair.second)
+                MemoryAllocator::free(ptr, pair.first);
+
     for (const FreeListMap::value_type& pair : mFreeLists)
         for (void* ptr : pair.second)
             MemoryAllocator::free(ptr, pair.first);
 }
 
-// FreeList: when freed, a page goes onto the front of the list for that alloc size
+/*****************************************************/
+size_t CachingAllocator::GetClassPages(const size_t pages)
+{
+    if (pages <= EXACT_CLASS_PAGES) return pages;
+
+    // 4 classes per power of two, i.e. round up to a multiple of 1/4 the previous power of two
+    size_t log2 { 0 }; for (size_t val { pages-1 }; val >>= 1; ) ++log2;
+    const size_t step { static_cast<size_t>(1) << (log2-2) };
+    return (pages + step-1) & ~(step-1);
+}
+
+/*****************************************************/
+CachingAllocator::MagazineShard& CachingAllocator::GetShard()
+{
+    // each thread sticks to one shard so its alloc/free pairs stay local
+    static thread_local const size_t threadHash { std::hash<std::thread::id>()(std::this_thread::get_id()) };
+    return mShards[threadHash % MAGAZINE_SHARDS];
+}
+
+/*****************************************************/
+size_t CachingAllocator::GetMaxFree() const
+{
+    return mMaxAlloc.load() - mBaseline;
+}
+
+// Magazines: when freed, a page goes onto the back of its thread's magazine for that size class
+// the magazine allows quick re-alloc under only the shard lock (LIFO, the memory is likely still hot)
+// FreeList: when a magazine overflows, half of it goes onto the front of the depot list for that size
 // the FreeList allows quick re-alloc by looking up the alloc size then taking the first entry (LIFO)
-// FreeQueue: when freed, a page goes onto the front of the free queue
+// FreeQueue: when added to the depot, a page goes onto the front of the free queue
 // the FreeQueue allows quick cleanup by popping a free off the end of the list (FIFO)
 
 /*****************************************************/
 void* CachingAllocator::alloc(size_t pages)
 {
+    pages = GetClassPages(pages);
     MDBG_INFO("(pages:" << pages << " bytes:" << pages*mPageSize << ")");
     if (!pages) return nullptr;
 
+    ++mAllocs; // total
+    const size_t curAlloc { mCurAlloc += pages*mPageSize };
+    size_t maxAlloc { mMaxAlloc.load() };
+    while (curAlloc > maxAlloc && !mMaxAlloc.compare_exchange_weak(maxAlloc, curAlloc)) { }
+
+    MDBG_INFO("... mBaseline:" << mBaseline 
+        << " mCurAlloc:" << curAlloc << " mMaxAlloc:" << mMaxAlloc.load());
+
     { // lock scope
-        const LockGuard lock(mMutex);
-        ++mAllocs; // total
-        mCurAlloc += pages*mPageSize;
-        mMaxAlloc = std::max(mCurAlloc, mMaxAlloc);
+        MagazineShard& shard { GetShard() };
+        const LockGuard shardLock(shard.mMutex);
+        Magazine& magazine { shard.mMagazines[pages] };
 
-        MDBG_INFO("... mBaseline:" << mBaseline 
-            << " mCurAlloc:" << mCurAlloc << " mMaxAlloc:" << mMaxAlloc);
+        void* ptr { nullptr };
+        if (!magazine.empty())
+        {
+            ptr = magazine.back();
+            magazine.pop_back();
+            ++mMagazineHits;
+        }
+        else // refill the magazine from the depot in one batch
+        {
+            const LockGuard lock(mMutex);
+            ptr = depot_alloc(pages, lock);
+
+            const FreeListMap::iterator fmIt { mFreeLists.find(pages) };
+            if (ptr != nullptr && fmIt != mFreeLists.end())
+            {
+                FreeList& freeList { fmIt->second };
+                while (!freeList.empty() && magazine.size() < MAGAZINE_SIZE/2)
+                {
+                    magazine.push_back(freeList.front());
+                    mFreeQueue.erase(freeList.front());
+                    freeList.pop_front();
+                }
 
-        FreeListMap::iterator fmIt { mFreeLists.lower_bound(pages) };
-        if (fmIt != mFreeLists.end())
+                // never have an empty list!
+                if (freeList.empty())
+                    mFreeLists.erase(fmIt);
+            }
+        }
+
+        if (ptr != nullptr)
         {
-            FreeList& freeList { fmIt->second };
-            void* const ptr = freeList.front();
 #if DEBUG // sanity checks
-            assert(fmIt->first >= pages); // lower_bound
             std::memset(ptr, 0x55, pages*mPageSize); // poison
 #endif // DEBUG
-
-            freeList.pop_front();
-            mFreeQueue.erase(ptr);
             mCurFree -= pages*mPageSize;
             ++mRecycles;
 
-            MDBG_INFO("... recycle ptr:" << ptr << " pages:" << fmIt->first
-                << " recycles:" << mRecycles << "/" << mAllocs);
-            MDBG_INFO("... from freeList:" << pages << ":" << freeList.size() 
-                << " mCurFree:" << mCurFree);
-            
-            if (fmIt->first != pages) // only used part of the alloc
-            {
-                void* const newPtr { static_cast<uint8_t*>(ptr) + pages*mPageSize };
-                const size_t newPages { fmIt->first - pages };
-                const size_t newListSize { add_entry(newPtr, newPages, lock) };
-
-                MDBG_INFO("... partial alloc: newPtr:" << newPtr
-                    << " new freeList:" << newPages << ":" << newListSize);
-            }
-
-            // never have an empty list!
-            if (freeList.empty())
-                mFreeLists.erase(fmIt);
+            MDBG_INFO("... recycle ptr:" << ptr << " recycles:" << mRecycles << "/" << mAllocs
+                << " magazine:" << pages << ":" << magazine.size() << " mCurFree:" << mCurFree);
             return ptr;
         }
     }
@@ -90,23 +135,106 @@ void* CachingAllocator::alloc(size_t pages)
 /*****************************************************/
 void CachingAllocator::free(void* const ptr, size_t pages)
 {
+    pages = GetClassPages(pages);
     MDBG_INFO("(ptr:" << ptr << " pages:" << pages << " bytes:" << pages*mPageSize << ")");
     if (ptr == nullptr || !pages) return;
 
-    const LockGuard lock(mMutex);
-    const size_t freeListSize { add_entry(ptr, pages, lock) };
 #if DEBUG // sanity checks
     std::memset(ptr, 0xAA, pages*mPageSize); // poison
     assert(pages*mPageSize <= mCurAlloc);
 #endif // DEBUG
 
-    mCurFree += pages*mPageSize;
     mCurAlloc -= pages*mPageSize;
+    const size_t curFree { mCurFree += pages*mPageSize };
+    const size_t maxFree { GetMaxFree() };
+
+    MagazineShard& shard { GetShard() };
+    const LockGuard shardLock(shard.mMutex);
+    Magazine& magazine { shard.mMagazines[pages] };
+    magazine.push_back(ptr);
+
+    MDBG_INFO("... to magazine:" << pages << ":" << magazine.size()
+        << " mCurFree:" << curFree << " mCurAlloc:" << mCurAlloc);
+
+    const bool overFree { curFree > maxFree };
+    if (magazine.size() > MAGAZINE_SIZE || overFree)
+    {
+        // return the oldest half to the depot in one batch, or all if over the limit
+        const LockGuard lock(mMutex);
+        depot_return(magazine, pages, overFree ? 0 : MAGAZINE_SIZE/2, lock);
+
+        while (mCurFree > GetMaxFree() && !mFreeQueue.empty()) clean_entry(lock);
+    }
+}
+
+/*****************************************************/
+size_t CachingAllocator::Trim(const size_t maxFree)
+{
+    const size_t oldFree { mCurFree.load() };
+
+    for (MagazineShard& shard : mShards)
+    {
+        const LockGuard shardLock(shard.mMutex);
+        const LockGuard lock(mMutex);
+        for (decltype(shard.mMagazines)::value_type& pair : shard.mMagazines)
+            depot_return(pair.second, pair.first, 0, lock);
+    }
+
+    const LockGuard lock(mMutex);
+    while (mCurFree > maxFree && !mFreeQueue.empty()) clean_entry(lock);
+
+    const size_t curFree { mCurFree.load() };
+    const size_t freed { (oldFree > curFree) ? oldFree-curFree : 0 };
+    MDBG_INFO("(maxFree:" << maxFree << ") freed:" << freed);
+    return freed;
+}
+
+/*****************************************************/
+void* CachingAllocator::depot_alloc(const size_t pages, const LockGuard& lock)
+{
+    const FreeListMap::iterator fmIt { mFreeLists.lower_bound(pages) };
+    if (fmIt == mFreeLists.end()) return nullptr;
+
+    FreeList& freeList { fmIt->second };
+    void* const ptr = freeList.front();
+#if DEBUG // sanity checks
+    assert(fmIt->first >= pages); // lower_bound
+#endif // DEBUG
+
+    freeList.pop_front();
+    mFreeQueue.erase(ptr);
+
+    MDBG_INFO("... from freeList:" << fmIt->first << ":" << freeList.size());
+
+    if (fmIt->first != pages) // only used part of the alloc
+    {
+        void* const newPtr { static_cast<uint8_t*>(ptr) + pages*mPageSize };
+        const size_t newPages { fmIt->first - pages };
+        const size_t newListSize { add_entry(newPtr, newPages, lock) };
+
+        MDBG_INFO("... partial alloc: newPtr:" << newPtr
+            << " new freeList:" << newPages << ":" << newListSize);
+    }
+
+    // never have an empty list!
+    if (freeList.empty())
+        mFreeLists.erase(fmIt);
+    return ptr;
+}
+
+/*****************************************************/
+void CachingAllocator::depot_return(Magazine& magazine, const size_t pages, const size_t keep, const LockGuard& lock) noexcept
+{
+    if (magazine.size() <= keep) return;
 
-    MDBG_INFO("... to freeList:" << pages << ":" << freeListSize
-        << " freeQueue:" << mFreeQueue.size() << " mCurFree:" << mCurFree << " mCurAlloc:" << mCurAlloc);
+    // the front of the magazine is the least recently freed
+    const size_t count { magazine.size() - keep };
+    for (size_t i { 0 }; i < count; ++i)
+        add_entry(magazine[i], pages, lock);
+    magazine.erase(magazine.begin(), magazine.begin() + static_cast<Magazine::difference_type>(count));
 
-    while (mCurFree > mMaxAlloc-mBaseline) clean_entry(lock);
+    MDBG_INFO("... returned " << count << " to freeList:" << pages 
+        << " freeQueue:" << mFreeQueue.size());
 }
 
 /*****************************************************/
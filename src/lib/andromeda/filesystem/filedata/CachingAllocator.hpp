@@ -1,12 +1,14 @@
-
 #ifndef LIBA2_CACHINGALLOCATOR_H_
 #define LIBA2_CACHINGALLOCATOR_H_
 
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <list>
 #include <map>
 #include <mutex>
 #include <utility>
+#include <vector>
 
 #include "MemoryAllocator.hpp"
 #include "andromeda/common.hpp"
@@ -18,11 +20,15 @@ namespace Filesystem {
 namespace Filedata {
 
 /**
- * Adds a very basic allocation-caching layer on top of MemoryAllocator.
- * When an allocation is free()d, it is added to a list to be re-used in a later alloc(). 
- * When the maximum free pool size is exceeded, allocations are removed and returned the OS smallest first.
- * NOTE 1) memory is allocated only at page size granularity.  Use get_usage() to determine the actual memory size of an allocation.
- * NOTE 2) allocations are only re-used if they are the exact size of a previously freed allocation.
+ * Adds an allocation-caching layer on top of MemoryAllocator.
+ * Allocations are rounded up to a size class (exact up to EXACT_CLASS_PAGES, then 4 classes per power of two)
+ * so that mixed sizes (tail pages, resizes) can re-use each other's memory with at most 25% waste.
+ * When an allocation is free()d, it goes to a small per-size-class magazine for the calling thread's
+ * magazine shard, so most alloc/free pairs only take an uncontended shard lock.  Full magazines are
+ * returned in batches to the shared depot, which is an LRU free pool.  When the maximum free pool size is
+ * exceeded, allocations are removed from the depot and returned to the OS oldest first.
+ * NOTE 1) memory is allocated only at size class granularity.  Use getAllocPages() to determine the actual memory size of an allocation.
+ * NOTE 2) free() must be given the same size that was given to alloc() - partial frees are not allowed
  * ... these make this a bad general allocator, but good for allocating filedata pages that are mostly constant per-filesystem.
  * THREAD SAFE (INTERNAL LOCKS)
  */
@@ -30,27 +36,49 @@ class CachingAllocator : public MemoryAllocator
 {
 public:
 
-    /** @param baseline the amount of memory used when evict stops, used to calculate the free pool max size */
-    explicit CachingAllocator(size_t baseline);
+    /** Sizes up to this many pages each have their own size class */
+    static constexpr size_t EXACT_CLASS_PAGES { 8 };
+    /** The number of magazine shards (threads are spread across them) */
+    static constexpr size_t MAGAZINE_SHARDS { 8 };
+    /** The maximum number of allocations kept in a magazine before half are returned to the depot */
+    static constexpr size_t MAGAZINE_SIZE { 16 };
+
+    /** 
+     * @param baseline the amount of memory used when evict stops, used to calculate the free pool max size 
+     * @param hugePages if true, use transparent huge page arenas (see MemoryAllocator)
+     */
+    explicit CachingAllocator(size_t baseline, bool hugePages = false);
 
     ~CachingAllocator() override;
     DELETE_COPY(CachingAllocator)
     DELETE_MOVE(CachingAllocator)
 
+    /** Returns the number of pages in the size class that holds the given number of pages */
+    [[nodiscard]] static size_t GetClassPages(size_t pages);
+
+    /** Returns the number of pages actually allocated to hold the given number of bytes (size class granularity) */
+    [[nodiscard]] inline size_t getAllocPages(const size_t bytes) const {
+        return GetClassPages(getNumPages(bytes)); }
+
     /** 
-     * Allocate the given number of pages and return a pointer
+     * Allocate the given number of pages (rounded up to a size class) and return a pointer
      * Returns a recycled (previously freed) pointer if possible
      */
     void* alloc(size_t pages) override;
 
     /**
-     * Frees a range of pages allocated by alloc() - partial frees are allowed
-     * Also adds the allocation to the free list and does cleanup.
-     * @param ptr the pointer to free (must be aligned to a page boundary)
-     * @param pages the number of pages to free
+     * Frees an allocation from alloc() and adds it to the free pool, doing cleanup if needed
+     * @param ptr the pointer to free (must be from alloc())
+     * @param pages the number of pages given to alloc()
      */
     void free(void* ptr, size_t pages) override;
 
+    /**
+     * Returns freed allocations to the OS until the free pool is at most the given size
+     * @return the number of bytes returned to the OS
+     */
+    size_t Trim(size_t maxFree);
+
     /** A copy of some member variables for debugging */
     struct Stats
     { 
@@ -58,29 +86,59 @@ public:
         size_t maxAlloc; 
         size_t curFree; 
         uint64_t recycles; 
+        uint64_t magazineHits;
         uint64_t allocs;
     };
     /** Returns a copy of some member variables for debugging */
     inline Stats GetStats() const
     { 
-        const LockGuard lock(mMutex); 
-        return { mCurAlloc, mMaxAlloc, mCurFree, mRecycles, mAllocs }; 
+        return { mCurAlloc.load(), mMaxAlloc.load(), mCurFree.load(), 
+            mRecycles.load(), mMagazineHits.load(), mAllocs.load() }; 
     }
 
 private:
 
     using LockGuard = std::lock_guard<std::mutex>;
 
+    /** A list of free allocations of one size class, most recently freed last */
+    using Magazine = std::vector<void*>;
+
+    /** A set of per-size-class magazines and the lock protecting them */
+    struct MagazineShard
+    {
+        std::mutex mMutex;
+        std::map<size_t, Magazine> mMagazines;
+    };
+
+    /** Returns the magazine shard to use for the calling thread */
+    MagazineShard& GetShard();
+
+    /** Returns the current maximum size of the free pool */
+    [[nodiscard]] size_t GetMaxFree() const;
+
+    /** 
+     * Takes an allocation of at least the given pages from the depot, splitting a larger one if needed
+     * @return the pointer or nullptr if none are available
+     */
+    void* depot_alloc(size_t pages, const LockGuard& lock);
+
+    /** 
+     * Moves allocations from the given magazine into the depot until it has the given number left
+     * @param pages the size class of the magazine
+     */
+    void depot_return(Magazine& magazine, size_t pages, size_t keep, const LockGuard& lock) noexcept;
+
     /** 
      * Adds an entry to the appropriate freeList and FreeQueue
      * @return the resulting size of the free list aded to
      */
     size_t add_entry(void* ptr, size_t pages, const LockGuard& lock) noexcept;
 
-    /** Removes and returns to the OS the smallest freed allocation */
+    /** Removes and returns to the OS the oldest freed allocation in the depot */
     void clean_entry(const LockGuard& lock);
 
     mutable Debug mDebug;
+    /** Mutex that protects the depot (free lists/queue) */
     mutable std::mutex mMutex;
 
     // the maximum size of the free pool is (mMaxAlloc-mBaseline)
@@ -91,17 +149,22 @@ private:
     /** The amount of memory used when evict stops */
     const size_t mBaseline;
     /** Current total memory allocated */
-    size_t mCurAlloc { 0 };
+    std::atomic<size_t> mCurAlloc { 0 };
     /** Peak total memory allocated */
-    size_t mMaxAlloc { 0 };
+    std::atomic<size_t> mMaxAlloc { 0 };
 
-    /** The current size (bytes) of the free pool */
-    size_t mCurFree { 0 };
+    /** The current size (bytes) of the free pool (magazines + depot) */
+    std::atomic<size_t> mCurFree { 0 };
 
     /** The number of times an allocation was re-used (debug) */
-    uint64_t mRecycles { 0 };
+    std::atomic<uint64_t> mRecycles { 0 };
+    /** The number of re-uses that came straight from a magazine (debug) */
+    std::atomic<uint64_t> mMagazineHits { 0 };
     /** The total number of calls to alloc() (debug) */
-    uint64_t mAllocs { 0 };
+    std::atomic<uint64_t> mAllocs { 0 };
+
+    /** Per-thread-ish magazines of recently freed allocations */
+    std::array<MagazineShard, MAGAZINE_SHARDS> mShards;
 
     /** List of freed allocations that can be re-used */
     using FreeList = std::list<void*>;
@@ -128,13 +191,13 @@ template <typename T> struct CachingAllocatorT
 
     inline T* allocate(const size_t n)
     {
-        const size_t pages { mAlloc.getNumPages(n*sizeof(T)) };
+        const size_t pages { mAlloc.getAllocPages(n*sizeof(T)) };
         return static_cast<T* const>(mAlloc.alloc(pages));
     }
 
     inline void deallocate(T* const p, const size_t b)
     {
-        const size_t pages { mAlloc.getNumPages(b) };
+        const size_t pages { mAlloc.getAllocPages(b*sizeof(T)) };
         mAlloc.free(static_cast<void* const>(p), pages);
     }
 };
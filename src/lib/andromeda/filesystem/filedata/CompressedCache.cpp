@@ -0,0 +1,143 @@
+
+#include <utility>
+
+#if HAVE_LZ4
+#include <lz4.h>
+#endif // HAVE_LZ4
+
+#include "CompressedCache.hpp"
+#include "Page.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+
+/*****************************************************/
+bool CompressedCache::isSupported()
+{
+#if HAVE_LZ4
+    return true;
+#else // !HAVE_LZ4
+    return false;
+#endif // HAVE_LZ4
+}
+
+/*****************************************************/
+CompressedCache::CompressedCache(const size_t sizeLimit) :
+    mSizeLimit(sizeLimit),
+    mDebug(__func__,this)
+{
+    MDBG_INFO("(sizeLimit:" << sizeLimit << ")");
+}
+
+/*****************************************************/
+std::string CompressedCache::GetEntryName(const std::string& fileID, const uint64_t index)
+{
+    return fileID + "/" + std::to_string(index);
+}
+
+/*****************************************************/
+bool CompressedCache::PopEntry(const std::string& name, Entry& entry, const UniqueLock& lock)
+{
+    if (!mEntries.pop(name, entry)) return false;
+
+    mCurrentTotal -= entry.data.size();
+    mCurrentRaw -= entry.dataSize;
+    return true;
+}
+
+/*****************************************************/
+bool CompressedCache::Contains(const std::string& fileID, const uint64_t index) const
+{
+    const UniqueLock lock(mMutex);
+    return mEntries.exists(GetEntryName(fileID, index));
+}
+
+/*****************************************************/
+bool CompressedCache::Load(const Version& version, const uint64_t index, Page& page)
+{
+    const std::string name { GetEntryName(version.fileID, index) };
+
+    Entry entry; // the page moves back to the page cache, don't keep a copy
+    { const UniqueLock lock(mMutex);
+        if (!PopEntry(name, entry, lock)) { ++mMisses; return false; } }
+
+    MDBG_INFO("(name:" << name << ")");
+
+    bool valid { entry.backendSize == version.backendSize && entry.modified == version.modified &&
+        entry.pageSize == version.pageSize && entry.dataSize <= version.pageSize };
+
+#if HAVE_LZ4
+    if (valid)
+    {
+        page.resize(entry.dataSize);
+        valid = LZ4_decompress_safe(entry.data.data(), page.data(), static_cast<int>(entry.data.size()),
+            static_cast<int>(entry.dataSize)) == static_cast<int>(entry.dataSize);
+    }
+#else // !HAVE_LZ4
+    valid = false;
+#endif // HAVE_LZ4
+
+    const UniqueLock lock(mMutex);
+    if (!valid)
+    {
+        MDBG_INFO("... stale or corrupt entry, removed");
+        ++mMisses; return false;
+    }
+
+    ++mHits; return true;
+}
+
+/*****************************************************/
+bool CompressedCache::Store(const Version& version, const uint64_t index, const Page& page)
+{
+    const std::string name { GetEntryName(version.fileID, index) };
+    const size_t dataSize { page.size() };
+    Entry entry { version.backendSize, version.modified, version.pageSize, dataSize, {} };
+
+#if HAVE_LZ4
+    const size_t maxSize { dataSize - dataSize/MIN_SAVINGS_FRAC };
+    entry.data.resize(maxSize);
+    const int compSize { (dataSize && maxSize) ? LZ4_compress_default(page.data(), entry.data.data(), 
+        static_cast<int>(dataSize), static_cast<int>(maxSize)) : 0 };
+    entry.data.resize(static_cast<size_t>(compSize));
+    entry.data.shrink_to_fit();
+#else // !HAVE_LZ4
+    const int compSize { 0 };
+#endif // HAVE_LZ4
+
+    const UniqueLock lock(mMutex);
+
+    Entry oldEntry; PopEntry(name, oldEntry, lock); // replace any old version
+
+    if (compSize <= 0 || entry.data.size() > mSizeLimit) // did not fit in maxSize
+    {
+        MDBG_INFO("(name:" << name << ") incompressible, size:" << dataSize);
+        ++mRejected; return false;
+    }
+
+    MDBG_INFO("(name:" << name << " size:" << dataSize << " compressed:" << entry.data.size() << ")");
+
+    mCurrentTotal += entry.data.size();
+    mCurrentRaw += dataSize;
+    mEntries.enqueue_front(name, std::move(entry));
+
+    while (mCurrentTotal > mSizeLimit) // drop least recently stored
+    {
+        const std::string oldName { mEntries.back().first }; // copy
+        MDBG_INFO("... evicting " << oldName);
+        PopEntry(oldName, oldEntry, lock);
+    }
+    return true;
+}
+
+/*****************************************************/
+CompressedCache::Stats CompressedCache::GetStats() const
+{
+    const UniqueLock lock(mMutex);
+    return { mCurrentTotal, mCurrentRaw, mEntries.size(), mHits, mMisses, mRejected };
+}
+
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
@@ -0,0 +1,134 @@
+
+#ifndef LIBA2_COMPRESSEDCACHE_H_
+#define LIBA2_COMPRESSEDCACHE_H_
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "DiskCache.hpp"
+#include "andromeda/common.hpp"
+#include "andromeda/Debug.hpp"
+#include "andromeda/OrderedMap.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+
+class Page;
+
+/**
+ * An in-memory LZ4-compressed tier for clean pages evicted from the page cache
+ * Pages are compressed on eviction and decompressed (and removed from this tier) on the next read,
+ * which is far cheaper than fetching them from the backend again. Entries are keyed and versioned
+ * the same way as DiskCache - a mismatching entry is rejected and deleted. Pages that do not
+ * compress to at least MIN_SAVINGS_FRAC smaller are not stored. The total size of the compressed
+ * data is limited by dropping the least recently stored entries.
+ * Only available if built with liblz4, see isSupported()
+ * THREAD SAFE (INTERNAL LOCKS)
+ */
+class CompressedCache
+{
+public:
+
+    using Version = DiskCache::Version;
+
+    /** Pages must compress to at most (1 - 1/MIN_SAVINGS_FRAC) of their size to be stored */
+    static constexpr size_t MIN_SAVINGS_FRAC { 8 };
+
+    /** Returns true if compression is supported (built with liblz4) */
+    [[nodiscard]] static bool isSupported();
+
+    /** @param sizeLimit the maximum total size of the compressed data */
+    explicit CompressedCache(size_t sizeLimit);
+
+    virtual ~CompressedCache() = default;
+    DELETE_COPY(CompressedCache)
+    DELETE_MOVE(CompressedCache)
+
+    /** Returns true if a page for the given file/index is stored (any version) */
+    [[nodiscard]] bool Contains(const std::string& fileID, uint64_t index) const;
+
+    /**
+     * Decompresses and removes the page at the given index if stored with the given version
+     * @param[out] page the page to resize and fill with the data
+     * @return true if the page was loaded, false if missing or stale
+     */
+    bool Load(const Version& version, uint64_t index, Page& page);
+
+    /** 
+     * Compresses and stores the given page at the given index with the given version, replacing any old entry
+     * @return true if stored, false if the page did not compress well enough
+     */
+    bool Store(const Version& version, uint64_t index, const Page& page);
+
+    /** Stats about the cache for debugging */
+    struct Stats
+    {
+        /** The total size of all compressed entries */
+        size_t currentTotal;
+        /** The total uncompressed size of all entries */
+        size_t currentRaw;
+        /** The number of entries */
+        size_t entries;
+        /** The total number of successful Load() calls */
+        uint64_t hits;
+        /** The total number of failed Load() calls */
+        uint64_t misses;
+        /** The total number of pages not stored because they did not compress */
+        uint64_t rejected;
+    };
+    /** Returns a copy of the current stats */
+    [[nodiscard]] Stats GetStats() const;
+
+private:
+
+    using UniqueLock = std::unique_lock<std::mutex>;
+
+    /** A compressed page and the version it was stored with */
+    struct Entry
+    {
+        uint64_t backendSize { 0 };
+        double modified { 0 };
+        size_t pageSize { 0 };
+        /** The uncompressed size of the page */
+        size_t dataSize { 0 };
+        /** The compressed page data */
+        std::vector<char> data;
+    };
+
+    /** Returns the key for the given file/index */
+    [[nodiscard]] static std::string GetEntryName(const std::string& fileID, uint64_t index);
+
+    /**
+     * Removes and returns the given entry
+     * @return false if the entry does not exist
+     */
+    bool PopEntry(const std::string& name, Entry& entry, const UniqueLock& lock);
+
+    /** The maximum total size of all compressed entries */
+    const size_t mSizeLimit;
+
+    /** Map of entry name to entry in LRU order (most recent first) */
+    OrderedMap<std::string, Entry> mEntries;
+    /** The total size of all compressed entries */
+    size_t mCurrentTotal { 0 };
+    /** The total uncompressed size of all entries */
+    size_t mCurrentRaw { 0 };
+    /** Counters for Stats */
+    uint64_t mHits { 0 };
+    uint64_t mMisses { 0 };
+    uint64_t mRejected { 0 };
+
+    /** Mutex that protects the entry index */
+    mutable std::mutex mMutex;
+
+    mutable Debug mDebug;
+};
+
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
+
+#endif // LIBA2_COMPRESSEDCACHE_H_
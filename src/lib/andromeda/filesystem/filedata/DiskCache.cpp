@@ -0,0 +1,245 @@
+
+#include <algorithm>
+#include <fstream>
+#include <system_error>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "DiskCache.hpp"
+#include "Page.hpp"
+#include "andromeda/StringUtil.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+
+namespace { // anonymous
+
+/** The header at the start of each cache entry file */
+struct EntryHeader
+{
+    uint32_t magic;
+    uint32_t format;
+    uint64_t backendSize;
+    double modified;
+    uint64_t pageSize;
+    uint64_t dataSize;
+};
+
+constexpr uint32_t ENTRY_MAGIC { 0x43443241 }; // "A2DC"
+constexpr uint32_t ENTRY_FORMAT { 1 };
+constexpr const char* TEMP_SUFFIX { ".tmp" };
+
+} // namespace
+
+/*****************************************************/
+DiskCache::DiskCache(const std::string& path, const uint64_t sizeLimit) :
+    mPath(path), mSizeLimit(sizeLimit),
+    mDebug(__func__,this)
+{
+    MDBG_INFO("(path:" << path << " sizeLimit:" << sizeLimit << ")");
+
+    std::error_code ec; std::filesystem::create_directories(mPath, ec);
+    if (ec) { MDBG_ERROR("... create_directories: " << ec.message()); }
+
+    // entries are cleartext file contents, don't let other local users read them
+    std::filesystem::permissions(mPath, std::filesystem::perms::owner_all, ec);
+    if (ec) { MDBG_ERROR("... permissions: " << ec.message()); }
+
+    LoadEntries();
+}
+
+/*****************************************************/
+std::string DiskCache::GetEntryName(const std::string& fileID, const uint64_t index)
+{
+    // file IDs come from the server, hex encode them to be a safe directory name
+    static constexpr const char* hexChars { "0123456789abcdef" };
+    std::string name; name.reserve(fileID.size()*2+21);
+    for (const char chr : fileID)
+    {
+        const auto uchr { static_cast<unsigned char>(chr) };
+        name += hexChars[uchr >> 4]; name += hexChars[uchr & 0xF];
+    }
+    return name + "/" + std::to_string(index);
+}
+
+/*****************************************************/
+void DiskCache::LoadEntries()
+{
+    using DirIterator = std::filesystem::recursive_directory_iterator;
+    using FileTime = std::filesystem::file_time_type;
+    std::vector<std::tuple<FileTime, std::string, uint64_t>> found;
+
+    std::error_code ec;
+    for (DirIterator it { mPath, ec }; !ec && it != DirIterator(); it.increment(ec))
+    {
+        if (!it->is_regular_file(ec) || ec) continue;
+        const std::filesystem::path& path { it->path() };
+
+        if (path.extension() == TEMP_SUFFIX) // interrupted write
+        {
+            std::filesystem::remove(path, ec); continue;
+        }
+
+        const uint64_t size { it->file_size(ec) }; if (ec) continue;
+        const FileTime time { it->last_write_time(ec) }; if (ec) continue;
+        found.emplace_back(time, path.lexically_relative(mPath).generic_string(), size);
+    }
+    if (ec) { MDBG_ERROR("... directory scan: " << ec.message()); }
+
+    std::sort(found.begin(), found.end()); // oldest first
+
+    const UniqueLock lock(mMutex);
+    for (const decltype(found)::value_type& entry : found)
+        AddEntry(std::get<1>(entry), std::get<2>(entry), lock);
+    EvictEntries(lock);
+
+    MDBG_INFO("... entries:" << mEntries.size() << " total:" << mCurrentTotal);
+}
+
+/*****************************************************/
+void DiskCache::AddEntry(const std::string& name, const uint64_t size, const UniqueLock& lock)
+{
+    const decltype(mEntries)::iterator it { mEntries.find(name) };
+    if (it != mEntries.end())
+    {
+        mCurrentTotal -= it->second;
+        mEntries.erase(name);
+    }
+
+    mEntries.enqueue_front(name, size);
+    mCurrentTotal += size;
+}
+
+/*****************************************************/
+void DiskCache::RemoveEntry(const std::string& name, const UniqueLock& lock)
+{
+    const decltype(mEntries)::iterator it { mEntries.find(name) };
+    if (it != mEntries.end())
+    {
+        mCurrentTotal -= it->second;
+        mEntries.erase(name);
+    }
+
+    std::error_code ec; std::filesystem::remove(mPath/name, ec);
+    if (ec) { MDBG_ERROR("... remove " << name << ": " << ec.message()); }
+}
+
+/*****************************************************/
+void DiskCache::EvictEntries(const UniqueLock& lock)
+{
+    while (mCurrentTotal > mSizeLimit && !mEntries.empty())
+    {
+        const std::string name { mEntries.back().first }; // copy
+        MDBG_INFO("... evicting " << name);
+        RemoveEntry(name, lock);
+    }
+}
+
+/*****************************************************/
+bool DiskCache::Contains(const std::string& fileID, const uint64_t index) const
+{
+    const UniqueLock lock(mMutex);
+    return mEntries.exists(GetEntryName(fileID, index));
+}
+
+/*****************************************************/
+bool DiskCache::Load(const Version& version, const uint64_t index, Page& page)
+{
+    const std::string name { GetEntryName(version.fileID, index) };
+
+    { const UniqueLock lock(mMutex);
+        if (!mEntries.exists(name)) { ++mMisses; return false; } }
+
+    MDBG_INFO("(name:" << name << ")");
+
+    std::ifstream file(mPath/name, std::ios::binary);
+    EntryHeader header {};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header)); // NOLINT(*-reinterpret-cast)
+
+    const bool valid { file.good() &&
+        header.magic == ENTRY_MAGIC && header.format == ENTRY_FORMAT &&
+        header.backendSize == version.backendSize && header.modified == version.modified &&
+        header.pageSize == version.pageSize && header.dataSize <= version.pageSize };
+
+    if (valid)
+    {
+        page.resize(static_cast<size_t>(header.dataSize));
+        file.read(page.data(), static_cast<std::streamsize>(header.dataSize));
+    }
+
+    const UniqueLock lock(mMutex);
+    if (!valid || !file.good())
+    {
+        MDBG_INFO("... stale or corrupt entry, removing");
+        RemoveEntry(name, lock);
+        ++mMisses; return false;
+    }
+
+    // mark as most recently used
+    const decltype(mEntries)::iterator it { mEntries.find(name) };
+    if (it != mEntries.end()) AddEntry(name, it->second, lock);
+
+    ++mHits; return true;
+}
+
+/*****************************************************/
+void DiskCache::Store(const Version& version, const uint64_t index, const Page& page)
+{
+    const std::string name { GetEntryName(version.fileID, index) };
+    const uint64_t size { sizeof(EntryHeader) + page.size() };
+    if (size > mSizeLimit) return; // won't fit
+
+    { const UniqueLock lock(mMutex);
+        if (!mStoring.insert(name).second) return; } // already storing
+
+    MDBG_INFO("(name:" << name << " size:" << page.size() << ")");
+
+    // write to a temp file and rename so readers never see a partial entry
+    const std::filesystem::path path { mPath/name };
+    std::filesystem::path tmpPath { path }; tmpPath += TEMP_SUFFIX;
+
+    std::error_code ec; std::filesystem::create_directories(path.parent_path(), ec);
+    if (!ec)
+    {
+        const EntryHeader header { ENTRY_MAGIC, ENTRY_FORMAT, version.backendSize,
+            version.modified, version.pageSize, page.size() };
+
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        std::filesystem::permissions(tmpPath, // 0600 before writing any data
+            std::filesystem::perms::owner_read | std::filesystem::perms::owner_write, ec);
+        if (ec) file.setstate(std::ios::failbit);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header)); // NOLINT(*-reinterpret-cast)
+        file.write(page.data(), static_cast<std::streamsize>(page.size()));
+        file.close();
+
+        if (file.fail()) ec = std::make_error_code(std::errc::io_error);
+        else std::filesystem::rename(tmpPath, path, ec);
+    }
+
+    const UniqueLock lock(mMutex);
+    mStoring.erase(name);
+
+    if (ec)
+    {
+        MDBG_ERROR("... " << name << ": " << ec.message());
+        std::filesystem::remove(tmpPath, ec);
+        RemoveEntry(name, lock); // old entry may be gone
+        return;
+    }
+
+    AddEntry(name, size, lock);
+    EvictEntries(lock);
+}
+
+/*****************************************************/
+DiskCache::Stats DiskCache::GetStats() const
+{
+    const UniqueLock lock(mMutex);
+    return { mCurrentTotal, mEntries.size(), mHits, mMisses };
+}
+
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
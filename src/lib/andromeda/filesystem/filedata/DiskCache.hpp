@@ -0,0 +1,129 @@
+
+#ifndef LIBA2_DISKCACHE_H_
+#define LIBA2_DISKCACHE_H_
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include "andromeda/common.hpp"
+#include "andromeda/Debug.hpp"
+#include "andromeda/OrderedMap.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+
+class Page;
+
+/**
+ * A persistent second-level page cache on local disk, for pages evicted from memory
+ * Each page is stored as a file <path>/<hex fileID>/<index> with a header recording the version
+ * of the backend file it was read from (size/modified/page size) - a mismatching entry is
+ * rejected and deleted. The total size is limited by deleting the least recently used entries.
+ * The index of entries is rebuilt by scanning the directory on construction.
+ * I/O errors are logged and treated as a cache miss, never thrown.
+ * THREAD SAFE (INTERNAL LOCKS)
+ */
+class DiskCache
+{
+public:
+
+    /** The backend file version that cached pages must match */
+    struct Version
+    {
+        /** The backend's ID for the file */
+        const std::string& fileID;
+        /** The size of the file on the backend */
+        uint64_t backendSize;
+        /** The file's modified time on the backend */
+        double modified;
+        /** The page size of the file */
+        size_t pageSize;
+    };
+
+    /**
+     * @param path the directory to store pages in (created if needed)
+     * @param sizeLimit the maximum total size of the cache files
+     */
+    DiskCache(const std::string& path, uint64_t sizeLimit);
+
+    virtual ~DiskCache() = default;
+    DELETE_COPY(DiskCache)
+    DELETE_MOVE(DiskCache)
+
+    /** Returns true if a page for the given file/index is stored (any version) */
+    [[nodiscard]] bool Contains(const std::string& fileID, uint64_t index) const;
+
+    /**
+     * Loads the page at the given index if stored with the given version
+     * @param[out] page the page to resize and fill with the data
+     * @return true if the page was loaded, false if missing or stale
+     */
+    bool Load(const Version& version, uint64_t index, Page& page);
+
+    /** Stores the given page at the given index with the given version, replacing any old entry */
+    void Store(const Version& version, uint64_t index, const Page& page);
+
+    /** Stats about the cache for debugging */
+    struct Stats
+    {
+        /** The total size of all entries */
+        uint64_t currentTotal;
+        /** The number of entries */
+        size_t entries;
+        /** The total number of successful Load() calls */
+        uint64_t hits;
+        /** The total number of failed Load() calls */
+        uint64_t misses;
+    };
+    /** Returns a copy of the current stats */
+    [[nodiscard]] Stats GetStats() const;
+
+private:
+
+    using UniqueLock = std::unique_lock<std::mutex>;
+
+    /** Returns the cache-relative entry name for the given file/index */
+    [[nodiscard]] static std::string GetEntryName(const std::string& fileID, uint64_t index);
+
+    /** Scans the cache directory to rebuild mEntries (oldest first) */
+    void LoadEntries();
+
+    /** Marks the given entry as most recently used with the given size */
+    void AddEntry(const std::string& name, uint64_t size, const UniqueLock& lock);
+
+    /** Removes the given entry from the index and deletes its file */
+    void RemoveEntry(const std::string& name, const UniqueLock& lock);
+
+    /** Deletes least recently used entries until under mSizeLimit */
+    void EvictEntries(const UniqueLock& lock);
+
+    /** The root directory of the cache */
+    const std::filesystem::path mPath;
+    /** The maximum total size of all entries */
+    const uint64_t mSizeLimit;
+
+    /** Map of entry name to size in LRU order (most recent first) */
+    OrderedMap<std::string, uint64_t> mEntries;
+    /** Set of entry names currently being written */
+    std::set<std::string> mStoring;
+    /** The total size of all entries */
+    uint64_t mCurrentTotal { 0 };
+    /** Hit/miss counters for Stats */
+    uint64_t mHits { 0 };
+    uint64_t mMisses { 0 };
+
+    /** Mutex that protects the entry index */
+    mutable std::mutex mMutex;
+
+    mutable Debug mDebug;
+};
+
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
+
+#endif // LIBA2_DISKCACHE_H_
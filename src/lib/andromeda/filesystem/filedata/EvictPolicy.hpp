@@ -0,0 +1,97 @@
+
+#ifndef LIBA2_EVICTPOLICY_H_
+#define LIBA2_EVICTPOLICY_H_
+
+#include <cstdint>
+#include <functional>
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+
+class Page;
+
+/** 
+ * Interface for choosing the order in which the CacheManager evicts pages
+ * Pages are tracked by address, and also by PageKey so that a policy
+ * can remember pages after they are evicted (see ARCPolicy)
+ * NOT THREAD SAFE (protect externally)
+ */
+class EvictPolicy
+{
+public:
+
+    /** Identifies a page across evictions (the address of a Page does not survive eviction) */
+    struct PageKey
+    {
+        /** The PageManager that owns the page */
+        const void* owner;
+        /** The page index within the owner */
+        uint64_t index;
+
+        [[nodiscard]] inline bool operator==(const PageKey& rhs) const noexcept {
+            return owner == rhs.owner && index == rhs.index; }
+    };
+
+    EvictPolicy() = default;
+    virtual ~EvictPolicy() = default;
+    EvictPolicy(const EvictPolicy&) = delete;
+    EvictPolicy& operator=(const EvictPolicy&) = delete;
+    EvictPolicy(EvictPolicy&&) = delete;
+    EvictPolicy& operator=(EvictPolicy&&) = delete;
+
+    /** 
+     * Adds a new page (must not already exist)
+     * @param page the page to add
+     * @param key the owner/index of the page
+     * @param size the memory usage of the page
+     * @param lowPriority if true, the page was read ahead and should be evicted early unless accessed
+     */
+    virtual void Insert(const Page* page, const PageKey& key, size_t size, bool lowPriority) = 0;
+
+    /** Records an access to an existing page (ignored if not found) */
+    virtual void Access(const Page* page) = 0;
+
+    /** Updates the memory usage of an existing page (ignored if not found) */
+    virtual void Resize(const Page* page, size_t size) = 0;
+
+    /** 
+     * Removes a page (ignored if not found)
+     * @param evicted true if the page was evicted to free memory, false if it was deleted
+     *   (only evicted pages may be remembered, as a deleted page's data will not be read again)
+     */
+    virtual void Erase(const Page* page, bool evicted) = 0;
+
+    /** Moves a page that could not be evicted to the back of the eviction order, without counting an access */
+    virtual void Requeue(const Page* page) = 0;
+
+    /** Forgets anything remembered about evicted pages of the given owner (being deleted) */
+    virtual void EraseOwner(const void* owner) { }
+
+    /** Informs the policy of the cache size in bytes (ignored by default) */
+    virtual void SetCapacity(size_t capacity) { }
+
+    /** 
+     * Calls func with each page in the order they should be evicted
+     * @param func function to call with each page, returns false to stop
+     */
+    virtual void ForEachVictim(const std::function<bool(const Page*)>& func) const = 0;
+};
+
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
+
+namespace std {
+/** Allows using an EvictPolicy::PageKey as a hash map key */
+template<> struct hash<Andromeda::Filesystem::Filedata::EvictPolicy::PageKey>
+{
+    size_t operator()(const Andromeda::Filesystem::Filedata::EvictPolicy::PageKey& key) const noexcept
+    {
+        const size_t ownerHash { std::hash<const void*>()(key.owner) };
+        return ownerHash ^ (std::hash<uint64_t>()(key.index) + 0x9e3779b9 + (ownerHash << 6) + (ownerHash >> 2));
+    }
+};
+} // namespace std
+
+#endif // LIBA2_EVICTPOLICY_H_
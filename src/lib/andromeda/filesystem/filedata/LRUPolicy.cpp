@@ -0,0 +1,36 @@
+
+#include "LRUPolicy.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+
+/*****************************************************/
+void LRUPolicy::Insert(const Page* page, const PageKey& key, size_t size, bool lowPriority)
+{
+    mQueue.enqueue_front(page);
+}
+
+/*****************************************************/
+void LRUPolicy::Access(const Page* page)
+{
+    if (mQueue.erase(page))
+        mQueue.enqueue_front(page);
+}
+
+/*****************************************************/
+void LRUPolicy::Erase(const Page* page, bool evicted)
+{
+    mQueue.erase(page);
+}
+
+/*****************************************************/
+void LRUPolicy::ForEachVictim(const std::function<bool(const Page*)>& func) const
+{
+    for (decltype(mQueue)::const_reverse_iterator it { mQueue.crbegin() }; it != mQueue.crend(); ++it)
+        if (!func(*it)) return;
+}
+
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
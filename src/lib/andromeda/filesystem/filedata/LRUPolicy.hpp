@@ -0,0 +1,38 @@
+
+#ifndef LIBA2_LRUPOLICY_H_
+#define LIBA2_LRUPOLICY_H_
+
+#include "EvictPolicy.hpp"
+#include "andromeda/OrderedMap.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+
+/** 
+ * A simple least-recently-used eviction policy
+ * Read-ahead pages are not treated specially
+ * NOT THREAD SAFE (protect externally)
+ */
+class LRUPolicy : public EvictPolicy
+{
+public:
+
+    void Insert(const Page* page, const PageKey& key, size_t size, bool lowPriority) override;
+    void Access(const Page* page) override;
+    void Resize(const Page* page, size_t size) override { } // sizes not needed
+    void Erase(const Page* page, bool evicted) override;
+    void Requeue(const Page* page) override { Access(page); }
+    void ForEachVictim(const std::function<bool(const Page*)>& func) const override;
+
+private:
+
+    /** Queue of pages, most recently used first */
+    HashedQueue<const Page*> mQueue;
+};
+
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
+
+#endif // LIBA2_LRUPOLICY_H_
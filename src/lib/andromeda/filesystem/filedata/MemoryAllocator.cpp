@@ -1,6 +1,10 @@
 
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <iterator>
 #include <memory>
+#include <new>
 #include <ostream>
 
 #if WIN32
@@ -18,16 +22,21 @@ namespace Filesystem {
 namespace Filedata {
 
 /*****************************************************/
-MemoryAllocator::MemoryAllocator() : 
+MemoryAllocator::MemoryAllocator(const bool hugePages) : 
     mPageSize(calcPageSize()),
+#if defined(MADV_HUGEPAGE)
+    mHugePages(hugePages),
+#else // !MADV_HUGEPAGE
+    mHugePages(false), // not supported
+#endif // MADV_HUGEPAGE
     mDebug(__func__,this)
 {
-    MDBG_INFO("... mPageSize:" << mPageSize);
+    MDBG_INFO("... mPageSize:" << mPageSize << " mHugePages:" << mHugePages);
 }
 
 #if DEBUG // sanity checks
 /*****************************************************/
-MemoryAllocator::~MemoryAllocator(){ assert(mAllocMap.empty()); }
+MemoryAllocator::~MemoryAllocator(){ assert(mAllocMap.empty()); assert(mArenas.empty()); }
 #endif // DEBUG
 
 /*****************************************************/
@@ -43,18 +52,169 @@ size_t MemoryAllocator::calcPageSize() const
 }
 
 /*****************************************************/
-void* MemoryAllocator::alloc(size_t pages)
+void* MemoryAllocator::map_bytes(const size_t bytes, const bool huge) const
 {
-    if (!pages) return nullptr;
+#if WIN32
+    return VirtualAlloc(nullptr, bytes, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+#else // !WIN32
+    if (!huge)
+    {
+        void* const ptr { mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) };
+        return (ptr == MAP_FAILED) ? nullptr : ptr;
+    }
+
+    // map an extra huge page then trim both ends to get an aligned range
+    const size_t mapBytes { bytes + HUGE_PAGE_SIZE };
+    void* const mapPtr { mmap(nullptr, mapBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) };
+    if (mapPtr == MAP_FAILED) return nullptr;
+
+    char* const mapStart { static_cast<char*>(mapPtr) };
+    const auto mapAddr { reinterpret_cast<uintptr_t>(mapStart) }; // NOLINT(*-reinterpret-cast)
+    char* const start { mapStart + (HUGE_PAGE_SIZE - mapAddr % HUGE_PAGE_SIZE) % HUGE_PAGE_SIZE };
+    char* const end { start + bytes };
 
+    if (start > mapStart) munmap(mapStart, static_cast<size_t>(start-mapStart));
+    if (mapStart + mapBytes > end) munmap(end, static_cast<size_t>(mapStart + mapBytes - end));
+
+#if defined(MADV_HUGEPAGE)
+    if (madvise(start, bytes, MADV_HUGEPAGE) != 0)
+        { MDBG_INFO("... MADV_HUGEPAGE failed, errno:" << errno); }
+#endif // MADV_HUGEPAGE
+    return start;
+#endif // WIN32
+}
+
+/*****************************************************/
+void MemoryAllocator::unmap_bytes(void* const ptr, const size_t bytes) const
+{
 #if WIN32
-    LPVOID ptr = VirtualAlloc(nullptr, pages*mPageSize, 
-        MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    VirtualFree(ptr, bytes, MEM_RELEASE);
 #else // !WIN32
-    void* ptr = mmap(nullptr, pages*mPageSize, 
-        PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    munmap(ptr, bytes);
 #endif // WIN32
-    MDBG_INFO("(ptr:" << ptr << " pages:" << pages << " bytes:" << pages*mPageSize << ")");
+}
+
+/*****************************************************/
+void* MemoryAllocator::arena_alloc(const size_t pages)
+{
+    const LockGuard lock(mArenaMutex);
+
+    // first fit from existing arenas
+    for (ArenaMap::value_type& pair : mArenas)
+    {
+        Arena& arena { pair.second };
+        if (arena.freePages < pages) continue;
+
+        for (decltype(arena.freeRanges)::iterator it { arena.freeRanges.begin() }; it != arena.freeRanges.end(); ++it)
+        {
+            if (it->second < pages) continue;
+
+            const size_t offset { it->first };
+            const size_t remain { it->second - pages };
+            arena.freeRanges.erase(it);
+            if (remain) arena.freeRanges.emplace(offset+pages, remain);
+            arena.freePages -= pages;
+
+            MDBG_INFO("... arena:" << static_cast<void*>(pair.first) << " offset:" << offset << " freePages:" << arena.freePages);
+            return pair.first + offset*mPageSize;
+        }
+    }
+
+    // no room, start a new arena
+    char* const base { static_cast<char*>(map_bytes(ARENA_SIZE, true)) };
+    if (base == nullptr) return nullptr;
+
+    const size_t arenaPages { ARENA_SIZE/mPageSize };
+    Arena& arena { mArenas.emplace(base, Arena{{}, arenaPages-pages}).first->second };
+    if (arenaPages > pages) arena.freeRanges.emplace(pages, arenaPages-pages);
+
+    MDBG_INFO("... new arena:" << static_cast<void*>(base) << " arenas:" << mArenas.size());
+    return base;
+}
+
+/*****************************************************/
+bool MemoryAllocator::arena_free(void* const ptr, const size_t pages)
+{
+    const LockGuard lock(mArenaMutex);
+    char* const cptr { static_cast<char*>(ptr) };
+
+    // lower_bound with map<greater> means first base <= our ptr
+    const ArenaMap::iterator arenaIt { mArenas.lower_bound(cptr) };
+    if (arenaIt == mArenas.end() || cptr >= arenaIt->first + ARENA_SIZE) return false;
+
+    char* const base { arenaIt->first };
+    Arena& arena { arenaIt->second };
+
+    // add the range to the free list, coalescing with its neighbors
+    const size_t freeStart { static_cast<size_t>(cptr-base) };
+    size_t offset { freeStart/mPageSize };
+    size_t count { pages };
+
+    decltype(arena.freeRanges)::iterator next { arena.freeRanges.lower_bound(offset) };
+    if (next != arena.freeRanges.end() && offset+count == next->first)
+    {
+        count += next->second;
+        next = arena.freeRanges.erase(next);
+    }
+    if (next != arena.freeRanges.begin())
+    {
+        const decltype(next) prev { std::prev(next) };
+        if (prev->first + prev->second == offset)
+        {
+            offset = prev->first;
+            count += prev->second;
+            arena.freeRanges.erase(prev);
+        }
+    }
+    arena.freeRanges.emplace(offset, count);
+    arena.freePages += pages;
+
+    MDBG_INFO("... arena:" << static_cast<void*>(base) << " freePages:" << arena.freePages);
+
+    if (arena.freePages*mPageSize == ARENA_SIZE) // all free
+    {
+        MDBG_INFO("... unmapping arena:" << static_cast<void*>(base));
+        unmap_bytes(base, ARENA_SIZE);
+        mArenas.erase(arenaIt);
+        return true;
+    }
+
+#if !WIN32
+    // let the kernel reclaim the memory lazily, but keep the address range - only release huge pages
+    // that are now entirely free, as releasing part of one would split it back into small pages
+    const size_t freeEnd { freeStart + pages*mPageSize };
+    const size_t extentStart { offset*mPageSize };
+    const size_t extentEnd { (offset+count)*mPageSize };
+    const size_t hugeStart { std::max(extentStart, freeStart - freeStart % HUGE_PAGE_SIZE) };
+    const size_t hugeEnd { std::min(extentEnd, freeEnd + (HUGE_PAGE_SIZE - freeEnd % HUGE_PAGE_SIZE) % HUGE_PAGE_SIZE) };
+    const size_t releaseStart { hugeStart + (HUGE_PAGE_SIZE - hugeStart % HUGE_PAGE_SIZE) % HUGE_PAGE_SIZE };
+    const size_t releaseEnd { hugeEnd - hugeEnd % HUGE_PAGE_SIZE };
+
+    if (releaseStart < releaseEnd)
+    {
+        MDBG_INFO("... releasing offset:" << releaseStart << " bytes:" << releaseEnd-releaseStart);
+#if defined(MADV_FREE)
+        if (madvise(base+releaseStart, releaseEnd-releaseStart, MADV_FREE) != 0) // needs Linux 4.5
+#endif // MADV_FREE
+            madvise(base+releaseStart, releaseEnd-releaseStart, MADV_DONTNEED);
+    }
+#endif // !WIN32
+    return true;
+}
+
+/*****************************************************/
+void* MemoryAllocator::alloc(size_t pages)
+{
+    if (!pages) return nullptr;
+
+    const size_t bytes { pages*mPageSize };
+    void* ptr { nullptr };
+    if (mHugePages && bytes <= ARENA_SIZE/2) // carve from an arena
+        ptr = arena_alloc(pages);
+    else ptr = map_bytes(bytes, mHugePages && bytes >= HUGE_PAGE_SIZE);
+
+    MDBG_INFO("(ptr:" << ptr << " pages:" << pages << " bytes:" << bytes << ")");
+    if (ptr == nullptr) throw std::bad_alloc();
 
 #if DEBUG // sanity checks
 { // lock scope
@@ -113,11 +273,8 @@ void MemoryAllocator::free(void* const ptr, const size_t pages)
 }
 #endif // DEBUG
 
-#if WIN32
-    VirtualFree(ptr, pages*mPageSize, MEM_RELEASE);
-#else // !WIN32
-    munmap(ptr, pages*mPageSize);
-#endif // WIN32
+    if (!mHugePages || !arena_free(ptr, pages))
+        unmap_bytes(ptr, pages*mPageSize);
 
     stats(__func__, pages, false);
 }
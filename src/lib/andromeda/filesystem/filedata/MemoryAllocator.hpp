@@ -16,6 +16,9 @@ namespace Filedata {
 
 /**
  * A raw, non-caching memory allocator that allocates pages directly from the OS, bypassing the C library.
+ * Optionally (Linux) allocations are carved out of 2MB-aligned arenas backed by transparent huge pages, 
+ * to reduce TLB misses when copying large amounts of cached data. Freed arena ranges are given back
+ * with MADV_FREE (lazily reclaimed by the kernel) and an arena is unmapped once entirely free.
  * In DEBUG builds, verifies all calls to free() for validity.
  * THREAD SAFE (INTERNAL LOCKS)
  */
@@ -23,7 +26,13 @@ class MemoryAllocator
 {
 public:
 
-    explicit MemoryAllocator();
+    /** The size and alignment of a huge page */
+    static constexpr size_t HUGE_PAGE_SIZE { static_cast<size_t>(2)*1024*1024 };
+    /** The size of each huge page arena - larger allocations get their own huge page mapping */
+    static constexpr size_t ARENA_SIZE { 16*HUGE_PAGE_SIZE };
+
+    /** @param hugePages if true, use transparent huge page arenas (ignored if not supported) */
+    explicit MemoryAllocator(bool hugePages = false);
 
 #if DEBUG // sanity checks
     virtual ~MemoryAllocator();
@@ -43,6 +52,9 @@ public:
      */
     virtual void free(void* ptr, size_t pages);
 
+    /** Returns true if transparent huge page arenas are in use */
+    [[nodiscard]] inline bool isHugePages() const { return mHugePages; }
+
     /** Returns the number of bytes in each page */
     [[nodiscard]] inline size_t getPageSize() const { return mPageSize; }
 
@@ -67,6 +79,37 @@ private:
     /** Updates and prints allocator statistics (debug) */
     void stats(const char* fname, size_t pages, bool alloc);
 
+    /** Maps the given number of bytes from the OS, aligned to HUGE_PAGE_SIZE if huge, or returns nullptr */
+    [[nodiscard]] void* map_bytes(size_t bytes, bool huge) const;
+    /** Returns the given range of bytes to the OS */
+    void unmap_bytes(void* ptr, size_t bytes) const;
+
+    /** Allocates the given number of pages from an arena, creating a new one if needed */
+    void* arena_alloc(size_t pages);
+    /** 
+     * Frees the given range of pages if it is within an arena
+     * Memory is only returned to the OS in whole huge pages, partial ones stay resident
+     * @return false if the range is not in an arena (a direct mapping)
+     */
+    bool arena_free(void* ptr, size_t pages);
+
+    /** True if allocations are carved from huge page arenas */
+    const bool mHugePages;
+
+    /** A huge page mapping that allocations are carved from */
+    struct Arena
+    {
+        /** Map of free page offset to page count (coalesced) */
+        std::map<size_t, size_t> freeRanges;
+        /** The total number of free pages */
+        size_t freePages;
+    };
+    /** Map of arena base pointer to arena, greater<> so lower_bound finds the arena containing a pointer */
+    using ArenaMap = std::map<char*, Arena, std::greater<>>;
+    ArenaMap mArenas;
+    /** Mutex that protects mArenas */
+    std::mutex mArenaMutex;
+
 #if DEBUG // sanity checks
     using AllocMap = std::map<void*, size_t, std::greater<>>;
     /** Map of all allocations for verifying frees */
@@ -0,0 +1,93 @@
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "MemoryPressure.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+
+/*****************************************************/
+MemoryPressure::MemoryPressure(const std::string& rootPath) :
+    mPressurePath(std::filesystem::path(rootPath)/"proc/pressure/memory"),
+    mDebug(__func__,this)
+{
+    std::ifstream cgroupFile(std::filesystem::path(rootPath)/"proc/self/cgroup");
+    const std::optional<std::string> cgroup { ParseCgroupPath(cgroupFile) };
+    if (cgroup) mCgroupPath = std::filesystem::path(rootPath)/"sys/fs/cgroup"/cgroup->substr(1); // relative
+
+    MDBG_INFO("(pressure:" << mPressurePath << " cgroup:" << mCgroupPath << ")");
+}
+
+/*****************************************************/
+std::optional<double> MemoryPressure::ParsePSI(std::istream& input)
+{
+    // e.g. "some avg10=0.00 avg60=0.00 avg300=0.00 total=0"
+    std::string line;
+    while (std::getline(input, line))
+    {
+        std::istringstream lineStr(line);
+        std::string kind; lineStr >> kind;
+        if (kind != "some") continue;
+
+        std::string field;
+        while (lineStr >> field)
+        {
+            if (field.rfind("avg10=", 0) != 0) continue;
+            try { return std::stod(field.substr(6)); }
+            catch (const std::logic_error& e) { return std::nullopt; }
+        }
+    }
+    return std::nullopt;
+}
+
+/*****************************************************/
+std::optional<uint64_t> MemoryPressure::ParseCgroupValue(std::istream& input)
+{
+    std::string value; input >> value;
+    if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos)
+        return std::nullopt; // "max" or garbage
+
+    try { return std::stoull(value); }
+    catch (const std::logic_error& e) { return std::nullopt; }
+}
+
+/*****************************************************/
+std::optional<std::string> MemoryPressure::ParseCgroupPath(std::istream& input)
+{
+    // cgroup v2 is the line with hierarchy 0 and no controllers e.g. "0::/user.slice"
+    std::string line;
+    while (std::getline(input, line))
+    {
+        if (line.rfind("0::/", 0) == 0)
+            return line.substr(3);
+    }
+    return std::nullopt;
+}
+
+/*****************************************************/
+MemoryPressure::Sample MemoryPressure::GetSample() const
+{
+    Sample sample;
+
+    { std::ifstream file(mPressurePath);
+        if (file) sample.stallPercent = ParsePSI(file); }
+
+    if (!mCgroupPath.empty())
+    {
+        { std::ifstream file(mCgroupPath/"memory.max");
+            if (file) sample.cgroupMax = ParseCgroupValue(file); }
+        { std::ifstream file(mCgroupPath/"memory.current");
+            if (file) sample.cgroupCurrent = ParseCgroupValue(file); }
+    }
+
+    MDBG_INFO("... stall:" << sample.stallPercent.value_or(-1) 
+        << " max:" << sample.cgroupMax.value_or(0) << " current:" << sample.cgroupCurrent.value_or(0));
+    return sample;
+}
+
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
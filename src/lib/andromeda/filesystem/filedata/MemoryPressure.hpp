@@ -0,0 +1,75 @@
+
+#ifndef LIBA2_MEMORYPRESSURE_H_
+#define LIBA2_MEMORYPRESSURE_H_
+
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <optional>
+#include <string>
+
+#include "andromeda/common.hpp"
+#include "andromeda/Debug.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+
+/**
+ * Reads the system memory pressure, for sizing the cache dynamically (see CacheManager)
+ * Uses Linux PSI (/proc/pressure/memory) and the cgroup v2 memory.max/memory.current of our process.
+ * Any value that is not available (not Linux, old kernel, cgroup v1, no limit) is just not returned.
+ * NOT THREAD SAFE (protect externally)
+ */
+class MemoryPressure
+{
+public:
+
+    /** 
+     * Finds the files to read - the cgroup is looked up once here
+     * @param rootPath path to find /proc and /sys/fs/cgroup under (for testing)
+     */
+    explicit MemoryPressure(const std::string& rootPath = "/");
+
+    virtual ~MemoryPressure() = default;
+    DELETE_COPY(MemoryPressure)
+    DELETE_MOVE(MemoryPressure)
+
+    /** A reading of the current memory pressure */
+    struct Sample
+    {
+        /** Percent of the last 10 seconds that some task was stalled on memory (PSI) */
+        std::optional<double> stallPercent;
+        /** The memory limit of our cgroup (bytes) */
+        std::optional<uint64_t> cgroupMax;
+        /** The current memory usage of our cgroup (bytes) */
+        std::optional<uint64_t> cgroupCurrent;
+    };
+
+    /** Reads the current values from the system */
+    [[nodiscard]] Sample GetSample() const;
+
+    /** Returns the "some avg10" value from PSI file contents, or nullopt if not found */
+    [[nodiscard]] static std::optional<double> ParsePSI(std::istream& input);
+
+    /** Returns the value from a cgroup memory file, or nullopt if not a number (e.g. "max") */
+    [[nodiscard]] static std::optional<uint64_t> ParseCgroupValue(std::istream& input);
+
+    /** Returns the cgroup v2 path from /proc/self/cgroup contents, or nullopt if not found */
+    [[nodiscard]] static std::optional<std::string> ParseCgroupPath(std::istream& input);
+
+private:
+
+    /** Path to the PSI memory file */
+    const std::filesystem::path mPressurePath;
+    /** Path to our cgroup directory (empty if not found) */
+    std::filesystem::path mCgroupPath;
+
+    mutable Debug mDebug;
+};
+
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
+
+#endif // LIBA2_MEMORYPRESSURE_H_
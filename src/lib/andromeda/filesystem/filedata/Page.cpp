@@ -1,6 +1,8 @@
 
 
-#include <cstring>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
 
 #include "CachingAllocator.hpp"
 #include "Page.hpp"
@@ -10,18 +12,25 @@ namespace Filesystem {
 namespace Filedata {
 
 /*****************************************************/
-Page::Page(size_t pageSize, CachingAllocator& memAlloc) : 
+Page::Page(size_t pageSize, CachingAllocator& memAlloc, bool sparse) : 
     mAlloc(memAlloc), 
     mBytes(pageSize), 
-    mPages(mAlloc.getNumPages(mBytes)), 
-    mData(mPages ? static_cast<char*>(mAlloc.alloc(mPages)) : nullptr){ }
+    mPages(sparse ? 0 : mAlloc.getAllocPages(mBytes)), 
+    mData(mPages ? static_cast<char*>(mAlloc.alloc(mPages)) : nullptr),
+    mSparse(sparse){ }
 
 /*****************************************************/
 Page::Page(Page&& page) noexcept : // move constructor
     mAlloc(page.mAlloc), 
     mBytes(page.mBytes), 
     mPages(page.mPages), 
-    mData(page.mData)
+    mData(page.mData),
+    mDirty(page.mDirty),
+    mSparse(page.mSparse),
+    mPrefetched(page.mPrefetched),
+    mBlockSize(page.mBlockSize),
+    mValid(std::move(page.mValid)),
+    mDirtyRanges(std::move(page.mDirtyRanges))
 {
     page.mBytes = 0;
     page.mPages = 0;
@@ -44,7 +53,9 @@ size_t Page::capacity() const
 /*****************************************************/
 void Page::resize(size_t newBytes)
 {
-    const size_t newPages { mAlloc.getNumPages(newBytes) };
+    if (mSparse) { mBytes = newBytes; return; }
+
+    const size_t newPages { mAlloc.getAllocPages(newBytes) };
     if (newPages != mPages) // re-allocate
     {
         char* const newData { static_cast<char*>(mAlloc.alloc(newPages)) };
@@ -59,6 +70,147 @@ void Page::resize(size_t newBytes)
         mData = newData;
     }
     else mBytes = newBytes;
+
+    if (isPartial())
+    {
+        mValid.resize((mBytes + mBlockSize-1) / mBlockSize, false);
+
+        // drop dirty ranges past the new end
+        for (DirtyRanges::iterator it { mDirtyRanges.lower_bound(mBytes) }; it != mDirtyRanges.end(); )
+            it = mDirtyRanges.erase(it);
+        if (!mDirtyRanges.empty() && mDirtyRanges.rbegin()->second > mBytes)
+            mDirtyRanges.rbegin()->second = mBytes;
+    }
+}
+
+/*****************************************************/
+void Page::materialize()
+{
+    if (!mSparse) return;
+
+    mPages = mAlloc.getAllocPages(mBytes);
+    mData = mPages ? static_cast<char*>(mAlloc.alloc(mPages)) : nullptr;
+    if (mData != nullptr) std::memset(mData, 0, mBytes);
+    mSparse = false;
+}
+
+/*****************************************************/
+void Page::setPartial(const size_t blockSize)
+{
+    mBlockSize = blockSize;
+    mValid.assign((mBytes + mBlockSize-1) / mBlockSize, false);
+}
+
+/*****************************************************/
+bool Page::isBlockValid(const size_t block) const
+{
+    return !isPartial() || (block < mValid.size() && mValid[block]);
+}
+
+/*****************************************************/
+bool Page::isDirtyRange(const size_t start, const size_t end) const
+{
+    DirtyRanges::const_iterator it { mDirtyRanges.upper_bound(start) };
+    if (it == mDirtyRanges.begin()) return false;
+    --it; return it->second >= end; // it->first <= start
+}
+
+/*****************************************************/
+bool Page::isBlockReadable(const size_t block, const size_t start, const size_t end) const
+{
+    if (isBlockValid(block)) return true;
+    return isDirtyRange(std::max(start, block*mBlockSize), std::min(end, (block+1)*mBlockSize));
+}
+
+/*****************************************************/
+bool Page::isValid(const size_t offset, const size_t length) const
+{
+    if (!isPartial() || !length) return true;
+
+    for (size_t block { offset/mBlockSize }; block <= (offset+length-1)/mBlockSize; ++block)
+        if (!isBlockReadable(block, offset, offset+length)) return false;
+    return true;
+}
+
+/*****************************************************/
+void Page::addDirtyRange(const size_t offset, const size_t length)
+{
+    if (!isPartial() || !length) return;
+
+    size_t start { offset };
+    size_t end { offset+length };
+
+    // merge with any overlapping or adjacent ranges
+    DirtyRanges::iterator it { mDirtyRanges.upper_bound(start) };
+    if (it != mDirtyRanges.begin() && std::prev(it)->second >= start) --it;
+    while (it != mDirtyRanges.end() && it->first <= end)
+    {
+        start = std::min(start, it->first);
+        end = std::max(end, it->second);
+        it = mDirtyRanges.erase(it);
+    }
+    mDirtyRanges.emplace(start, end);
+
+    setValid(start, end-start); // may clear mDirtyRanges if no longer partial
+}
+
+/*****************************************************/
+void Page::fillClean(const size_t offset, const char* const buf, const size_t length)
+{
+    const size_t end { offset+length };
+    size_t pos { offset };
+
+    DirtyRanges::const_iterator it { mDirtyRanges.upper_bound(pos) };
+    if (it != mDirtyRanges.begin() && std::prev(it)->second > pos) --it;
+
+    while (pos < end)
+    {
+        // copy up to the next dirty range, then skip over it
+        const size_t copyEnd { (it != mDirtyRanges.end()) ? std::min(end, std::max(pos, it->first)) : end };
+        std::memcpy(mData+pos, buf+(pos-offset), copyEnd-pos);
+        pos = copyEnd;
+
+        if (it != mDirtyRanges.end() && pos < end)
+        {
+            pos = std::min(end, it->second);
+            ++it;
+        }
+    }
+}
+
+/*****************************************************/
+void Page::setValid(const size_t offset, const size_t length)
+{
+    if (!isPartial() || !length) return;
+
+    // only mark blocks that are entirely covered
+    const size_t firstBlock { (offset + mBlockSize-1) / mBlockSize };
+    const size_t endBlock { (offset+length >= mBytes) ? mValid.size() : (offset+length)/mBlockSize };
+    for (size_t block { firstBlock }; block < endBlock; ++block)
+        mValid[block] = true;
+
+    if (std::all_of(mValid.cbegin(), mValid.cend(), [](const bool valid){ return valid; }))
+    {
+        mValid.clear(); // no longer partial
+        mDirtyRanges.clear(); // whole page is valid
+    }
+}
+
+/*****************************************************/
+std::pair<size_t,size_t> Page::getInvalidRange(const size_t offset, const size_t length) const
+{
+    if (!isPartial() || !length) return { offset, 0 };
+
+    size_t firstBlock { offset/mBlockSize };
+    size_t lastBlock { (offset+length-1)/mBlockSize };
+    while (firstBlock <= lastBlock && isBlockReadable(firstBlock, offset, offset+length)) ++firstBlock;
+    while (lastBlock > firstBlock && isBlockReadable(lastBlock, offset, offset+length)) --lastBlock;
+
+    if (firstBlock > lastBlock) return { offset, 0 }; // all valid
+
+    const size_t rangeStart { firstBlock*mBlockSize };
+    const size_t rangeEnd { std::min(mBytes, (lastBlock+1)*mBlockSize) };
+    return { rangeStart, rangeEnd-rangeStart };
 }
 
 } // namespace Filedata
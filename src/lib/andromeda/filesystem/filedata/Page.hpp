@@ -2,6 +2,10 @@
 #ifndef LIBA2_PAGE_H_
 #define LIBA2_PAGE_H_
 
+#include <map>
+#include <utility>
+#include <vector>
+
 #include "andromeda/common.hpp"
 
 namespace Andromeda {
@@ -10,20 +14,28 @@ namespace Filedata {
 
 class CachingAllocator;
 
-/** A file data page (manages memory pages) */
+/** 
+ * A file data page (manages memory pages)
+ * A page can be partially valid, tracked in blocks (see setPartial)
+ * A partially valid page also tracks its dirty byte ranges (see addDirtyRange), which count as valid
+ * A page can be sparse - all zeroes with no memory allocated (see materialize)
+ */
 class Page
 {
 public:
 
-    /** Construct a page with the given size in bytes and allocator */
-    explicit Page(size_t pageSize, CachingAllocator& memAlloc);
+    /** 
+     * Construct a page with the given size in bytes and allocator
+     * @param sparse if true, the page is all zeroes and no memory is allocated
+     */
+    explicit Page(size_t pageSize, CachingAllocator& memAlloc, bool sparse = false);
 
     virtual ~Page();
     Page(Page&& page) noexcept; // move
     Page& operator=(Page&&) = delete; // move
     DELETE_COPY(Page)
 
-    /** Return a pointer to the data buffer */
+    /** Return a pointer to the data buffer (nullptr if sparse) */
     inline char* data() { return mData; }
     [[nodiscard]] inline const char* data() const { return mData; }
     /** Return the size of this page in bytes */
@@ -33,14 +45,72 @@ public:
 
     /** Return true if the page is dirty (un-flushed data) */
     [[nodiscard]] inline bool isDirty() const { return mDirty; }
-    /** Set whether or not this page is dirty */
-    inline void setDirty(bool dirty = true){ mDirty = dirty; }
+    /** Set whether or not this page is dirty (clearing also clears the dirty ranges) */
+    inline void setDirty(bool dirty = true){ mDirty = dirty; if (!dirty) mDirtyRanges.clear(); }
+
+    /** Map of dirty byte range start to end (exclusive) */
+    using DirtyRanges = std::map<size_t, size_t>;
+    /** 
+     * Returns the byte ranges written since the last flush, only tracked while partial
+     * If the page is dirty and not partial, the whole page is dirty
+     */
+    [[nodiscard]] inline const DirtyRanges& getDirtyRanges() const { return mDirtyRanges; }
+    /** 
+     * Records that the given byte range was written (no-op if not partial)
+     * Written data is valid, so blocks entirely covered by dirty ranges are marked valid
+     */
+    void addDirtyRange(size_t offset, size_t length);
+    /** Copies fetched data into the given byte range, skipping any bytes in dirty ranges */
+    void fillClean(size_t offset, const char* buf, size_t length);
 
-    /** Resizes to the given # of bytes, possibly re-allocating */
+    /** 
+     * Resizes to the given # of bytes, possibly re-allocating
+     * If partial and growing, the new blocks are not valid
+     * If sparse, only the size changes (the page stays all zeroes)
+     */
     void resize(size_t bytes);
 
+    /** Returns true if the page is all zeroes with no memory allocated */
+    [[nodiscard]] inline bool isSparse() const { return mSparse; }
+    /** Allocates zeroed memory for a sparse page so it can be written (no-op if not sparse) */
+    void materialize();
+
+    /** Returns true if the page was fetched by read-ahead and not yet read */
+    [[nodiscard]] inline bool isPrefetched() const { return mPrefetched; }
+    /** Set whether or not the page was fetched by read-ahead and not yet read */
+    inline void setPrefetched(bool prefetched = true){ mPrefetched = prefetched; }
+
+    /** Returns true if only some of the data is valid (see setPartial) */
+    [[nodiscard]] inline bool isPartial() const { return !mValid.empty(); }
+    /** Marks all of the data not valid, to be tracked in blocks of the given size (not zero) */
+    void setPartial(size_t blockSize);
+    /** Returns the block size used for tracking validity (if partial) */
+    [[nodiscard]] inline size_t getBlockSize() const { return mBlockSize; }
+    /** Returns true if the given block index is valid */
+    [[nodiscard]] bool isBlockValid(size_t block) const;
+
+    /** Returns true if all of the data in the given byte range is valid (or dirty) */
+    [[nodiscard]] bool isValid(size_t offset, size_t length) const;
+    /** 
+     * Marks the given byte range as valid - must begin on a block boundary and 
+     * end on a block boundary or the page end, else partial blocks are not marked
+     * If all blocks become valid, the page is no longer partial
+     */
+    void setValid(size_t offset, size_t length);
+
+    /** 
+     * Returns the smallest block-aligned <offset,length> range that covers all of the
+     * non-valid (and non-dirty) data within the given byte range (length is 0 if all are valid)
+     */
+    [[nodiscard]] std::pair<size_t,size_t> getInvalidRange(size_t offset, size_t length) const;
+
 private:
 
+    /** Returns true if the given byte range [start,end) is entirely within one dirty range */
+    [[nodiscard]] bool isDirtyRange(size_t start, size_t end) const;
+    /** Returns true if the given block is valid, or its part within [start,end) is dirty */
+    [[nodiscard]] bool isBlockReadable(size_t block, size_t start, size_t end) const;
+
     // could use a std::vector with an Allocator instead of a raw buffer
     // but vector lies about its actual memory usage... size vs. capacity
 
@@ -54,6 +124,16 @@ private:
     char* mData;
     /** true if the page has dirty (un-flushed) data */
     bool mDirty { false };
+    /** true if the page is all zeroes with no memory allocated */
+    bool mSparse;
+    /** true if the page was fetched by read-ahead and not yet read (for CacheStats) */
+    bool mPrefetched { false };
+    /** The size of the blocks in mValid */
+    size_t mBlockSize { 0 };
+    /** Bitmap of valid blocks if partial, empty if fully valid */
+    std::vector<bool> mValid;
+    /** Written byte ranges if partial (coalesced) */
+    DirtyRanges mDirtyRanges;
 };
 
 } // namespace Filedata
@@ -1,4 +1,5 @@
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <memory>
@@ -6,6 +7,7 @@
 
 #include "Page.hpp"
 #include "PageBackend.hpp"
+#include "UploadStream.hpp"
 
 #include "andromeda/backend/BackendImpl.hpp"
 #include "andromeda/backend/RunnerInput.hpp"
@@ -18,9 +20,10 @@ namespace Filesystem {
 namespace Filedata {
 
 /*****************************************************/
-PageBackend::PageBackend(File& file, const std::string& fileID, uint64_t backendSize, const size_t pageSize) :
+PageBackend::PageBackend(File& file, const std::string& fileID, uint64_t backendSize, const Item::Date backendModified, const size_t pageSize) :
     mPageSize(pageSize),
     mBackendSize(backendSize),
+    mBackendModified(backendModified),
     mBackendExists(true),
     mFile(file),
     mFileID(fileID),
@@ -40,9 +43,12 @@ PageBackend::PageBackend(File& file, const std::string& fileID, const size_t pag
     mBackend(file.GetBackend()),
     mDebug(__func__,this) { }
 
+/*****************************************************/
+PageBackend::~PageBackend() = default;
+
 /*****************************************************/
 size_t PageBackend::FetchPages(const uint64_t index, const size_t count, 
-    const PageBackend::PageHandler& pageHandler, const SharedLock& thisLock)
+    const PageBackend::PageHandler& pageHandler, const SharedLock& thisLock, const CancelFlag& cancel)
 {
     MDBG_INFO("(index:" << index << " count:" << count << ")");
 
@@ -58,10 +64,15 @@ size_t PageBackend::FetchPages(const uint64_t index, const size_t count,
     uint64_t curIndex { index };
     std::unique_ptr<Page> curPage;
 
+    if (cancel && *cancel) throw FetchCancelledException();
+
     const char* const fname { __func__ }; // for lambda
     mBackend.ReadFile(mFileID, pageStart, readSize, 
         [&](const size_t roffset, const char* rbuf, const size_t rlength)->void
     {
+        // throwing out of the stream callback drops the connection rather than reading the rest
+        if (cancel && *cancel) throw FetchCancelledException();
+
         // this is basically the same as the File::WriteBytes() algorithm
         for (uint64_t rbyte { roffset }; rbyte < roffset+rlength; )
         {
@@ -100,6 +111,24 @@ size_t PageBackend::FetchPages(const uint64_t index, const size_t count,
     return readSize;
 }
 
+/*****************************************************/
+void PageBackend::FetchRange(const uint64_t index, const size_t offset, const size_t length, 
+    const PageBackend::RangeHandler& rangeHandler, const SharedLock& thisLock)
+{
+    MDBG_INFO("(index:" << index << " offset:" << offset << " length:" << length << ")");
+
+    const uint64_t readStart { index*mPageSize + offset };
+    if (!length || offset+length > mPageSize || readStart+length > mBackendSize)
+        { MDBG_ERROR("() ERROR invalid range readStart:" << readStart << " length:" << length
+            << " mBackendSize:" << mBackendSize << " mPageSize:" << mPageSize); assert(false); }
+
+    mBackend.ReadFile(mFileID, readStart, length, 
+        [&](const size_t roffset, const char* rbuf, const size_t rlength)->void
+    {
+        rangeHandler(offset+roffset, rbuf, rlength);
+    });
+}
+
 /*****************************************************/
 size_t PageBackend::FlushPageList(const uint64_t index, const PageBackend::PagePtrList& pages, const SharedLockW& thisLock)
 {
@@ -114,6 +143,16 @@ size_t PageBackend::FlushPageList(const uint64_t index, const PageBackend::PageP
     const uint64_t writeStart { index*mPageSize };
     MDBG_INFO("... WRITING " << totalSize << " to " << writeStart);
 
+    if (mUploadStream)
+    {
+        if (writeStart != mStreamedSize)
+            { MDBG_ERROR("... invalid write for stream!"); assert(false); }
+
+        for (const Page* pagePtr : pages)
+            StreamPage(*pagePtr, thisLock);
+        return totalSize; // FlushCreate() will finish
+    }
+
     const FSConfig::WriteMode writeMode { mFile.GetWriteMode() };
     if (writeMode == FSConfig::WriteMode::UPLOAD && mBackendExists)
         { MDBG_ERROR("... invalid write for UPLOAD!"); assert(false); }
@@ -138,31 +177,95 @@ size_t PageBackend::FlushPageList(const uint64_t index, const PageBackend::PageP
         const size_t pageSize { page.size() };
         if (pageOffset >= pageSize) return false;
 
-        const char* copyData { page.data()+pageOffset };
         written = std::min(pageSize-pageOffset,buflen);
-        std::copy(copyData, copyData+written, buf); 
+        if (page.isSparse()) std::fill(buf, buf+written, 0);
+        else
+        {
+            const char* copyData { page.data()+pageOffset };
+            std::copy(copyData, copyData+written, buf);
+        }
         return true; // initial check will catch when we're done
     }};
 
     if (!mBackendExists)
     {
         const bool oneshot { mFile.GetWriteMode() < FSConfig::WriteMode::APPEND };
-        mFile.Refresh(mUploadFunc(mFile.GetName(thisLock),writeFunc,oneshot),thisLock);
+        mFile.Refresh(mUploadFunc(mFile.GetName(thisLock),writeFunc,oneshot,false),thisLock);
         mBackendExists = true;
     }
-    else mBackend.WriteFile(mFileID, writeStart, writeFunc);
+    else UpdateModified(mBackend.WriteFile(mFileID, writeStart, writeFunc));
 
     mBackendSize = std::max(mBackendSize, writeStart+totalSize);
 
     return totalSize;
 }
 
+/*****************************************************/
+size_t PageBackend::FlushRanges(const uint64_t index, const Page& page, const SharedLockW& thisLock)
+{
+    MDBG_INFO("(index:" << index << " ranges:" << page.getDirtyRanges().size() << ")");
+
+    if (!mBackendExists || mFile.GetWriteMode() < FSConfig::WriteMode::RANDOM)
+        { MDBG_ERROR("... invalid range write!"); assert(false); return 0; }
+
+    size_t totalSize { 0 };
+    for (const Page::DirtyRanges::value_type& range : page.getDirtyRanges())
+    {
+        const size_t rangeStart { range.first };
+        const size_t rangeSize { range.second - range.first };
+
+        const WriteFunc writeFunc { [&](const size_t offset, char* const buf, const size_t buflen, size_t& written)->bool
+        {
+            written = (offset < rangeSize) ? std::min(rangeSize-offset, buflen) : 0;
+            if (!written) return false;
+
+            const char* copyData { page.data()+rangeStart+offset };
+            std::copy(copyData, copyData+written, buf);
+            return true;
+        }};
+
+        const uint64_t writeStart { index*mPageSize + rangeStart };
+        MDBG_INFO("... WRITING " << rangeSize << " to " << writeStart);
+        UpdateModified(mBackend.WriteFile(mFileID, writeStart, writeFunc));
+
+        mBackendSize = std::max(mBackendSize, writeStart+rangeSize);
+        totalSize += rangeSize;
+    }
+
+    return totalSize;
+}
+
+/*****************************************************/
+void PageBackend::UpdateModified(const nlohmann::json& data)
+{
+    try
+    {
+        const nlohmann::json& modifiedJ(data.at("dates").at("modified"));
+        if (!modifiedJ.is_null()) modifiedJ.get_to(mBackendModified);
+        MDBG_INFO("(modified:" << mBackendModified << ")");
+    }
+    catch (const nlohmann::json::exception& ex) {
+        // not fatal, the next refresh will just see a new version and drop clean pages
+        MDBG_ERROR("... " << ex.what()); }
+}
+
 /*****************************************************/
 void PageBackend::FlushCreate(const SharedLockW& thisLock)
 {
     MDBG_INFO("()");
 
-    if (!mBackendExists)
+    if (mUploadStream)
+    {
+        MDBG_INFO("... finishing stream, size:" << mStreamedSize);
+        mFile.Refresh(mUploadStream->Finish(),thisLock); // keep if failed
+        mUploadStream.reset();
+        mBackendExists = true;
+
+        // the streamed data can now be read back from the backend
+        mBackendSize = mStreamedSize;
+        mStreamedSize = 0;
+    }
+    else if (!mBackendExists)
     {
         mFile.Refresh(mCreateFunc(mFile.GetName(thisLock)),thisLock);
         mBackendExists = true;
@@ -170,14 +273,51 @@ void PageBackend::FlushCreate(const SharedLockW& thisLock)
     else { MDBG_INFO("... !mBackendExists, ignoring"); }
 }
 
+/*****************************************************/
+void PageBackend::StartStream(const size_t bufferSize, const SharedLockW& thisLock)
+{
+    MDBG_INFO("(bufferSize:" << bufferSize << ")");
+
+    if (mBackendExists || mUploadStream)
+        { MDBG_ERROR("... invalid stream start!"); assert(false); return; }
+
+    const std::string name { mFile.GetName(thisLock) };
+    const bool oneshot { mFile.GetWriteMode() < FSConfig::WriteMode::APPEND };
+    const File::UploadFunc& uploadFunc { mUploadFunc };
+
+    // the name is fixed when the upload starts - renaming or moving the file flushes it first
+    // the backend sends chunks of at most bufferSize, so keeping that much lets it retry a chunk
+    mUploadStream = std::make_unique<UploadStream>(bufferSize, bufferSize, 
+        [uploadFunc, name, oneshot](const WriteFunc& writeFunc){
+            return uploadFunc(name, writeFunc, oneshot, true); });
+    mStreamedSize = 0;
+}
+
+/*****************************************************/
+void PageBackend::StreamPage(const Page& page, const SharedLockW& thisLock)
+{
+    MDBG_INFO("(offset:" << mStreamedSize << " size:" << page.size() << ")");
+
+    if (!mUploadStream || mStreamedSize % mPageSize)
+        { MDBG_ERROR("... invalid stream write!"); assert(false); return; }
+
+    mUploadStream->Write(page.isSparse() ? nullptr : page.data(), page.size());
+    mStreamedSize += page.size();
+}
+
 /*****************************************************/
 void PageBackend::Truncate(const uint64_t newSize, const SharedLockW& thisLock)
 {
     MDBG_INFO("(oldSize:" << mBackendSize << ", newSize:" << newSize << ")");
 
+    // chunks of the upload may already be on the backend, so aborting would leave 
+    // a partial file behind - finish it then truncate it like any existing file
+    if (mUploadStream && newSize < mStreamedSize)
+        FlushCreate(thisLock);
+
     if (mBackendExists && mBackendSize != newSize)
     {
-        mBackend.TruncateFile(mFileID, newSize); 
+        UpdateModified(mBackend.TruncateFile(mFileID, newSize));
         mBackendSize = newSize;
     }
     else { MDBG_INFO("... !mBackendExists or unchanged, ignoring"); }
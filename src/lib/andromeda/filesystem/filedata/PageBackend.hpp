@@ -2,13 +2,17 @@
 #ifndef LIBA2_PAGEBACKEND_H_
 #define LIBA2_PAGEBACKEND_H_
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <list>
+#include <memory>
+#include "nlohmann/json_fwd.hpp"
 
 #include "andromeda/common.hpp"
 #include "andromeda/Debug.hpp"
 #include "andromeda/SharedMutex.hpp"
+#include "andromeda/backend/BackendException.hpp"
 #include "andromeda/filesystem/File.hpp"
 
 namespace Andromeda {
@@ -19,6 +23,7 @@ namespace Filesystem {
 namespace Filedata {
 
 class Page;
+class UploadStream;
 
 /** return the size_t min of a (uint64_t and size_t) */
 static inline size_t min64st(uint64_t s1, size_t s2) {
@@ -38,9 +43,10 @@ public:
      * @param file reference to the parent file
      * @param fileID reference to the file's backend ID
      * @param backendSize current size of the file on the backend
+     * @param backendModified current modified time of the file on the backend
      * @param pageSize size of pages to use (const)
      */
-    PageBackend(File& file, const std::string& fileID, uint64_t backendSize, size_t pageSize);
+    PageBackend(File& file, const std::string& fileID, uint64_t backendSize, Item::Date backendModified, size_t pageSize);
 
     /** 
      * Construct a new file page backend for a file that doesn't exist yet
@@ -53,31 +59,66 @@ public:
     PageBackend(File& file, const std::string& fileID, size_t pageSize,
       const File::CreateFunc& createFunc, const File::UploadFunc& uploadFunc);
     
-    ~PageBackend() = default;
+    ~PageBackend(); // aborts any streaming upload
     DELETE_COPY(PageBackend)
     DELETE_MOVE(PageBackend)
 
     /** Returns true iff the file exists on the backend */
     [[nodiscard]] bool ExistsOnBackend(const SharedLock& thisLock) const { return mBackendExists; }
 
+    /** Returns the file's backend ID (if it exists) */
+    [[nodiscard]] const std::string& GetFileID(const SharedLock& thisLock) const { return mFileID; }
+
     /** Returns the file size on the backend (if it exists) */
     [[nodiscard]] uint64_t GetBackendSize(const SharedLock& thisLock) const { return mBackendSize; }
 
     /** Inform us that the size on the backend has changed */
     void SetBackendSize(uint64_t backendSize, const SharedLockW& thisLock) { mBackendSize = backendSize; }
 
+    /** 
+     * Returns the file modified time on the backend that our pages match
+     * Together with the backend size, this is the version of the file we have cached
+     */
+    [[nodiscard]] Item::Date GetBackendModified(const SharedLock& thisLock) const { return mBackendModified; }
+
+    /** Inform us that the modified time on the backend has changed */
+    void SetBackendModified(Item::Date backendModified, const SharedLockW& thisLock) { mBackendModified = backendModified; }
+
     /** Callback used to process fetched pages in FetchPages() */
     using PageHandler = std::function<void (const uint64_t, Page&&)>;
 
+    /** Shared flag that is set to abort a FetchPages() in progress */
+    using CancelFlag = std::shared_ptr<std::atomic<bool>>;
+
+    /** Exception indicating that a FetchPages() was aborted by its CancelFlag */
+    class FetchCancelledException : public Backend::BackendException { public:
+        FetchCancelledException() : BackendException("Fetch Cancelled") {}; };
+
     /** 
      * Reads pages from the backend (must mBackendExists!)
      * @param index the page index to start from
      * @param count the number of pages to read
      * @param pageHandler callback for handling constructed pages
+     * @param cancel if not null, checked before each received chunk - aborts the download if set
      * @return the total number of bytes read from the backend
+     * @throws FetchCancelledException if cancel was set (pages already handled are kept)
      * @throws BackendException for backend issues
      */
-    size_t FetchPages(uint64_t index, size_t count, const PageHandler& pageHandler, const SharedLock& thisLock);
+    size_t FetchPages(uint64_t index, size_t count, const PageHandler& pageHandler, 
+        const SharedLock& thisLock, const CancelFlag& cancel = nullptr);
+
+    /** Callback used to process fetched data in FetchRange() - args are (page offset, buffer, length) */
+    using RangeHandler = std::function<void (size_t, const char*, size_t)>;
+
+    /** 
+     * Reads a byte range within a single page from the backend (must mBackendExists!)
+     * @param index the page index to read from
+     * @param offset the offset within the page to start from
+     * @param length the number of bytes to read (must be within mBackendSize)
+     * @param rangeHandler callback for handling the data
+     * @throws BackendException for backend issues
+     */
+    void FetchRange(uint64_t index, size_t offset, size_t length, const RangeHandler& rangeHandler, const SharedLock& thisLock);
 
     /** Vector of **consecutive** non-null page pointers */
     using PagePtrList = std::vector<Page*>;
@@ -92,24 +133,63 @@ public:
      */
     size_t FlushPageList(uint64_t index, const PagePtrList& pages, const SharedLockW& thisLock);
 
+    /** 
+     * Writes only the dirty ranges of a single partial page (must mBackendExists and RANDOM write mode)
+     * @param index the index of the page
+     * @param page the partial page to flush (see Page::getDirtyRanges)
+     * @return the total number of bytes written to the backend
+     * @throws BackendException for backend issues
+     */
+    size_t FlushRanges(uint64_t index, const Page& page, const SharedLockW& thisLock);
+
     /** 
      * Creates the file on the backend if not mBackendExists and feeds to file.Refresh()
+     * If a streaming upload is running, finishes it instead (it remains failed if it throws)
      * @throws BackendException for backend issues
      */
     void FlushCreate(const SharedLockW& thisLock);
 
+    /** Returns true if a streaming upload is running (see StartStream) */
+    [[nodiscard]] bool isStreaming(const SharedLock& thisLock) const { return mUploadStream != nullptr; }
+
+    /** Returns the number of bytes sent to the streaming upload, which can't be read or written again until it finishes */
+    [[nodiscard]] uint64_t GetStreamedSize(const SharedLock& thisLock) const { return mStreamedSize; }
+
+    /** 
+     * Starts uploading the file in the background, fed by StreamPage() (must not mBackendExists)
+     * Later calls to FlushPageList() also feed the stream and FlushCreate() finishes it
+     * @param bufferSize the maximum number of bytes to buffer before StreamPage() blocks
+     */
+    void StartStream(size_t bufferSize, const SharedLockW& thisLock);
+
+    /** 
+     * Sends the next page to the streaming upload, blocking while its buffer is full
+     * @param page the page to send - must be full size unless it is the last
+     * @throws BackendException if the upload failed
+     */
+    void StreamPage(const Page& page, const SharedLockW& thisLock);
+
     /** 
      * Tell the backend to truncate to the given size, if mBackendExists
+     * Finishes the streaming upload first if truncating before its end (to zero in APPEND mode)
      * @throws BackendException for backend issues
      */
     void Truncate(uint64_t newSize, const SharedLockW& thisLock);
 
 private:
 
+    /** 
+     * Updates mBackendModified from the file JSON returned by our own write
+     * Our pages already match the new content so this must not invalidate them
+     */
+    void UpdateModified(const nlohmann::json& data);
+
     /** The size of each page - see description in ConfigOptions */
     const size_t mPageSize;
     /** The file size as far as the backend knows (0 if it doesn't exist) */
     uint64_t mBackendSize;
+    /** The file modified time on the backend, including from our own writes */
+    Item::Date mBackendModified { 0 };
 
     /** true iff the file has been created on the backend (false if waiting for flush) */
     bool mBackendExists;
@@ -117,6 +197,10 @@ private:
     const File::CreateFunc mCreateFunc;
     /** Function to upload the file if not mBackendExists */
     const File::UploadFunc mUploadFunc;
+    /** The streaming upload if running, null if not */
+    std::unique_ptr<UploadStream> mUploadStream;
+    /** The number of bytes sent to mUploadStream */
+    uint64_t mStreamedSize { 0 };
 
     /** Reference to the parent file */
     File& mFile;
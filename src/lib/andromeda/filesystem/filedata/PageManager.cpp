@@ -4,6 +4,7 @@
 #include <cstring>
 #include <limits>
 #include <utility>
+#include <vector>
 
 #include "CacheManager.hpp"
 #include "Page.hpp"
@@ -13,6 +14,11 @@
 #include "andromeda/backend/BackendException.hpp"
 using Andromeda::Backend::BackendException;
 #include "andromeda/backend/BackendImpl.hpp"
+#include "andromeda/backend/BandwidthEstimator.hpp"
+#include "andromeda/backend/RunnerPool.hpp"
+using Andromeda::Backend::RunnerPool;
+#include "andromeda/backend/WorkerPool.hpp"
+using Andromeda::Backend::WorkerPool;
 #include "andromeda/filesystem/File.hpp"
 #include "andromeda/filesystem/Folder.hpp"
 #include "andromeda/filesystem/Item.hpp"
@@ -27,12 +33,25 @@ PageManager::PageManager(File& file, const uint64_t fileSize, const size_t pageS
     mFile(file),
     mBackend(file.GetBackend()),
     mCacheMgr(mBackend.GetCacheManager()),
+    mDiskCache((mCacheMgr && !mBackend.isMemory()) ? mCacheMgr->GetDiskCache() : nullptr),
+    mCompressedCache((mCacheMgr && !mBackend.isMemory()) ? mCacheMgr->GetCompressedCache() : nullptr),
+    mCacheStats(mCacheMgr ? &mCacheMgr->GetCacheStats() : nullptr),
     mPageSize(pageSize), 
     mFileSize(fileSize), 
     mBandwidth(__func__, mBackend.GetOptions().readAheadTime),
+    mAccessPattern(__func__),
     mPageBackend(pageBackend)
 { 
     MDBG_INFO("(file:" << &file << ", size:" << fileSize << ", pageSize:" << pageSize << ")");
+
+    // start from the backend-wide estimate rather than single pages, then refine per-file
+    const size_t targetBytes { mBackend.GetBandwidth().GetTargetBytes(mBackend.GetOptions().readAheadTime) };
+    if (targetBytes)
+    {
+        const UniqueLock llock(mFetchSizeMutex);
+        mBandwidth.SetTargetBytes(targetBytes);
+        SetFetchSize(targetBytes, llock);
+    }
 }
 
 /*****************************************************/
@@ -42,13 +61,19 @@ PageManager::~PageManager()
 
     const Item::DeleteLock deleteLock(mScopeMutex); // exclusive
 
-    // once we have the deleteLock, no NEW fetch threads can start, wait for existing
-    const std::unique_lock<std::shared_mutex> fetchLock(mFetchMutex);
+    { // once we have the deleteLock, no NEW fetches can start - drop queued ones and wait for running
+        UniqueLock pagesLock(mPagesMutex);
+        mFetchTasks -= mBackend.GetWorkerPool().CancelQueued(this);
+        for (PendingMap::value_type& pend : mPendingPages) // abort running downloads early
+            if (pend.second.value) *pend.second.value = true;
+        while (mFetchTasks) mPagesCV.wait(pagesLock);
+    }
 
     if (mCacheMgr != nullptr)
     {
         for (const PageMap::value_type& it : mPages)
-            mCacheMgr->RemovePage(it.second);
+            mCacheMgr->RemovePage(*this, it.second);
+        mCacheMgr->RemovePageManager(*this);
     }
 
     MDBG_INFO("... returning!");
@@ -61,9 +86,10 @@ void PageManager::ReadPage(char* buffer, const uint64_t index, const size_t offs
 
     if (index*mPageSize + offset+length > mFileSize) { MDBG_ERROR("... invalid read!"); assert(false); }
 
-    const Page& page { GetPageRead(index, thisLock) };
+    const Page& page { GetPageRead(index, offset, length, thisLock) };
 
-    std::memcpy(buffer, page.data()+offset, length);
+    if (page.isSparse()) std::memset(buffer, 0, length);
+    else std::memcpy(buffer, page.data()+offset, length);
 }
 
 /*****************************************************/
@@ -85,55 +111,157 @@ void PageManager::WritePage(const char* buffer, const uint64_t index, const size
     page.setDirty();
 
     std::memcpy(page.data()+offset, buffer, length);
+    page.addDirtyRange(offset, length); // if partial
+
+    StreamPages(thisLock);
+}
+
+/*****************************************************/
+void PageManager::WriteHole(const uint64_t newSize, const SharedLockW& thisLock)
+{
+    MDBG_INFO("(" << mFile.GetName(thisLock) << ")" << " (oldSize:" << mFileSize << " newSize:" << newSize << ")");
+
+    if (newSize <= mFileSize) return; // no hole
+
+    // the old last page has real data, so fill the rest of it with real zeroes
+    const size_t pageError { static_cast<size_t>(mFileSize % mPageSize) };
+    if (pageError != 0)
+    {
+        const size_t fillSize { min64st(newSize-mFileSize, mPageSize-pageError) };
+        const std::vector<char> zeroBuf(fillSize, 0);
+        WritePage(zeroBuf.data(), mFileSize/mPageSize, pageError, fillSize, thisLock);
+    }
+
+    // all further pages are entirely zero and need no memory until written
+    for (uint64_t index { mFileSize/mPageSize }; mFileSize < newSize; ++index)
+    {
+        const size_t pageSize { min64st(newSize-index*mPageSize, mPageSize) };
+        MDBG_INFO("... create sparse page:" << index << " size:" << pageSize);
+
+        // mDirty is set LAST since InformNewPageWrite() may cause a synchronous flush
+        Page& newPage { mPages.try_emplace(index, pageSize, mBackend.GetPageAllocator(), true).first->second };
+        InformNewPageWrite(index, newPage, true, thisLock);
+        mFileSize = index*mPageSize + pageSize; // extend file
+        newPage.setDirty();
+    }
 }
 
 /*****************************************************/
-const Page& PageManager::GetPageRead(const uint64_t index, const SharedLock& thisLock)
+const Page& PageManager::GetPageRead(const uint64_t index, const size_t offset, const size_t length, const SharedLock& thisLock)
 {
-    MDBG_INFO("(" << mFile.GetName(thisLock) << ")" << " (index:" << index << ")");
+    MDBG_INFO("(" << mFile.GetName(thisLock) << ")" << " (index:" << index << " offset:" << offset << " length:" << length << ")");
 
     if (index*mPageSize >= mFileSize) { MDBG_ERROR("... invalid read!"); assert(false); }
 
     UniqueLock pagesLock(mPagesMutex);
+    mAccessPattern.Access(index);
+    if (mAccessPattern.isJump()) 
+        CancelStaleFetches(index, pagesLock);
 
-    { const PageMap::const_iterator it { mPages.find(index) };
+    { const PageMap::iterator it { mPages.find(index) };
     if (it != mPages.end()) 
     {
+        Page& page { it->second };
+        mCacheStats.AddHit();
+        if (page.isPrefetched())
+        {
+            mCacheStats.AddReadAheadUsed();
+            page.setPrefetched(false);
+        }
+
+        if (page.isPartial()) // fill in the range if needed
+            FetchPartial(index, page, offset, length, thisLock, pagesLock);
+
         DoAdvanceRead(index, thisLock, pagesLock);
 
         MDBG_INFO("... return existing page");
-        const Page& page { it->second };
         
         if (mCacheMgr && !mBackend.isMemory()) 
             mCacheMgr->InformPage(*this, index, page, page.isDirty());
         return page;
     } }
 
-    if (!isFetchPending(index, pagesLock))
+    const bool wasPending { isFetchPending(index, pagesLock) };
+    if (wasPending) mCacheStats.AddPendingWait();
+    else
     {
         const size_t fetchSize { GetFetchSize(index, thisLock, pagesLock) };
         if (!fetchSize) // must be between backend end and dirty write, create empty
         {
-            MDBG_INFO("... create empty page");
-            Page& newPage { mPages.try_emplace(index, 0, mBackend.GetPageAllocator()).first->second };
-            
-            ResizePage(newPage, mPageSize, false); // zeroize
+            MDBG_INFO("... create sparse page");
+            Page& newPage { mPages.try_emplace(index, mPageSize, mBackend.GetPageAllocator(), true).first->second };
+
             // hold pagesLock because if inform fails, we will remove this page
             // use non-synchronous InformNewPageRead() so holding pagesLock is okay
-            InformNewPageRead(index, newPage, false, true, pagesLock);
+            InformNewPageRead(index, newPage, false, true, false, pagesLock);
             return newPage;
         }
-        else StartFetch(index, fetchSize, pagesLock);
+        else if (isPartialFetch(index, thisLock, pagesLock))
+        {
+            MDBG_INFO("... create partial page");
+            const size_t pageSize { min64st(mFileSize-index*mPageSize, mPageSize) };
+            Page& newPage { mPages.try_emplace(index, pageSize, mBackend.GetPageAllocator()).first->second };
+
+            newPage.setPartial(mBackend.GetOptions().subPageSize);
+            mCacheStats.AddMiss();
+            InformNewPageRead(index, newPage, false, true, false, pagesLock);
+            FetchPartial(index, newPage, offset, length, thisLock, pagesLock);
+            return newPage;
+        }
+        else
+        {
+            // fetch the missing page by itself so the caller does not wait behind the read-ahead
+            // window's stream (or queue), with the read-ahead for the following pages running alongside
+            MDBG_INFO("... fetching first page " << index);
+            mCacheStats.AddMiss();
+            mPendingPages.assign(index, 1, nullptr);
+
+            CancelList readAhead;
+            if (mAccessPattern.GetType() != AccessPattern::Type::SEQUENTIAL)
+                DoAdvanceRead(index, thisLock, pagesLock, &readAhead);
+            else if (index > 0 && (index+1)*mPageSize < mFileSize)
+            {
+                // start the window right after this page, even with no readAheadBuffer
+                const size_t aheadSize { GetFetchSize(index+1, thisLock, pagesLock) };
+                if (aheadSize) StartFetch(index+1, aheadSize, pagesLock, &readAhead);
+            }
+
+            pagesLock.unlock();
+            FetchPages(index, 1);
+            pagesLock.lock();
+
+            if (isFetchFailed(index, pagesLock)) // likely to fail too, don't wait for it
+                for (const PageBackend::CancelFlag& cancel : readAhead) *cancel = true;
+        }
     }
 
-    PageMap::const_iterator it;
+    PageMap::iterator it;
     std::exception_ptr fail;
 
     while ((it = mPages.find(index)) == mPages.end() &&
             !(fail = isFetchFailed(index, pagesLock)))
     {
-        MDBG_INFO("... waiting for pending " << index);
-        mPagesCV.wait(pagesLock);
+        if (!isFetchPending(index, pagesLock))
+        {
+            // the fetch was dropped as the worker queue is full, do it ourselves
+            MDBG_INFO("... fetching synchronously " << index);
+            mPendingPages.assign(index, 1, nullptr);
+            pagesLock.unlock();
+            FetchPages(index, 1);
+            pagesLock.lock();
+            continue; // check again
+        }
+
+        // run one of our queued fetches ourselves rather than wait for a worker to start it
+        pagesLock.unlock();
+        const bool ranFetch { mBackend.GetWorkerPool().RunQueued(this) };
+        pagesLock.lock();
+
+        if (!ranFetch && mPages.find(index) == mPages.end() && !isFetchFailed(index, pagesLock))
+        {
+            MDBG_INFO("... waiting for pending " << index);
+            mPagesCV.wait(pagesLock);
+        }
     }
 
     if (fail != nullptr)
@@ -143,7 +271,12 @@ const Page& PageManager::GetPageRead(const uint64_t index, const SharedLock& thi
     }
 
     MDBG_INFO("... returning pended page " << index);
-    const Page& page { it->second };
+    Page& page { it->second };
+    if (page.isPrefetched())
+    {
+        if (wasPending) mCacheStats.AddReadAheadUsed(); // else we fetched it ourselves
+        page.setPrefetched(false);
+    }
 
     if (mCacheMgr && !mBackend.isMemory()) 
         mCacheMgr->InformPage(*this, index, page, page.isDirty());
@@ -159,6 +292,10 @@ Page& PageManager::GetPageWrite(const uint64_t index, const size_t pageSize, con
     if (it != mPages.end())
     {
         MDBG_INFO("... returning existing page");
+        if (pageSize > it->second.size()) // writes within are tracked as dirty ranges
+            FetchPartialAll(index, it->second, thisLock);
+        it->second.materialize();
+        it->second.setPrefetched(false); // written, not read
         InformResizePage(index, it->second, true, pageSize, thisLock);
         return it->second;
     } }
@@ -173,7 +310,11 @@ Page& PageManager::GetPageWrite(const uint64_t index, const size_t pageSize, con
         {
             // extend the old last page if necessary
             const PageMap::iterator it { mPages.find((mFileSize-1)/mPageSize) };
-            if (it != mPages.end()) ResizePage(it->second, mPageSize, true, &thisLock);
+            if (it != mPages.end())
+            {
+                FetchPartialAll(it->first, it->second, thisLock);
+                ResizePage(it->second, mPageSize, true, &thisLock);
+            }
         }
 
         MDBG_INFO("... create empty page");
@@ -183,6 +324,15 @@ Page& PageManager::GetPageWrite(const uint64_t index, const size_t pageSize, con
         return newPage;
     }
 
+    if (isPartialWrite(index, pageSize, thisLock))
+    {
+        MDBG_INFO("... partial write, create partial page");
+        Page& newPage { mPages.try_emplace(index, pageSize, mBackend.GetPageAllocator()).first->second };
+        newPage.setPartial(mBackend.GetOptions().subPageSize);
+        InformNewPageWrite(index, newPage, true, thisLock);
+        return newPage;
+    }
+
     MDBG_INFO("... partial write, reading single");
     Page* newPage = nullptr; mPageBackend.FetchPages(index, 1, // read a single page
         [&](const uint64_t pageIndex, Page&& page)
@@ -197,13 +347,133 @@ Page& PageManager::GetPageWrite(const uint64_t index, const size_t pageSize, con
 }
 
 /*****************************************************/
-void PageManager::InformNewPageRead(const uint64_t index, const Page& page, bool dirty, bool canWait, const UniqueLock& pagesLock)
+void PageManager::StreamPages(const SharedLockW& thisLock)
+{
+    const size_t bufferSize { mBackend.GetOptions().uploadStreamBuffer };
+    if (!bufferSize || mBackend.isMemory() || mPageBackend.ExistsOnBackend(thisLock) ||
+        mFile.GetWriteMode() >= FSConfig::WriteMode::RANDOM) return;
+
+    // a page is only sent once the next one has been written to, allowing small seeks back
+    for (uint64_t index { mPageBackend.GetStreamedSize(thisLock)/mPageSize }; 
+        mFileSize > (index+1)*mPageSize; ++index)
+    {
+        const PageMap::iterator it { mPages.find(index) };
+        if (it == mPages.end() || !it->second.isDirty()) break; // not expected
+
+        if (!mPageBackend.isStreaming(thisLock))
+            mPageBackend.StartStream(bufferSize, thisLock);
+
+        MDBG_INFO("... streaming page " << index);
+        mPageBackend.StreamPage(it->second, thisLock);
+
+        it->second.setDirty(false);
+        if (mCacheMgr) mCacheMgr->RemovePage(*this, it->second);
+        mPages.erase(it);
+    }
+}
+
+/*****************************************************/
+bool PageManager::isPartialFetch(const uint64_t index, const SharedLock& thisLock, const UniqueLock& pagesLock)
+{
+    const size_t subPageSize { mBackend.GetOptions().subPageSize };
+    if (!subPageSize || subPageSize >= mPageSize || mBackend.isMemory()) return false;
+
+    if (mAccessPattern.GetType() != AccessPattern::Type::RANDOM) return false;
+
+    // a whole page from the compressed tier or disk cache is better than part of one from the backend
+    if (mCompressedCache && mCompressedCache->Contains(mPageBackend.GetFileID(thisLock), index)) return false;
+    if (mDiskCache && mDiskCache->Contains(mPageBackend.GetFileID(thisLock), index)) return false;
+
+    // the page must be entirely on the backend, else it was extended by a write
+    const uint64_t pageStart { index*mPageSize };
+    const uint64_t backendSize { mPageBackend.GetBackendSize(thisLock) };
+    return pageStart < backendSize && 
+        min64st(backendSize-pageStart, mPageSize) == min64st(mFileSize-pageStart, mPageSize);
+}
+
+/*****************************************************/
+bool PageManager::isPartialWrite(const uint64_t index, const size_t pageSize, const SharedLockW& thisLock)
+{
+    const size_t subPageSize { mBackend.GetOptions().subPageSize };
+    if (!subPageSize || subPageSize >= mPageSize || mBackend.isMemory()) return false;
+
+    if (mFile.GetWriteMode() < FSConfig::WriteMode::RANDOM) return false;
+
+    // the page must be entirely on the backend so unwritten bytes can be fetched later
+    const uint64_t pageStart { index*mPageSize };
+    const uint64_t backendSize { mPageBackend.GetBackendSize(thisLock) };
+    return pageStart < backendSize && pageSize == min64st(backendSize-pageStart, mPageSize);
+}
+
+/*****************************************************/
+void PageManager::FetchPartial(const uint64_t index, Page& page, const size_t offset, const size_t length, const SharedLock& thisLock, UniqueLock& pagesLock)
+{
+    while (mPartialFetches.find(index) != mPartialFetches.end())
+        mPagesCV.wait(pagesLock); // another thread is filling this page
+
+    const std::pair<size_t,size_t> range { page.getInvalidRange(offset, length) };
+    if (!range.second) return; // already valid
+
+    MDBG_INFO("(index:" << index << " offset:" << range.first << " length:" << range.second << ")");
+
+    // only copy into blocks that are invalid now - the valid ones may be being read
+    const size_t blockSize { page.getBlockSize() };
+    const size_t firstBlock { range.first/blockSize };
+    std::vector<bool> fillBlocks;
+    for (size_t block { firstBlock }; block*blockSize < range.first+range.second; ++block)
+        fillBlocks.push_back(!page.isBlockValid(block));
+
+    mPartialFetches.insert(index);
+    pagesLock.unlock();
+
+    try
+    {
+        mPageBackend.FetchRange(index, range.first, range.second,
+            [&](const size_t pageOffset, const char* buf, const size_t bufSize)
+        {
+            for (size_t start { pageOffset }; start < pageOffset+bufSize; )
+            {
+                const size_t block { start/blockSize };
+                const size_t end { std::min((block+1)*blockSize, pageOffset+bufSize) };
+                if (fillBlocks[block-firstBlock]) // never overwrite dirty ranges
+                    page.fillClean(start, buf+(start-pageOffset), end-start);
+                start = end;
+            }
+        }, thisLock);
+    }
+    catch (...) // any failure, else other readers of this page wait forever
+    {
+        MDBG_ERROR("... fetch failed");
+        pagesLock.lock();
+        mPartialFetches.erase(index);
+        mPagesCV.notify_all();
+        throw;
+    }
+
+    pagesLock.lock();
+    page.setValid(range.first, range.second);
+    mPartialFetches.erase(index);
+    mPagesCV.notify_all();
+}
+
+/*****************************************************/
+void PageManager::FetchPartialAll(const uint64_t index, Page& page, const SharedLockW& thisLock)
+{
+    if (!page.isPartial()) return;
+
+    MDBG_INFO("(index:" << index << ")");
+    UniqueLock pagesLock(mPagesMutex);
+    FetchPartial(index, page, 0, page.size(), thisLock, pagesLock);
+}
+
+/*****************************************************/
+void PageManager::InformNewPageRead(const uint64_t index, const Page& page, bool dirty, bool canWait, bool lowPriority, const UniqueLock& pagesLock)
 {
     if (mCacheMgr && !mBackend.isMemory())
-        try { mCacheMgr->InformPage(*this, index, page, dirty, canWait); }
+        try { mCacheMgr->InformPage(*this, index, page, dirty, canWait, nullptr, lowPriority); }
     catch (const CacheManager::MemoryException& ex)
     {
-        mCacheMgr->RemovePage(page);
+        mCacheMgr->RemovePage(*this, page);
         mPages.erase(index); // undo memory usage
         throw; // rethrow
     }
@@ -216,7 +486,7 @@ void PageManager::InformNewPageWrite(const uint64_t index, const Page& page, boo
         try { mCacheMgr->InformPage(*this, index, page, dirty, true, &thisLock); }
     catch (const BaseException& ex) // MemoryException or BackendException
     {
-        mCacheMgr->RemovePage(page);
+        mCacheMgr->RemovePage(*this, page);
         mPages.erase(index); // undo memory usage
         throw; // rethrow
     }
@@ -247,7 +517,7 @@ void PageManager::ResizePage(Page& page, const size_t pageSize, bool cacheMgr, c
     MDBG_INFO("(pageSize:" << pageSize << ") oldSize:" << oldSize);
 
     page.resize(pageSize);
-    if (pageSize > oldSize) std::memset(
+    if (pageSize > oldSize && !page.isSparse()) std::memset(
         page.data()+oldSize, 0, pageSize-oldSize);
 
     if (cacheMgr && mCacheMgr) 
@@ -263,17 +533,14 @@ void PageManager::ResizePage(Page& page, const size_t pageSize, bool cacheMgr, c
 /*****************************************************/
 bool PageManager::isFetchPending(const uint64_t index, const UniqueLock& pagesLock)
 {
-    return std::any_of(mPendingPages.cbegin(), mPendingPages.cend(), 
-        [&](const decltype(mPendingPages)::value_type& pend){
-            return index >= pend.first && index < pend.first + pend.second;
-        });
+    return mPendingPages.contains(index);
 }
 
 /*****************************************************/
 std::exception_ptr PageManager::isFetchFailed(const uint64_t index, const UniqueLock& pagesLock)
 {
-    const FailureMap::iterator it { mFailedPages.find(index) };
-    return (it != mFailedPages.end()) ? it->second : nullptr;
+    const FailureMap::const_iterator it { mFailedPages.find(index) };
+    return (it != mFailedPages.end()) ? it->second.value : nullptr;
 }
 
 /*****************************************************/
@@ -281,22 +548,17 @@ void PageManager::RemovePendingFetch(const uint64_t index, bool idxOnly, const U
 {
     MDBG_INFO("(index:" << index << " idxOnly:" << BOOLSTR(idxOnly) << ")");
 
-    for (PendingMap::iterator pend { mPendingPages.begin() }; 
-        pend != mPendingPages.end(); ++pend)
+    const PendingMap::iterator pend { mPendingPages.find(index) };
+    if (pend == mPendingPages.end() || pend->first != index)
     {
-        if (index == pend->first)
-        {
-            ++pend->first; // index
-            --pend->second; // count
-
-            if (!idxOnly || !pend->second)
-                mPendingPages.erase(pend);
-
-            mPagesCV.notify_all(); return;
-        }
+        MDBG_ERROR("... page:" << index << " was not pending!"); return;
     }
 
-    MDBG_ERROR("... page:" << index << " was not pending!");
+    if (idxOnly) // the entry now starts at the next index
+        mPendingPages.erase(index, 1);
+    else mPendingPages.erase(pend);
+
+    mPagesCV.notify_all();
 }
 
 /*****************************************************/
@@ -318,7 +580,9 @@ size_t PageManager::GetFetchSize(const uint64_t index, const SharedLock& thisLoc
     if (mPages.find(index) != mPages.end()) return 0; // page exists
 
     // no read-ahead for the first page as file managers often read just metadata
-    size_t readCount { (index > 0) ? maxReadCount : 1 };
+    // also no read-ahead window unless sequential - see DoAdvanceRead() for other patterns
+    const bool sequential { mAccessPattern.GetType() == AccessPattern::Type::SEQUENTIAL };
+    size_t readCount { (index > 0 && sequential) ? maxReadCount : 1 };
 
     // stop before the next existing (pages are in order)
     { PageMap::const_iterator nextIt { mPages.upper_bound(index) };
@@ -328,119 +592,276 @@ size_t PageManager::GetFetchSize(const uint64_t index, const SharedLock& thisLoc
         readCount = min64st(nextIt->first-index, readCount);
     } }
 
-    // stop before the next pending
-    for (size_t curCount { 0 }; curCount < readCount; ++curCount)
+    // stop before the next pending (ranges are in order)
+    { const PendingMap::const_iterator pendIt { mPendingPages.lower_bound(index) };
+    if (pendIt != mPendingPages.end())
     {
-        if (isFetchPending(curCount+index, pagesLock))
-        {
-            MDBG_INFO("... pending page at:" << curCount+index);
-            readCount = curCount;
-            break; // pages are in order
-        }
-    }
+        const uint64_t pendIndex { std::max(pendIt->first, index) };
+        MDBG_INFO("... pending page at:" << pendIndex);
+        readCount = min64st(pendIndex-index, readCount);
+    } }
 
     return readCount;
 }
 
 /*****************************************************/
-void PageManager::DoAdvanceRead(const uint64_t index, const SharedLock& thisLock, const UniqueLock& pagesLock)
+void PageManager::DoAdvanceRead(const uint64_t index, const SharedLock& thisLock, const UniqueLock& pagesLock, CancelList* started)
 {
-    // TODO this probably doesn't play well with really small cache sizes
-    // always pre-populate mReadAheadPages ahead (except index 0)
-    if (!index) return;
-    for (uint64_t nextIdx { index+1 }; 
-        nextIdx <= index + mBackend.GetOptions().readAheadBuffer; ++nextIdx)
+    const size_t readAheadBuffer { mBackend.GetOptions().readAheadBuffer };
+
+    switch (mAccessPattern.GetType())
     {
-        if (nextIdx*mPageSize >= mFileSize) break; // exit loop
-        const size_t fetchSize { GetFetchSize(nextIdx, thisLock, pagesLock) };
-        if (fetchSize)
+        case AccessPattern::Type::SEQUENTIAL:
         {
-            MDBG_INFO("... advance read nextIdx:" << nextIdx << " fetchSize:" << fetchSize);
-            StartFetch(nextIdx, fetchSize, pagesLock);
-            break; // exit loop
-        }
+            // TODO this probably doesn't play well with really small cache sizes
+            // always pre-populate mReadAheadPages ahead (except index 0)
+            if (!index) return;
+            for (uint64_t nextIdx { index+1 }; 
+                nextIdx <= index + readAheadBuffer; ++nextIdx)
+            {
+                if (nextIdx*mPageSize >= mFileSize) break; // exit loop
+                const size_t fetchSize { GetFetchSize(nextIdx, thisLock, pagesLock) };
+                if (fetchSize)
+                {
+                    MDBG_INFO("... advance read nextIdx:" << nextIdx << " fetchSize:" << fetchSize);
+                    StartFetch(nextIdx, fetchSize, pagesLock, started);
+                    break; // exit loop
+                }
+            }
+        } break;
+
+        case AccessPattern::Type::STRIDED:
+        {
+            // fetch single pages at the next stride targets, limited by the sequential window
+            size_t maxTargets { std::max(static_cast<size_t>(1), readAheadBuffer) * GetFetchRunners() };
+            { const UniqueLock llock(mFetchSizeMutex); maxTargets = std::min(maxTargets, mFetchSize); }
+
+            const int64_t stride { mAccessPattern.GetStride() };
+            uint64_t nextIdx { index };
+            for (size_t target { 0 }; target < maxTargets; ++target)
+            {
+                // unsigned wraparound handles negative strides
+                if (stride < 0 && nextIdx < static_cast<uint64_t>(-stride)) break; // exit loop
+                nextIdx += static_cast<uint64_t>(stride);
+
+                if (nextIdx*mPageSize >= mFileSize) break; // exit loop
+                if (GetFetchSize(nextIdx, thisLock, pagesLock))
+                {
+                    MDBG_INFO("... stride read nextIdx:" << nextIdx);
+                    StartFetch(nextIdx, 1, pagesLock, started);
+                }
+            }
+        } break;
+
+        case AccessPattern::Type::REVERSE:
+        {
+            // find the first missing page behind us then fetch a window ending there
+            for (uint64_t prevIdx { index }; prevIdx > 0 && prevIdx+readAheadBuffer > index; )
+            {
+                --prevIdx;
+                if (!GetFetchSize(prevIdx, thisLock, pagesLock)) continue;
+
+                size_t fetchWindow { 0 };
+                { const UniqueLock llock(mFetchSizeMutex); fetchWindow = mFetchSize; }
+
+                uint64_t startIdx { prevIdx };
+                while (startIdx > 0 && prevIdx-startIdx+1 < fetchWindow &&
+                    GetFetchSize(startIdx-1, thisLock, pagesLock)) --startIdx;
+
+                MDBG_INFO("... reverse read startIdx:" << startIdx << " lastIdx:" << prevIdx);
+                StartFetch(startIdx, static_cast<size_t>(prevIdx-startIdx+1), pagesLock, started);
+                break; // exit loop
+            }
+        } break;
+
+        case AccessPattern::Type::RANDOM: break; // no read-ahead
     }
 }
 
 /*****************************************************/
-void PageManager::StartFetch(const uint64_t index, const size_t readCount, const UniqueLock& pagesLock)
+void PageManager::StartFetch(const uint64_t index, const size_t readCount, const UniqueLock& pagesLock, CancelList* started)
 {
     MDBG_INFO("(index:" << index << ", readCount:" << readCount << ")");
 
-    mPendingPages.emplace_back(index, readCount);
-
     if (!mFailedPages.empty())
     {
-        size_t erased { 0 };
-        for (uint64_t idx { index }; idx < index+readCount; ++idx)
-            erased += mFailedPages.erase(idx);
+        const uint64_t erased { mFailedPages.erase(index, readCount) };
         if (erased) MDBG_INFO("... reset " << erased << " failures");
     }
 
-    std::thread(&PageManager::FetchPages, this, index, readCount).detach();
+    // split the window into consecutive sub-ranges fetched in parallel by separate runners
+    // the first sub-range (containing the page that is needed first) is started first
+    const size_t fetchRunners { GetFetchRunners() };
+    const size_t chunkSize { (readCount + fetchRunners-1) / fetchRunners };
+
+    for (uint64_t chunkIdx { index }; chunkIdx < index+readCount; chunkIdx += chunkSize)
+    {
+        const size_t chunkCount { min64st(index+readCount-chunkIdx, chunkSize) };
+        MDBG_INFO("... chunkIdx:" << chunkIdx << " chunkCount:" << chunkCount);
+
+        const PageBackend::CancelFlag cancel { std::make_shared<std::atomic<bool>>(false) };
+        const bool queued { mBackend.GetWorkerPool().TrySubmit(WorkerPool::TaskType::FETCH, this,
+            [this, chunkIdx, chunkCount, cancel]()
+        {
+            const RunnerPool::PriorityScope priority(RunnerPool::Priority::READAHEAD);
+            FetchPages(chunkIdx, chunkCount, cancel);
+
+            const UniqueLock taskLock(mPagesMutex);
+            --mFetchTasks; mPagesCV.notify_all(); // destructor may be waiting
+        }) };
+
+        if (!queued) // queue is full, drop the rest of the read-ahead
+        {
+            MDBG_INFO("... worker queue full, dropped");
+            break; // exit loop
+        }
+
+        mPendingPages.assign(chunkIdx, chunkCount, cancel);
+        if (started != nullptr) started->push_back(cancel);
+        ++mFetchTasks;
+    }
+}
+
+/*****************************************************/
+void PageManager::CancelStaleFetches(const uint64_t index, const UniqueLock& pagesLock)
+{
+    size_t fetchWindow { 0 };
+    { const UniqueLock llock(mFetchSizeMutex); fetchWindow = mFetchSize; }
+
+    for (PendingMap::value_type& pend : mPendingPages)
+    {
+        const PageBackend::CancelFlag& cancel { pend.second.value };
+        if (!cancel || *cancel) continue; // synchronous or already cancelled
+
+        const uint64_t start { pend.first };
+        const bool wanted { (index >= start) ? (index < start+pend.second.count) : (start-index <= fetchWindow) };
+        if (wanted) continue;
+
+        MDBG_INFO("(index:" << index << ") cancel start:" << start << " count:" << pend.second.count);
+        *cancel = true; // the fetch removes its own pending range
+    }
 }
 
 /*****************************************************/
-void PageManager::FetchPages(const uint64_t index, const size_t count) noexcept // thread cannot throw
+void PageManager::FetchPages(const uint64_t index, const size_t count, const PageBackend::CancelFlag& cancel) noexcept // thread cannot throw
 {
     // use a read-priority lock since the caller is waiting on us, 
     // if another write happens in the middle we would deadlock
-    const SharedLockRP thisLock { GetReadPriLock() };
-
-    // lock fetch mutex so the destructor has to wait for us to finish
     // can't acquire the scope lock here because the destructor could already be waiting!
-    const std::shared_lock<std::shared_mutex> fetchLock(mFetchMutex);
+    // instead the destructor waits for mFetchTasks (see StartFetch)
+    const SharedLockRP thisLock { GetReadPriLock() };
 
     uint64_t curIndex { index }; try
     {
         MDBG_INFO("(index:" << index << " count:" << count << ")");
         const std::chrono::steady_clock::time_point timeStart { std::chrono::steady_clock::now() };
 
-        const size_t readSize { mPageBackend.FetchPages(index, count, 
-            [&](const uint64_t pageIndex, Page&& page)
+        // take what we can from the compressed tier or disk cache, in order as the pending range is trimmed from the front
+        if ((mCompressedCache || mDiskCache) && mPageBackend.ExistsOnBackend(thisLock))
         {
-            // if we are reading a page that is smaller on the backend (dirty writes), might need to extend
-            const uint64_t pageStart { index*mPageSize }; // offset of the page start
-            const size_t realSize { min64st(mFileSize-pageStart, mPageSize) };
-            if (page.size() < realSize) ResizePage(page, realSize, false);
-
-            const UniqueLock pagesLock(mPagesMutex);
-            // hold pagesLock because if inform fails, we will remove this page
-            const PageMap::iterator newIt { mPages.emplace(pageIndex, std::move(page)).first };
+            const DiskCache::Version version { GetDiskVersion(thisLock) };
+            for (; curIndex < index+count; ++curIndex)
+            {
+                Page page(0, mBackend.GetPageAllocator());
+                if (!(mCompressedCache && mCompressedCache->Load(version, curIndex, page)) &&
+                    !(mDiskCache && mDiskCache->Load(version, curIndex, page))) break;
+                AddFetchedPage(curIndex, std::move(page), thisLock);
+            }
+            if (curIndex > index) { MDBG_INFO("... loaded " << curIndex-index << " from compressed/disk cache"); }
+        }
 
-            InformNewPageRead(pageIndex, newIt->second, false, false, pagesLock);
-            // pass false to not wait - not allowed to call the backend for evict/flush within this callback
-            // even if canWait was true, the CacheManager could have us skip the wait to get our W lock for evict
-            RemovePendingFetch(pageIndex, true, pagesLock); 
+        if (curIndex < index+count)
+        {
+            const size_t readSize { mPageBackend.FetchPages(curIndex, index+count-curIndex, 
+                [&](const uint64_t pageIndex, Page&& page)
+            {
+                AddFetchedPage(pageIndex, std::move(page), thisLock);
+                ++curIndex;
+            }, thisLock, cancel) };
 
-            ++curIndex;
-        }, thisLock) };
+            if (readSize >= mPageSize) // don't consider small reads
+                UpdateBandwidth(readSize, std::chrono::steady_clock::now()-timeStart);
+        }
+    }
+    catch (const PageBackend::FetchCancelledException& ex)
+    {
+        MDBG_INFO("... " << ex.what() << " at " << curIndex);
+        const UniqueLock pagesLock(mPagesMutex);
 
-        if (readSize >= mPageSize) // don't consider small reads
-            UpdateBandwidth(readSize, std::chrono::steady_clock::now()-timeStart);
+        if (curIndex < index+count) // not a failure, just no longer pending
+        {
+            mCacheStats.AddReadAheadCancelled(index+count-curIndex);
+            RemovePendingFetch(curIndex, false, pagesLock);
+        }
     }
     catch (const BackendException& ex)
     {
         MDBG_ERROR("... " << ex.what());
         const UniqueLock pagesLock(mPagesMutex);
 
-        const std::exception_ptr exptr { std::current_exception() };
-        for (uint64_t eidx { curIndex }; eidx < index+count; ++eidx)
-            mFailedPages[eidx] = exptr; // shared_ptr
-
         if (curIndex < index+count) // exception can happen after reading
+        {
+            // one shared exception_ptr for the whole unread range
+            mFailedPages.assign(curIndex, index+count-curIndex, std::current_exception());
             RemovePendingFetch(curIndex, false, pagesLock);
+        }
     }
     
-    MDBG_INFO("... thread returning!");
+    MDBG_INFO("... returning!");
+}
+
+/*****************************************************/
+void PageManager::AddFetchedPage(const uint64_t index, Page&& page, const SharedLock& thisLock)
+{
+    // if we are reading a page that is smaller on the backend (dirty writes), might need to extend
+    const uint64_t pageStart { index*mPageSize }; // offset of the page start
+    const size_t realSize { min64st(mFileSize-pageStart, mPageSize) };
+    if (page.size() < realSize) ResizePage(page, realSize, false);
+
+    const UniqueLock pagesLock(mPagesMutex);
+    // hold pagesLock because if inform fails, we will remove this page
+    const PageMap::iterator newIt { mPages.emplace(index, std::move(page)).first };
+    newIt->second.setPrefetched(); // until read, see GetPageRead()
+    mCacheStats.AddFetched();
+
+    InformNewPageRead(index, newIt->second, false, false, true, pagesLock);
+    // pass false to not wait - not allowed to call the backend for evict/flush within this callback
+    // even if canWait was true, the CacheManager could have us skip the wait to get our W lock for evict
+    // fetched pages are low priority until accessed, GetPageRead() informs again for the requested page
+    RemovePendingFetch(index, true, pagesLock); 
+}
+
+/*****************************************************/
+DiskCache::Version PageManager::GetDiskVersion(const SharedLock& thisLock)
+{
+    return { mPageBackend.GetFileID(thisLock), mPageBackend.GetBackendSize(thisLock), 
+        mPageBackend.GetBackendModified(thisLock), mPageSize };
+}
+
+/*****************************************************/
+bool PageManager::isCacheable(const uint64_t index, const Page& page, const SharedLock& thisLock)
+{
+    if ((!mDiskCache && !mCompressedCache) || page.isDirty() || page.isPartial() || page.isSparse() || 
+        !mPageBackend.ExistsOnBackend(thisLock)) return false;
+
+    // the page must have the same size as on the backend, else it was extended by a write
+    const uint64_t pageStart { index*mPageSize };
+    const uint64_t backendSize { mPageBackend.GetBackendSize(thisLock) };
+    return pageStart < backendSize && page.size() == min64st(backendSize-pageStart, mPageSize);
 }
 
 /*****************************************************/
 void PageManager::UpdateBandwidth(const size_t bytes, const std::chrono::steady_clock::duration& time)
 {
     const UniqueLock llock(mFetchSizeMutex);
+    SetFetchSize(mBandwidth.UpdateBandwidth(bytes, time), llock);
+}
 
-    size_t targetBytes { mBandwidth.UpdateBandwidth(bytes, time) };
+/*****************************************************/
+void PageManager::SetFetchSize(size_t targetBytes, const UniqueLock& llock)
+{
+    // each fetch measures a single runner's bandwidth, and the window is split between runners
+    targetBytes *= GetFetchRunners();
 
     if (mCacheMgr)
     {
@@ -456,6 +877,12 @@ void PageManager::UpdateBandwidth(const size_t bytes, const std::chrono::steady_
     MDBG_INFO("... newFetchSize:" << mFetchSize);
 }
 
+/*****************************************************/
+size_t PageManager::GetFetchRunners() const
+{
+    return std::max(static_cast<size_t>(1), mBackend.GetOptions().runnerPoolSize);
+}
+
 /*****************************************************/
 uint64_t PageManager::GetWriteList(PageMap::iterator& pageIt, PageBackend::PagePtrList& writeList, const SharedLockW& thisLock)
 {
@@ -471,6 +898,7 @@ uint64_t PageManager::GetWriteList(PageMap::iterator& pageIt, PageBackend::PageP
         if (pageIt->second.isDirty())
         {
             const size_t pageSize { pageIt->second.size() };
+            const bool partial { pageIt->second.isPartial() };
 
             if (writeList.empty())
             {
@@ -478,7 +906,8 @@ uint64_t PageManager::GetWriteList(PageMap::iterator& pageIt, PageBackend::PageP
                 MDBG_INFO("... start write run at " << startIndex);
             }
             else if (lastIndex+1 != pageIt->first || // not consecutive
-                     curSize + pageSize < curSize) break; // size_t overflow!
+                     curSize + pageSize < curSize || // size_t overflow!
+                     partial) break; // ranges flush alone
             else
             {
                 const size_t maxWrite { mBackend.GetConfig().GetUploadMaxBytes() };
@@ -489,6 +918,7 @@ uint64_t PageManager::GetWriteList(PageMap::iterator& pageIt, PageBackend::PageP
             lastIndex = pageIt->first;
             writeList.push_back(&pageIt->second);
             curSize += pageIt->second.size();
+            if (partial) { ++pageIt; break; } // ranges flush alone
         }
         else if (!writeList.empty()) break; // end run
     }
@@ -519,7 +949,16 @@ void PageManager::EvictPage(const uint64_t index, const SharedLockW& thisLock)
             FlushPageList(index, writeList, thisLock);
         }
 
-        if (mCacheMgr) mCacheMgr->RemovePage(pageIt->second);
+        if (mCacheMgr) mCacheMgr->RemovePage(*this, pageIt->second, true);
+        mCacheStats.AddEviction(CacheStats::EvictReason::MEMORY, pageIt->second.isPrefetched());
+
+        // keep a compressed copy in memory and/or on disk so it won't need to be downloaded again
+        if (isCacheable(index, pageIt->second, thisLock))
+        {
+            const DiskCache::Version version { GetDiskVersion(thisLock) };
+            if (mCompressedCache) mCompressedCache->Store(version, index, pageIt->second);
+            if (mDiskCache) mDiskCache->Store(version, index, pageIt->second);
+        }
 
         if (!pageIt->second.isDirty() || randWrite)
             mPages.erase(pageIt);
@@ -530,6 +969,12 @@ void PageManager::EvictPage(const uint64_t index, const SharedLockW& thisLock)
     else { MDBG_INFO(" ... page not found"); }
 }
 
+/*****************************************************/
+WorkerPool& PageManager::GetWorkerPool()
+{
+    return mBackend.GetWorkerPool();
+}
+
 /*****************************************************/
 size_t PageManager::FlushPage(const uint64_t index, const SharedLockW& thisLock)
 {
@@ -549,7 +994,7 @@ size_t PageManager::FlushPage(const uint64_t index, const SharedLockW& thisLock)
         
         if (!writeList.empty())
             written = FlushPageList(index, writeList, thisLock);
-        else if (mCacheMgr) mCacheMgr->RemoveDirty(pageIt->second);
+        else if (mCacheMgr) mCacheMgr->RemoveDirty(*this, pageIt->second);
     }
     
     MDBG_INFO("... return:" << written); return written;
@@ -597,13 +1042,16 @@ size_t PageManager::FlushPageList(const uint64_t index, const PageBackend::PageP
     // truncate is only cached before mBackendExists
     const bool flushCreate { !mPageBackend.ExistsOnBackend(thisLock) };
 
-    const size_t totalSize { pages.empty() ? 0 : 
-        mPageBackend.FlushPageList(index, pages, thisLock) };
+    const std::chrono::steady_clock::time_point timeStart { std::chrono::steady_clock::now() };
+    const size_t totalSize { pages.empty() ? 0 : (pages.front()->isPartial()
+        ? mPageBackend.FlushRanges(index, *pages.front(), thisLock)
+        : mPageBackend.FlushPageList(index, pages, thisLock)) };
+    if (!pages.empty()) mCacheStats.AddFlush(totalSize, std::chrono::steady_clock::now()-timeStart);
 
     for (Page* pagePtr : pages)
     {
         pagePtr->setDirty(false);
-        if (mCacheMgr) mCacheMgr->RemoveDirty(*pagePtr);
+        if (mCacheMgr) mCacheMgr->RemoveDirty(*this, *pagePtr);
     }
 
     if (flushCreate) FlushCreate(thisLock); // also calls FlushCreate()
@@ -650,7 +1098,8 @@ void PageManager::RemoteChanged(const uint64_t backendSize, const SharedLockW& t
         const Page& page { it->second };
         if (!page.isDirty()) // evict all non-dirty
         {
-            if (mCacheMgr) mCacheMgr->RemovePage(page);
+            if (mCacheMgr) mCacheMgr->RemovePage(*this, page);
+            mCacheStats.AddEviction(CacheStats::EvictReason::CHANGED, page.isPrefetched());
             it = mPages.erase(it);
         }
         else
@@ -667,6 +1116,27 @@ void PageManager::RemoteChanged(const uint64_t backendSize, const SharedLockW& t
     mPageBackend.SetBackendSize(backendSize, thisLock);
 }
 
+/*****************************************************/
+void PageManager::RemoteRefreshed(const uint64_t backendSize, const Item::Date backendModified, const SharedLockW& thisLock)
+{
+    if (!mPageBackend.ExistsOnBackend(thisLock)) // called Refresh() ourselves after creating
+    {
+        mPageBackend.SetBackendModified(backendModified, thisLock); return;
+    }
+
+    if (backendSize == mPageBackend.GetBackendSize(thisLock) &&
+        backendModified == mPageBackend.GetBackendModified(thisLock))
+    {
+        MDBG_INFO("... version unchanged, keeping pages"); return;
+    }
+
+    MDBG_INFO("(modified:" << backendModified << ") oldModified:"
+        << mPageBackend.GetBackendModified(thisLock) << ")");
+
+    RemoteChanged(backendSize, thisLock);
+    mPageBackend.SetBackendModified(backendModified, thisLock);
+}
+
 /*****************************************************/
 void PageManager::Truncate(const uint64_t newSize, const SharedLockW& thisLock)
 {
@@ -680,18 +1150,21 @@ void PageManager::Truncate(const uint64_t newSize, const SharedLockW& thisLock)
         if (!newSize || it->first > (newSize-1)/mPageSize) // remove past end
         {
             MDBG_INFO("... erase page:" << it->first);
-            if (mCacheMgr) mCacheMgr->RemovePage(it->second);
+            if (mCacheMgr) mCacheMgr->RemovePage(*this, it->second);
+            mCacheStats.AddEviction(CacheStats::EvictReason::TRUNCATE, it->second.isPrefetched());
             it = mPages.erase(it);
         }
         else if (it->first == (newSize-1)/mPageSize) // the newly last page
         {
             const size_t pageSize { static_cast<size_t>(newSize - it->first*mPageSize) };
             MDBG_INFO("... resize new last page:" << it->first << " size:" << pageSize);
+            if (pageSize > it->second.size()) FetchPartialAll(it->first, it->second, thisLock);
             ResizePage(it->second, pageSize, true, &thisLock); ++it;
         }
         else if (it->second.size() != mPageSize) // all non-last pages should be full size
         {
             MDBG_INFO("... resize old last page:" << it->first << " size:" << mPageSize);
+            FetchPartialAll(it->first, it->second, thisLock);
             ResizePage(it->second, mPageSize, true, &thisLock); ++it;
         }
         else ++it;
@@ -9,14 +9,21 @@
 #include <list>
 #include <map>
 #include <mutex>
+#include <set>
 #include <shared_mutex>
-#include <thread>
+#include <vector>
 
+#include "AccessPattern.hpp"
 #include "BandwidthMeasure.hpp"
+#include "CacheStats.hpp"
+#include "CompressedCache.hpp"
+#include "DiskCache.hpp"
 #include "PageBackend.hpp"
+#include "PageTable.hpp"
 
 #include "andromeda/common.hpp"
 #include "andromeda/Debug.hpp"
+#include "andromeda/RangeMap.hpp"
 #include "andromeda/ScopeLocked.hpp"
 #include "andromeda/SharedMutex.hpp"
 
@@ -24,7 +31,7 @@
 
 namespace Andromeda {
 
-namespace Backend { class BackendImpl; }
+namespace Backend { class BackendImpl; class WorkerPool; }
 
 namespace Filesystem {
 namespace Filedata {
@@ -38,7 +45,8 @@ class Page;
  * Implements various tricks/caching to greatly increase speed:
  *  - caches pages read from the backend (see EvictPage)
  *  - reads ahead consecutive ranges of pages sized by bandwidth,
- *      doing so on a background thread to minimize waiting
+ *      doing so on background workers (split between runners) to minimize waiting
+ *  - adapts read-ahead to the access pattern (sequential, strided, reverse, random)
  *  - caches writes until flushed (write-back cache) (see FlushPage)
  *  - writes back consecutive ranges of pages to maximize throughput
  *  - supports delayed file Create to combine Create+Write to Upload
@@ -84,6 +92,12 @@ public:
      */
     ScopeLocked TryLockScope() { return ScopeLocked(*this, mScopeMutex); }
 
+    /** Returns the backend's pool for background tasks */
+    Backend::WorkerPool& GetWorkerPool();
+
+    /** Returns the page cache counters for this file (counters are atomic) */
+    [[nodiscard]] inline CacheStats& GetCacheStats() const { return mCacheStats; }
+
     /** 
      * Reads data from the given page index into buffer
      * @throws BackendException for backend issues
@@ -92,11 +106,20 @@ public:
     void ReadPage(char* buffer, uint64_t index, size_t offset, size_t length, const SharedLock& thisLock);
 
     /** Writes data to the given page index from buffer
+     * May also send earlier pages to a streaming upload (see StreamPages)
      * @throws BackendException for backend issues
      * @throws CacheManager::MemoryException
      */
     void WritePage(const char* buffer, uint64_t index, size_t offset, size_t length, const SharedLockW& thisLock);
 
+    /** 
+     * Extends the file to newSize with zeroes as dirty pages (if larger than the current size)
+     * Pages past the old last page are sparse so the hole uses no memory until written
+     * @throws BackendException for backend issues
+     * @throws CacheManager::MemoryException
+     */
+    void WriteHole(uint64_t newSize, const SharedLockW& thisLock);
+
     /** 
      * Removes the given page, writing it if dirty
      * @throws BackendException for backend issues (only if dirty)
@@ -118,11 +141,19 @@ public:
     void FlushPages(const SharedLockW& thisLock);
 
     /**
-     * Informs us of the file changing on the backend
+     * Informs us of the file changing on the backend, dropping all clean pages
      * @param backendSize new size according to the backend
      */
     void RemoteChanged(uint64_t backendSize, const SharedLockW& thisLock);
 
+    /**
+     * Informs us of the file's current metadata on the backend (e.g. from a folder refresh)
+     * Cached pages are kept if the version (size and modified time) is unchanged, else calls RemoteChanged()
+     * @param backendSize size according to the backend
+     * @param backendModified modified time according to the backend
+     */
+    void RemoteRefreshed(uint64_t backendSize, Item::Date backendModified, const SharedLockW& thisLock);
+
     /** 
      * Truncate pages according to the given size and inform the backend
      * @throws BackendException for backend issues
@@ -136,26 +167,69 @@ private:
 
     /** 
      * Returns the page at the given index and informs cacheMgr - use GetReadLock() first!
+     * If the page is partial (see Page::isPartial()), only the given range is guaranteed valid
+     * A missing page is fetched alone on the calling thread, with the read-ahead after it queued alongside
+     * @param offset the offset within the page that will be read
+     * @param length the number of bytes that will be read
      * @throws BackendException for backend issues
      * @throws CacheManager::MemoryException
      */
-    const Page& GetPageRead(uint64_t index, const SharedLock& thisLock);
+    const Page& GetPageRead(uint64_t index, size_t offset, size_t length, const SharedLock& thisLock);
+
+    /**
+     * Returns true if a missing page at the given index should be created partial (sub-page blocks fetched as needed)
+     * Only done for random access patterns where the whole page would be mostly wasted bandwidth, and only if the
+     * page's size on the backend is the same as in the file (not extended by a dirty write)
+     */
+    bool isPartialFetch(uint64_t index, const SharedLock& thisLock, const UniqueLock& pagesLock);
+
+    /**
+     * Returns true if a partial write to a new page should create an empty partial page that
+     * tracks its dirty ranges rather than fetching the page first (read-modify-write)
+     * Requires sub-page fetching, RANDOM write mode and the page being entirely on the backend
+     * @param pageSize the size of the page being written
+     */
+    bool isPartialWrite(uint64_t index, size_t pageSize, const SharedLockW& thisLock);
+
+    /**
+     * Fetches the invalid blocks of the given range of a partial page from the backend, with pagesLock unlocked
+     * Only one thread fills a given page at once, others wait for it then check again
+     * @param pagesLock the mPagesMutex lock, will be re-locked when returning
+     * @throws BackendException for backend issues
+     */
+    void FetchPartial(uint64_t index, Page& page, size_t offset, size_t length, const SharedLock& thisLock, UniqueLock& pagesLock);
+
+    /**
+     * Fetches all invalid blocks of a partial page, making it a normal page (no-op if not partial)
+     * Must be done before growing an existing page (writes within it are tracked as dirty ranges)
+     * @throws BackendException for backend issues
+     */
+    void FetchPartialAll(uint64_t index, Page& page, const SharedLockW& thisLock);
 
     /** 
      * Returns the page at the given index and marks dirty/informs cacheMgr - use GetWriteLock() first! 
      * @param pageSize the desired size of the page for writing
-     * @param partial if true, pre-populate the page with backend data
+     * @param partial if true, pre-populate the page with backend data (or track dirty ranges, see isPartialWrite)
      * @throws BackendException for backend issues
      * @throws CacheManager::MemoryException
      */
     Page& GetPageWrite(uint64_t index, size_t pageSize, bool partial, const SharedLockW& thisLock);
 
+    /**
+     * If the file is new and can't be random written, sends dirty pages that the writer has moved
+     * past to a streaming upload (started if needed) and drops them from the cache, so the file
+     * does not need to fit in the cache before being uploaded. Blocks while the stream is full.
+     * @throws BackendException if the upload failed
+     */
+    void StreamPages(const SharedLockW& thisLock);
+
     /** 
      * Calls mCacheMgr->InformPage() on the given page and removes it from mPages if it fails, does not wait for cache space
      * @param canWait if true, maybe wait for cache space (never synchronously)
+     * @param lowPriority if true, the page was fetched ahead and can be evicted early (see EvictPolicy)
      * @throws CacheManager::MemoryException if canWait
      */
-    void InformNewPageRead(uint64_t index, const Page& page, bool dirty, bool canWait, const UniqueLock& pagesLock);
+    void InformNewPageRead(uint64_t index, const Page& page, bool dirty, bool canWait, bool lowPriority, const UniqueLock& pagesLock);
 
     /** 
      * Calls mCacheMgr->InformPage() on the given page and removes it from mPages if it fails
@@ -189,21 +263,58 @@ private:
     /** 
      * Returns the read-ahead size to be used for the given VALID (mFileSize) index 
      * Returns 0 if the page exists or the index does not exist on the backend (see mBackendSize)
+     * Returns at most 1 unless the access pattern is sequential
      */
     size_t GetFetchSize(uint64_t index, const SharedLock& thisLock, const UniqueLock& pagesLock);
 
-    /** Starts a fetch if necessary to prepopulate some pages ahead of the given index (options.readAheadBuffer) */
-    void DoAdvanceRead(uint64_t index, const SharedLock& thisLock, const UniqueLock& pagesLock);
+    /** List of the cancel flags of queued fetches */
+    using CancelList = std::vector<PageBackend::CancelFlag>;
+
+    /** 
+     * Starts a fetch if necessary to prepopulate some pages ahead of the given index (options.readAheadBuffer)
+     * The pages chosen depend on the current access pattern (none if random)
+     * @param started if not null, the cancel flags of the fetches started are added to it
+     */
+    void DoAdvanceRead(uint64_t index, const SharedLock& thisLock, const UniqueLock& pagesLock, CancelList* started = nullptr);
 
-    /** Spawns a thread to read some # of pages starting at the given VALID (mBackendSize) index */
-    void StartFetch(uint64_t index, size_t readCount, const UniqueLock& pagesLock);
+    /** 
+     * Queues background fetches to read some # of pages starting at the given VALID (mBackendSize) index
+     * The range is split into consecutive sub-ranges to be fetched in parallel (see GetFetchRunners)
+     * Sub-ranges that do not fit in the backend's WorkerPool queue are dropped (not pending)
+     * @param started if not null, the cancel flags of the sub-ranges queued are added to it
+     */
+    void StartFetch(uint64_t index, size_t readCount, const UniqueLock& pagesLock, CancelList* started = nullptr);
+
+    /** 
+     * Cancels background fetches abandoned by a jump to the given index (see AccessPattern::isJump)
+     * Keeps fetches that contain the index or start within the read-ahead window after it
+     * A reader still waiting on a cancelled page will fetch it itself (see GetPageRead)
+     */
+    void CancelStaleFetches(uint64_t index, const UniqueLock& pagesLock);
+
+    /** Returns the max number of parallel fetches to split a read-ahead window into (runnerPoolSize) */
+    size_t GetFetchRunners() const;
 
     /** 
      * Reads count# pages from the backend at the given index, adding to the page map
+     * The range must already be in mPendingPages (see StartFetch)
      * Gets its own R thisLock and informs the cacheManager of all new pages
-     * Sets mFailedPages[idx] to any BackendException
+     * Sets mFailedPages for the unread range to any BackendException
+     * @param cancel if not null, the flag that aborts the fetch - the unread range is just no longer pending
+     */
+    void FetchPages(uint64_t index, size_t count, const PageBackend::CancelFlag& cancel = nullptr) noexcept;
+
+    /** 
+     * Adds a page read by FetchPages() to the page map, extending it if needed
+     * Informs the cacheManager and removes the index from mPendingPages
      */
-    void FetchPages(uint64_t index, size_t count) noexcept;
+    void AddFetchedPage(uint64_t index, Page&& page, const SharedLock& thisLock);
+
+    /** Returns the backend version of this file that disk-cached or compressed pages must match */
+    DiskCache::Version GetDiskVersion(const SharedLock& thisLock);
+
+    /** Returns true if the given clean page can be stored in the disk cache or compressed tier (same as on the backend) */
+    bool isCacheable(uint64_t index, const Page& page, const SharedLock& thisLock);
 
     /** 
      * Removes the given start index from the pending-read list and notifies waiters
@@ -214,11 +325,15 @@ private:
     /** Updates mFetchSize with the given bandwidth measurement - THREAD SAFE */
     void UpdateBandwidth(size_t bytes, const std::chrono::steady_clock::duration& time);
 
-    /** Map of page index to page */
-    using PageMap = std::map<uint64_t, Page>;
+    /** Sets mFetchSize from the given single-runner targetBytes */
+    void SetFetchSize(size_t targetBytes, const UniqueLock& llock);
+
+    /** Map of page index to page (radix table for O(1) lookup) */
+    using PageMap = PageTable<Page>;
 
     /** 
      * Returns a series of **consecutive** dirty pages (total bytes < size_t)
+     * A dirty partial page is always returned alone, as only its dirty ranges are written
      * @param[in,out] pageIt reference to the iterator to start with - will end as the next index not used
      * @param[out] writeList reference to a list of pages to fill out - guaranteed not empty if pageIt is dirty
      * @return uint64_t the start index of the write list (not valid if writeList is empty!)
@@ -226,7 +341,7 @@ private:
     uint64_t GetWriteList(PageMap::iterator& pageIt, PageBackend::PagePtrList& writeList, const SharedLockW& thisLock);
 
     /** 
-     * Writes a series of **consecutive** pages (total < size_t)
+     * Writes a series of **consecutive** pages (total < size_t), or the dirty ranges of a single partial page
      * Also marks each page not dirty and informs the cache manager, and creates the file on the backend if necessary
      * @param index the starting index of the page list
      * @param pages list of pages to flush - may be empty
@@ -250,36 +365,43 @@ private:
     Backend::BackendImpl& mBackend;
     /** Pointer to the cache manager to use */
     CacheManager* mCacheMgr { nullptr };
+    /** Pointer to the on-disk cache to use (may be null) */
+    DiskCache* mDiskCache { nullptr };
+    /** Pointer to the compressed in-memory tier to use (may be null) */
+    CompressedCache* mCompressedCache { nullptr };
+    /** Counters for this file, also counted in the CacheManager's */
+    mutable CacheStats mCacheStats;
     /** The size of each page - see description in ConfigOptions */
     const size_t mPageSize;
     /** The current size of the file including dirty extending writes */
     uint64_t mFileSize;
 
-    /** The current read-ahead window (number of pages) (dynamic) - NEVER zero */
+    /** 
+     * The current read-ahead window (number of pages) (dynamic) - NEVER zero
+     * This is the per-runner bandwidth target multiplied by the number of fetch runners
+     */
     size_t mFetchSize { 1 };
     /** Mutex that protects mFetchSize and mBandwidthHistory */
     std::mutex mFetchSizeMutex;
 
-    /** List of <index,count> pending reads */
-    using PendingMap = std::list<std::pair<uint64_t, size_t>>;
-    /** 
-     * Map of page index to exception thrown when reading 
-     * This is simpler but less efficient than storing a map of FetchPairs,
-     * but performance is not critical for the rare failure case
-     */
-    using FailureMap = std::map<uint64_t, std::exception_ptr>;
+    /** Map of <index,count> pending reads to the flag that cancels them (null if not cancellable) */
+    using PendingMap = RangeMap<PageBackend::CancelFlag>;
+    /** Map of <index,count> page ranges to the exception thrown when reading them */
+    using FailureMap = RangeMap<std::exception_ptr>;
 
     /** The index based map of pages */
     PageMap mPages;
-    /** Unique set of page ranges being downloaded */
+    /** Non-overlapping set of page ranges being downloaded */
     PendingMap mPendingPages;
     /** Map of failures encountered while downloading pages */
     FailureMap mFailedPages;
+    /** Set of partial pages that have a sub-page fetch running (see FetchPartial) */
+    std::set<uint64_t> mPartialFetches;
     /** Condition variable for waiting for pages */
     std::condition_variable mPagesCV;
 
-    /** Lock for fetch threads to acquire (so destructor can wait) */
-    std::shared_mutex mFetchMutex;
+    /** The number of queued or running background fetch tasks (so destructor can wait) */
+    size_t mFetchTasks { 0 };
 
     /** List of pages we didn't evict due to requiring sequential writing */
     std::list<uint64_t> mDeferredEvicts;
@@ -291,6 +413,8 @@ private:
 
     /** Bandwidth measurement tool for mFetchSize */
     BandwidthMeasure mBandwidth;
+    /** Access pattern detection for read-ahead (protected by mPagesMutex) */
+    AccessPattern mAccessPattern;
     /** Page to/from backend interface */
     PageBackend& mPageBackend;
 };
@@ -0,0 +1,265 @@
+
+#ifndef LIBA2_PAGETABLE_H_
+#define LIBA2_PAGETABLE_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+
+/**
+ * A two-level radix table mapping page indexes to values, as a faster replacement for std::map
+ * The top level is a vector of chunk pointers indexed by (index >> CHUNK_BITS), and each chunk
+ * is a fixed array of slots, so lookup is O(1) and iteration walks memory in index order.
+ * Chunks are allocated on demand and freed when empty. The top level is sized to the highest
+ * chunk in use, so its size is proportional to the largest index (8 bytes per CHUNK_SIZE pages).
+ * The semantics of this class are meant to be very similar to std::map - values never move in
+ * memory once inserted (references remain valid until erased) but iterators are invalidated by erase
+ * NOT THREAD SAFE (protect externally)
+ * @tparam T the value type stored for each index
+ */
+template<typename T>
+class PageTable
+{
+public:
+    using key_type = uint64_t;
+    using mapped_type = T;
+    using value_type = std::pair<const key_type, T>;
+
+    /** The number of bits of the index used within a chunk */
+    static constexpr size_t CHUNK_BITS { 6 };
+    /** The number of slots in a chunk */
+    static constexpr size_t CHUNK_SIZE { static_cast<size_t>(1) << CHUNK_BITS };
+
+private:
+
+    /** A fixed block of CHUNK_SIZE consecutive slots */
+    struct Chunk
+    {
+        std::array<std::optional<value_type>, CHUNK_SIZE> slots;
+        /** The number of used slots */
+        size_t count { 0 };
+    };
+    using ChunkList = std::vector<std::unique_ptr<Chunk>>;
+
+    /** Returns the chunk number for the given index */
+    [[nodiscard]] static inline size_t ChunkOf(const key_type index) noexcept {
+        return static_cast<size_t>(index >> CHUNK_BITS); }
+    /** Returns the slot number within a chunk for the given index */
+    [[nodiscard]] static inline size_t SlotOf(const key_type index) noexcept {
+        return static_cast<size_t>(index & (CHUNK_SIZE-1)); }
+
+public:
+
+    /** Forward iterator over used slots in index order */
+    template<bool Const>
+    class Iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename PageTable::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+        using reference = std::conditional_t<Const, const value_type&, value_type&>;
+        using TablePtr = std::conditional_t<Const, const PageTable*, PageTable*>;
+
+        Iterator() = default;
+        /** Allow converting iterator to const_iterator */
+        template<bool C = Const, typename = std::enable_if_t<C>>
+        Iterator(const Iterator<false>& it) noexcept : // NOLINT(google-explicit-constructor)
+            mTable(it.mTable), mValue(it.mValue) { }
+
+        [[nodiscard]] inline reference operator*() const noexcept { return *mValue; }
+        [[nodiscard]] inline pointer operator->() const noexcept { return mValue; }
+
+        inline Iterator& operator++() noexcept
+        {
+            const key_type index { mValue->first };
+            mValue = (index == std::numeric_limits<key_type>::max())
+                ? nullptr : mTable->NextValue(index+1);
+            return *this;
+        }
+        inline Iterator operator++(int) noexcept { // NOLINT(cert-dcl21-cpp)
+            Iterator ret { *this }; ++(*this); return ret; }
+
+        [[nodiscard]] inline bool operator==(const Iterator& rhs) const noexcept { return mValue == rhs.mValue; }
+        [[nodiscard]] inline bool operator!=(const Iterator& rhs) const noexcept { return mValue != rhs.mValue; }
+
+    private:
+        friend class PageTable;
+        friend class Iterator<!Const>;
+
+        Iterator(TablePtr table, pointer value) noexcept :
+            mTable(table), mValue(value) { }
+
+        /** The table being iterated */
+        TablePtr mTable { nullptr };
+        /** Pointer to the current value or nullptr for end() */
+        pointer mValue { nullptr };
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    PageTable() = default;
+    ~PageTable() = default;
+    PageTable(const PageTable&) = delete;
+    PageTable& operator=(const PageTable&) = delete;
+    PageTable(PageTable&&) noexcept = default;
+    PageTable& operator=(PageTable&&) noexcept = default;
+
+    /** Returns an iterator to the lowest index element */
+    [[nodiscard]] inline iterator begin() noexcept { return { this, NextValue(0) }; }
+    /** Returns the past-the-end iterator */
+    [[nodiscard]] inline iterator end() noexcept { return { this, nullptr }; }
+    /** Returns a const iterator to the lowest index element */
+    [[nodiscard]] inline const_iterator begin() const noexcept { return { this, NextValue(0) }; }
+    /** Returns the past-the-end const iterator */
+    [[nodiscard]] inline const_iterator end() const noexcept { return { this, nullptr }; }
+    /** Returns a const iterator to the lowest index element */
+    [[nodiscard]] inline const_iterator cbegin() const noexcept { return begin(); }
+    /** Returns the past-the-end const iterator */
+    [[nodiscard]] inline const_iterator cend() const noexcept { return end(); }
+
+    /** Returns the number of elements (O(1)) */
+    [[nodiscard]] inline size_t size() const noexcept { return mSize; }
+    /** Returns true iff there are no elements (O(1)) */
+    [[nodiscard]] inline bool empty() const noexcept { return !mSize; }
+
+    /** Returns an iterator to the element with the given index, or end() if not found (O(1)) */
+    [[nodiscard]] inline iterator find(const key_type index) noexcept { return { this, GetValue(index) }; }
+    /** Returns an iterator to the element with the given index, or end() if not found (O(1)) */
+    [[nodiscard]] inline const_iterator find(const key_type index) const noexcept { return { this, GetValue(index) }; }
+
+    /** Returns an iterator to the first element with an index not less than the given one */
+    [[nodiscard]] inline iterator lower_bound(const key_type index) noexcept { return { this, NextValue(index) }; }
+    /** Returns an iterator to the first element with an index not less than the given one */
+    [[nodiscard]] inline const_iterator lower_bound(const key_type index) const noexcept { return { this, NextValue(index) }; }
+
+    /** Returns an iterator to the first element with an index greater than the given one */
+    [[nodiscard]] inline iterator upper_bound(const key_type index) noexcept {
+        return (index == std::numeric_limits<key_type>::max()) ? end() : lower_bound(index+1); }
+    /** Returns an iterator to the first element with an index greater than the given one */
+    [[nodiscard]] inline const_iterator upper_bound(const key_type index) const noexcept {
+        return (index == std::numeric_limits<key_type>::max()) ? end() : lower_bound(index+1); }
+
+    /**
+     * Constructs a new element in place if the index does not exist
+     * @return pair of iterator to the element with the index, true if it was inserted
+     */
+    template<class... Ts>
+    std::pair<iterator,bool> try_emplace(const key_type index, Ts&&... args)
+    {
+        const size_t chunkNum { ChunkOf(index) };
+        if (chunkNum >= mChunks.size())
+            mChunks.resize(chunkNum+1);
+
+        std::unique_ptr<Chunk>& chunk { mChunks[chunkNum] };
+        if (!chunk) chunk = std::make_unique<Chunk>();
+
+        std::optional<value_type>& slot { chunk->slots[SlotOf(index)] };
+        if (slot) return { { this, &*slot }, false };
+
+        slot.emplace(std::piecewise_construct, std::forward_as_tuple(index),
+            std::forward_as_tuple(std::forward<Ts>(args)...));
+        ++chunk->count; ++mSize;
+        return { { this, &*slot }, true };
+    }
+
+    /** Same as try_emplace() - an existing element is not replaced */
+    template<class... Ts>
+    inline std::pair<iterator,bool> emplace(const key_type index, Ts&&... args) {
+        return try_emplace(index, std::forward<Ts>(args)...); }
+
+    /**
+     * Erases the element with the given index if it exists
+     * @return the number of elements erased (0 or 1)
+     */
+    size_t erase(const key_type index) noexcept
+    {
+        const size_t chunkNum { ChunkOf(index) };
+        if (chunkNum >= mChunks.size() || !mChunks[chunkNum]) return 0;
+
+        std::optional<value_type>& slot { mChunks[chunkNum]->slots[SlotOf(index)] };
+        if (!slot) return 0;
+
+        slot.reset(); --mSize;
+        if (!--mChunks[chunkNum]->count) FreeChunk(chunkNum);
+        return 1;
+    }
+
+    /**
+     * Erases the element pointed to by the given iterator
+     * @return iterator pointing to the next element
+     */
+    iterator erase(const const_iterator& it) noexcept
+    {
+        const key_type index { it->first };
+        erase(index); // it is now invalid
+        return upper_bound(index);
+    }
+
+    /** Erases all elements and frees all chunks */
+    inline void clear() noexcept
+    {
+        mChunks.clear();
+        mSize = 0;
+    }
+
+private:
+
+    /** Returns a pointer to the value at the given index or nullptr if not present */
+    [[nodiscard]] value_type* GetValue(const key_type index) const noexcept
+    {
+        const size_t chunkNum { ChunkOf(index) };
+        if (chunkNum >= mChunks.size() || !mChunks[chunkNum]) return nullptr;
+
+        std::optional<value_type>& slot { mChunks[chunkNum]->slots[SlotOf(index)] };
+        return slot ? &*slot : nullptr;
+    }
+
+    /** Returns a pointer to the first value with index >= the given one or nullptr if none */
+    [[nodiscard]] value_type* NextValue(const key_type index) const noexcept
+    {
+        for (size_t chunkNum { ChunkOf(index) }; chunkNum < mChunks.size(); ++chunkNum)
+        {
+            if (!mChunks[chunkNum]) continue; // skip empty chunks entirely
+            Chunk& chunk { *mChunks[chunkNum] };
+
+            const size_t firstSlot { (chunkNum == ChunkOf(index)) ? SlotOf(index) : 0 };
+            for (size_t slotNum { firstSlot }; slotNum < CHUNK_SIZE; ++slotNum)
+                if (chunk.slots[slotNum]) return &*chunk.slots[slotNum];
+        }
+        return nullptr;
+    }
+
+    /** Frees the given (empty) chunk and shrinks the top level if it was last */
+    void FreeChunk(const size_t chunkNum) noexcept
+    {
+        mChunks[chunkNum].reset();
+        while (!mChunks.empty() && !mChunks.back())
+            mChunks.pop_back();
+    }
+
+    /** The top level of the table - chunk pointers, nullptr if empty */
+    ChunkList mChunks;
+    /** The total number of elements */
+    size_t mSize { 0 };
+};
+
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
+
+#endif // LIBA2_PAGETABLE_H_
@@ -0,0 +1,447 @@
+
+#ifndef LIBA2_SHARDEDPAGEQUEUE_H_
+#define LIBA2_SHARDEDPAGEQUEUE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "EvictPolicy.hpp"
+#include "Page.hpp"
+#include "andromeda/OrderedMap.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+
+/**
+ * Tracks the memory usage and evict/flush order of cached pages (for the CacheManager)
+ * Pages are split into shards by owner so that informing about pages of different files
+ * mostly takes different locks. Each shard has its own EvictPolicy and dirty page queue.
+ * The global totals are atomics that can be read without locking, approximately in sync with the shards.
+ * Choosing pages to evict/flush visits each shard in turn and divides the work by shard size.
+ * Dirty pages also record when they were first dirtied so they can be flushed by age.
+ * THREAD SAFE (INTERNAL LOCKS)
+ * @tparam Owner the type of the page owner (PageManager)
+ */
+template<typename Owner>
+class ShardedPageQueue
+{
+public:
+
+    using Clock = std::chrono::steady_clock;
+
+    /** Info about a tracked page */
+    struct PageInfo
+    {
+        /** Reference to the owner of the page */
+        Owner& mOwner;
+        /** Index of the page in the owner */
+        uint64_t mPageIndex;
+        /** Memory usage of the page when last informed */
+        size_t mPageSize;
+        /** The time the page became dirty (dirty queue only) */
+        Clock::time_point mDirtyTime {};
+    };
+
+    /** Function that returns a new EvictPolicy for a shard */
+    using PolicyFactory = std::function<std::unique_ptr<EvictPolicy>()>;
+
+    /** 
+     * Function called with each page chosen to evict/flush
+     * Returns false if the page should be removed instead (its owner is being deleted)
+     */
+    using PageFunc = std::function<bool(const Page&, const PageInfo&)>;
+
+    /** 
+     * @param shardCount the number of shards (at least 1)
+     * @param makePolicy function to create the EvictPolicy for each shard
+     */
+    ShardedPageQueue(const size_t shardCount, const PolicyFactory& makePolicy) :
+        mShards(std::max(static_cast<size_t>(1), shardCount))
+    {
+        for (Shard& shard : mShards)
+            shard.evictPolicy = makePolicy();
+    }
+
+    /** 
+     * Sets the cache size in bytes, of which each shard's EvictPolicy gets the share it currently uses
+     * All of an owner's pages are in one shard, so a single large file can use the whole cache.
+     * The shares are updated again on each GetEvictions() as the shard sizes change.
+     */
+    void SetCapacity(const size_t capacity)
+    {
+        mCapacity.store(capacity);
+        const size_t total { GetTotal() };
+        for (Shard& shard : mShards)
+        {
+            const UniqueLock lock(shard.mutex);
+            shard.evictPolicy->SetCapacity(ShareOf(capacity, shard.total, total));
+        }
+    }
+
+    /** Returns the total memory usage of all pages (approximate, no locking) */
+    [[nodiscard]] inline size_t GetTotal() const { return mTotal.load(); }
+    /** Returns the total memory usage of dirty pages (approximate, no locking) */
+    [[nodiscard]] inline size_t GetDirty() const { return mDirty.load(); }
+
+    /** Returns the number of pages (locks all shards) */
+    [[nodiscard]] size_t GetPageCount() const
+    {
+        size_t count { 0 };
+        for (const Shard& shard : mShards)
+        {
+            const UniqueLock lock(shard.mutex);
+            count += shard.pageInfos.size();
+        }
+        return count;
+    }
+
+    /** Returns the number of dirty pages (locks all shards) */
+    [[nodiscard]] size_t GetDirtyCount() const
+    {
+        size_t count { 0 };
+        for (const Shard& shard : mShards)
+        {
+            const UniqueLock lock(shard.mutex);
+            count += shard.dirtyQueue.size();
+        }
+        return count;
+    }
+
+    /** Returns the time the oldest dirty page became dirty, or nullopt if none (locks all shards) */
+    [[nodiscard]] std::optional<Clock::time_point> GetOldestDirty() const
+    {
+        std::optional<Clock::time_point> oldest;
+        for (const Shard& shard : mShards)
+        {
+            const UniqueLock lock(shard.mutex);
+            for (typename PageQueue::const_iterator it { shard.dirtyQueue.cbegin() }; it != shard.dirtyQueue.cend(); ++it)
+                if (!oldest || it->second.mDirtyTime < *oldest) oldest = it->second.mDirtyTime;
+        }
+        return oldest;
+    }
+
+    /** 
+     * Adds a page or records an access to it, updating its size and whether it is dirty
+     * A page that stays dirty keeps its original dirty time
+     * @param lowPriority if true and the page is new, it was read ahead and can be evicted early
+     * @return the previous memory usage of the page or 0 if it was new
+     */
+    size_t Enqueue(Owner& owner, const uint64_t index, const Page& page, const bool dirty, const bool lowPriority)
+    {
+        Shard& shard { GetShard(owner) };
+        const size_t newSize { page.capacity() }; // real memory usage
+        const UniqueLock lock(shard.mutex);
+
+        size_t oldSize { 0 };
+        const typename PageInfoMap::iterator itInfo { shard.pageInfos.find(&page) };
+        if (itInfo != shard.pageInfos.end())
+        {
+            oldSize = itInfo->second.mPageSize;
+            itInfo->second.mPageSize = newSize;
+            shard.evictPolicy->Access(&page);
+            shard.evictPolicy->Resize(&page, newSize);
+        }
+        else
+        {
+            shard.pageInfos.emplace(&page, PageInfo{owner, index, newSize});
+            shard.evictPolicy->Insert(&page, {&owner, index}, newSize, lowPriority);
+        }
+        shard.total += newSize-oldSize; mTotal += newSize-oldSize; // unsigned wraparound is okay
+
+        Clock::time_point dirtyTime { Clock::now() };
+        { const typename PageQueue::iterator itQueue { shard.dirtyQueue.find(&page) };
+        if (itQueue != shard.dirtyQueue.end())
+            dirtyTime = itQueue->second.mDirtyTime; } // still dirty since
+
+        RemoveDirty(shard, page, lock);
+        if (dirty)
+        {
+            shard.dirtyQueue.enqueue_front(&page, PageInfo{owner, index, newSize, dirtyTime});
+            shard.dirty += newSize; mDirty += newSize;
+        }
+
+        CheckShard(shard, lock);
+        return oldSize;
+    }
+
+    /** Whether the memory usage of a page grew on Resize() */
+    struct ResizeResult
+    {
+        /** True if the page grew */
+        bool grew;
+        /** True if the page is dirty and grew */
+        bool grewDirty;
+    };
+
+    /** Updates the memory usage of a page that changed size (ignored if not found) */
+    ResizeResult Resize(const Owner& owner, const Page& page)
+    {
+        Shard& shard { GetShard(owner) };
+        const size_t newSize { page.capacity() }; // real memory usage
+        const UniqueLock lock(shard.mutex);
+
+        ResizeResult retval { false, false };
+
+        { const typename PageInfoMap::iterator itInfo { shard.pageInfos.find(&page) };
+        if (itInfo != shard.pageInfos.end())
+        {
+            const size_t oldSize { itInfo->second.mPageSize };
+            shard.total += newSize-oldSize; mTotal += newSize-oldSize;
+            itInfo->second.mPageSize = newSize;
+            shard.evictPolicy->Resize(&page, newSize);
+            retval.grew = (newSize > oldSize);
+        } }
+
+        { const typename PageQueue::iterator itQueue { shard.dirtyQueue.find(&page) };
+        if (itQueue != shard.dirtyQueue.end())
+        {
+            const size_t oldSize { itQueue->second.mPageSize };
+            shard.dirty += newSize-oldSize; mDirty += newSize-oldSize;
+            itQueue->second.mPageSize = newSize;
+            retval.grewDirty = (newSize > oldSize);
+        } }
+
+        CheckShard(shard, lock);
+        return retval;
+    }
+
+    /** 
+     * Removes a page that was erased (ignored if not found)
+     * @param evicted true if the page was evicted to free memory (see EvictPolicy::Erase)
+     * @return the memory usage of the page or 0 if not found
+     */
+    size_t Remove(const Owner& owner, const Page& page, const bool evicted = false)
+    {
+        Shard& shard { GetShard(owner) };
+        const UniqueLock lock(shard.mutex);
+        return Remove(shard, page, lock, evicted);
+    }
+
+    /** Moves a page that could not be evicted to the back of the eviction order (ignored if not found) */
+    void Requeue(const Owner& owner, const Page& page)
+    {
+        Shard& shard { GetShard(owner) };
+        const UniqueLock lock(shard.mutex);
+        if (shard.pageInfos.find(&page) != shard.pageInfos.end())
+            shard.evictPolicy->Requeue(&page);
+    }
+
+    /** Forgets anything remembered about evicted pages of the given owner (being deleted) */
+    void RemoveOwner(const Owner& owner)
+    {
+        Shard& shard { GetShard(owner) };
+        const UniqueLock lock(shard.mutex);
+        shard.evictPolicy->EraseOwner(&owner);
+    }
+
+    /** Removes a page from the dirty queue (ignored if not found) */
+    void RemoveDirty(const Owner& owner, const Page& page)
+    {
+        Shard& shard { GetShard(owner) };
+        const UniqueLock lock(shard.mutex);
+        RemoveDirty(shard, page, lock);
+    }
+
+    /** 
+     * Returns the next page to evict in the owner's shard
+     * @param skip a page that should not be evicted
+     * @return the page's info or nullopt if the next page is skip or not owned by owner
+     */
+    std::optional<PageInfo> GetNextEvict(const Owner& owner, const Page& skip)
+    {
+        Shard& shard { GetShard(owner) };
+        const UniqueLock lock(shard.mutex);
+
+        const Page* victim { nullptr };
+        shard.evictPolicy->ForEachVictim([&](const Page* page){ victim = page; return false; });
+        if (victim == nullptr || victim == &skip) return std::nullopt;
+
+        const PageInfo& pageInfo { shard.pageInfos.at(victim) };
+        if (&pageInfo.mOwner != &owner) return std::nullopt;
+        return pageInfo; // copy
+    }
+
+    /** 
+     * Returns the next page to flush in the owner's shard
+     * @param skip a page that should not be flushed
+     * @return the page's info or nullopt if the next page is skip or not owned by owner
+     */
+    std::optional<PageInfo> GetNextFlush(const Owner& owner, const Page& skip)
+    {
+        Shard& shard { GetShard(owner) };
+        const UniqueLock lock(shard.mutex);
+
+        if (shard.dirtyQueue.empty()) return std::nullopt;
+        const typename PageQueue::value_type& back { shard.dirtyQueue.back() };
+        if (back.first == &skip || &back.second.mOwner != &owner) return std::nullopt;
+        return back.second; // copy
+    }
+
+    /** 
+     * Chooses pages to evict totalling at least the given bytes, divided between shards by their size
+     * @param func function to call with each chosen page (with the shard locked)
+     */
+    void GetEvictions(const size_t bytes, const PageFunc& func)
+    {
+        const size_t total { GetTotal() };
+        const size_t capacity { mCapacity.load() };
+        for (Shard& shard : mShards)
+        {
+            const UniqueLock lock(shard.mutex);
+            const size_t shardBytes { ShareOf(bytes, shard.total, total) };
+            if (capacity) shard.evictPolicy->SetCapacity(ShareOf(capacity, shard.total, total));
+
+            size_t chosen { 0 };
+            std::vector<const Page*> removes; // can't remove while iterating
+            shard.evictPolicy->ForEachVictim([&](const Page* page)
+            {
+                if (chosen >= shardBytes) return false;
+
+                const PageInfo& pageInfo { shard.pageInfos.at(page) };
+                if (func(*page, pageInfo)) chosen += pageInfo.mPageSize;
+                else removes.push_back(page);
+                return true;
+            });
+
+            for (const Page* page : removes)
+                Remove(shard, *page, lock);
+        }
+    }
+
+    /** 
+     * Chooses dirty pages to flush totalling at least the given bytes, divided between shards by their dirty size
+     * Also chooses any dirty pages that became dirty at or before the given expire time
+     * @param expired the dirty time at or before which pages must be flushed
+     * @param func function to call with each chosen page (with the shard locked)
+     */
+    void GetFlushes(const size_t bytes, const Clock::time_point& expired, const PageFunc& func)
+    {
+        const size_t total { GetDirty() };
+        for (Shard& shard : mShards)
+        {
+            const UniqueLock lock(shard.mutex);
+            const size_t shardBytes { ShareOf(bytes, shard.dirty, total) };
+
+            size_t chosen { 0 };
+            std::vector<const Page*> removes; // can't remove while iterating
+            for (typename PageQueue::reverse_iterator it { shard.dirtyQueue.rbegin() };
+                it != shard.dirtyQueue.rend(); ++it)
+            {
+                // least recently written first, then any others that are too old
+                if (chosen >= shardBytes && it->second.mDirtyTime > expired) continue;
+
+                if (func(*it->first, it->second)) chosen += it->second.mPageSize;
+                else removes.push_back(it->first);
+            }
+
+            for (const Page* page : removes)
+                Remove(shard, *page, lock);
+        }
+    }
+
+private:
+
+    using UniqueLock = std::unique_lock<std::mutex>;
+    using PageInfoMap = std::unordered_map<const Page*, PageInfo>;
+    /** LIFO queue of pages (least recent at the back) */
+    using PageQueue = OrderedMap<const Page*, PageInfo>;
+
+    /** A subset of pages with its own lock */
+    struct Shard
+    {
+        /** Mutex that protects this shard */
+        mutable std::mutex mutex;
+        /** Map of all pages to their info */
+        PageInfoMap pageInfos;
+        /** The policy for choosing which of pageInfos to evict */
+        std::unique_ptr<EvictPolicy> evictPolicy;
+        /** Queue of dirty pages to flush the least recently used */
+        PageQueue dirtyQueue;
+        /** The total memory usage of pageInfos */
+        size_t total { 0 };
+        /** The total memory usage of dirtyQueue */
+        size_t dirty { 0 };
+    };
+
+    /** Returns the shard for the given owner */
+    inline Shard& GetShard(const Owner& owner)
+    {
+        // fibonacci hash, as the low bits of heap addresses are mostly the same
+        const auto addr { static_cast<uint64_t>(reinterpret_cast<uintptr_t>(&owner)) }; // NOLINT(*-reinterpret-cast)
+        return mShards[static_cast<size_t>((addr * 0x9E3779B97F4A7C15ULL) >> 32U) % mShards.size()];
+    }
+
+    /** Returns the share of bytes for a shard of the given size (rounded up) */
+    static inline size_t ShareOf(const size_t bytes, const size_t part, const size_t total)
+    {
+        if (!total || part >= total) return bytes;
+        return static_cast<size_t>(std::ceil(static_cast<double>(bytes) * 
+            static_cast<double>(part) / static_cast<double>(total)));
+    }
+
+    /** Removes a page from the shard, returning its memory usage or 0 if not found */
+    size_t Remove(Shard& shard, const Page& page, const UniqueLock& lock, const bool evicted = false)
+    {
+        size_t pageSize { 0 }; // size of page removed
+        const typename PageInfoMap::iterator itInfo { shard.pageInfos.find(&page) };
+        if (itInfo != shard.pageInfos.end())
+        {
+            pageSize = itInfo->second.mPageSize;
+            shard.total -= pageSize; mTotal -= pageSize;
+            shard.pageInfos.erase(itInfo);
+            shard.evictPolicy->Erase(&page, evicted);
+        }
+
+        RemoveDirty(shard, page, lock);
+        return pageSize;
+    }
+
+    /** Removes a page from the shard's dirty queue (ignored if not found) */
+    void RemoveDirty(Shard& shard, const Page& page, const UniqueLock& lock)
+    {
+        const typename PageQueue::lookup_iterator itLookup { shard.dirtyQueue.lookup(&page) };
+        if (itLookup != shard.dirtyQueue.lend())
+        {
+            const size_t pageSize { itLookup->second->second.mPageSize };
+            shard.dirty -= pageSize; mDirty -= pageSize;
+            shard.dirtyQueue.erase(itLookup);
+        }
+    }
+
+    /** Checks the shard's memory accounting (DEBUG only) */
+    void CheckShard(Shard& shard, const UniqueLock& lock)
+    {
+#if DEBUG // this will kill performance
+        size_t total = 0; for (const typename PageInfoMap::value_type& pageInfo : shard.pageInfos) total += pageInfo.second.mPageSize;
+        size_t dirty = 0; for (const typename PageQueue::value_type& pageInfo : shard.dirtyQueue) dirty += pageInfo.second.mPageSize;
+        assert(total == shard.total); assert(dirty == shard.dirty);
+#endif // DEBUG
+    }
+
+    /** The list of shards (fixed size) */
+    std::vector<Shard> mShards;
+
+    /** The cache size in bytes to share between the shards' policies (0 if not set) */
+    std::atomic<size_t> mCapacity { 0 };
+    /** The total memory usage of all shards */
+    std::atomic<size_t> mTotal { 0 };
+    /** The total memory usage of all dirty queues */
+    std::atomic<size_t> mDirty { 0 };
+};
+
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
+
+#endif // LIBA2_SHARDEDPAGEQUEUE_H_
@@ -0,0 +1,164 @@
+
+#include <algorithm>
+#include <utility>
+#include "nlohmann/json.hpp"
+
+#include "UploadStream.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+
+using Backend::RunnerInput;
+
+/*****************************************************/
+UploadStream::UploadStream(const size_t bufferSize, const size_t replaySize, const UploadFunc& uploadFunc) :
+    mBuffer(std::max(static_cast<size_t>(1), bufferSize) + replaySize),
+    mReplaySize(replaySize),
+    mDebug(__func__,this)
+{
+    MDBG_INFO("(bufferSize:" << bufferSize << " replaySize:" << mReplaySize << ")");
+
+    mThread = std::thread(&UploadStream::UploadMain, this, uploadFunc);
+}
+
+/*****************************************************/
+UploadStream::~UploadStream()
+{
+    MDBG_INFO("()");
+
+    if (mThread.joinable())
+    {
+        { const UniqueLock lock(mMutex);
+            if (!mFinished) { MDBG_INFO("... aborting upload"); }
+            mAborted = true;
+            mCV.notify_all(); }
+
+        mThread.join();
+    }
+}
+
+/*****************************************************/
+void UploadStream::UploadMain(const UploadFunc& uploadFunc)
+{
+    MDBG_INFO("()");
+
+    std::unique_ptr<nlohmann::json> result;
+    std::exception_ptr failure;
+
+    try
+    {
+        result = std::make_unique<nlohmann::json>(uploadFunc(
+            [&](const size_t offset, char* const buf, const size_t buflen, size_t& read)->bool {
+                return ReadFunc(offset, buf, buflen, read); }));
+    }
+    catch (...) { failure = std::current_exception(); }
+
+    const UniqueLock lock(mMutex);
+    MDBG_INFO("... returning! read:" << mRead << (failure ? " (failed)" : ""));
+
+    mResult = std::move(result);
+    mFailure = failure;
+    mDone = true;
+    mCV.notify_all();
+}
+
+/*****************************************************/
+bool UploadStream::ReadFunc(const size_t offset, char* const buf, const size_t buflen, size_t& read)
+{
+    UniqueLock lock(mMutex);
+    read = 0; // in case of exception
+
+    // the data before mBase is gone, so a retry can't go back that far
+    if (offset < mBase || offset > mRead) throw RunnerInput::StreamSeekException();
+
+    mCV.wait(lock, [&]{ return offset < mWritten || mFinished || mAborted; });
+    if (mAborted) throw RunnerInput::StreamFailException("Aborted");
+
+    while (read < buflen && offset+read < mWritten)
+    {
+        const size_t start { (mHead + static_cast<size_t>(offset+read-mBase)) % mBuffer.size() };
+        const size_t copy { std::min({ buflen-read, static_cast<size_t>(mWritten-offset-read), mBuffer.size()-start }) };
+        std::copy(mBuffer.data()+start, mBuffer.data()+start+copy, buf+read);
+        read += copy;
+    }
+
+    mRead = std::max(mRead, static_cast<uint64_t>(offset+read));
+    if (mRead - mBase > mReplaySize) // free what a retry can no longer need
+    {
+        const size_t drop { static_cast<size_t>(mRead - mBase - mReplaySize) };
+        mHead = (mHead + drop) % mBuffer.size();
+        mUsed -= drop; mBase += drop;
+    }
+
+    mCV.notify_all();
+    return !mFinished || offset+read < mWritten;
+}
+
+/*****************************************************/
+void UploadStream::CheckFailure(const UniqueLock& lock) const
+{
+    if (mFailure) std::rethrow_exception(mFailure);
+    if (mRead != mWritten) throw RunnerInput::StreamFailException("Ended Early");
+}
+
+/*****************************************************/
+size_t UploadStream::GetFree(const UniqueLock& lock) const
+{
+    // the space kept for retries can't be used for data the upload hasn't read yet
+    const size_t unread { static_cast<size_t>(mWritten - mRead) };
+    return std::min(mBuffer.size() - mUsed, mBuffer.size() - mReplaySize - unread);
+}
+
+/*****************************************************/
+void UploadStream::Write(const char* data, size_t length)
+{
+    UniqueLock lock(mMutex);
+    MDBG_INFO("(length:" << length << ")");
+
+    while (length)
+    {
+        mCV.wait(lock, [&]{ return GetFree(lock) || mDone; });
+        if (mDone) CheckFailure(lock); // can't take more data
+
+        const size_t tail { (mHead + mUsed) % mBuffer.size() };
+        const size_t copy { std::min({ length, GetFree(lock), mBuffer.size()-tail }) };
+
+        if (data != nullptr) 
+        {
+            std::copy(data, data+copy, mBuffer.data()+tail); 
+            data += copy;
+        }
+        else std::fill(mBuffer.data()+tail, mBuffer.data()+tail+copy, 0);
+
+        mUsed += copy; mWritten += copy; length -= copy;
+        mCV.notify_all();
+    }
+}
+
+/*****************************************************/
+uint64_t UploadStream::GetWritten() const
+{
+    const UniqueLock lock(mMutex);
+    return mWritten;
+}
+
+/*****************************************************/
+nlohmann::json UploadStream::Finish()
+{
+    MDBG_INFO("()");
+
+    { const UniqueLock lock(mMutex);
+        mFinished = true;
+        mCV.notify_all(); }
+
+    if (mThread.joinable()) mThread.join();
+
+    const UniqueLock lock(mMutex);
+    CheckFailure(lock);
+    return *mResult;
+}
+
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
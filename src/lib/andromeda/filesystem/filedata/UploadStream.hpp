@@ -0,0 +1,129 @@
+
+#ifndef LIBA2_UPLOADSTREAM_H_
+#define LIBA2_UPLOADSTREAM_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "nlohmann/json_fwd.hpp"
+
+#include "andromeda/common.hpp"
+#include "andromeda/Debug.hpp"
+#include "andromeda/backend/RunnerInput.hpp"
+
+namespace Andromeda {
+namespace Filesystem {
+namespace Filedata {
+
+/**
+ * A bounded pipe feeding a streaming upload that runs on its own thread
+ * Write() copies data into a fixed-size ring buffer and blocks while it is full (back-pressure),
+ * while the upload pulls data out through a WriteFunc as fast as the backend accepts it.
+ * The last replaySize bytes given to the upload are kept so that a retry can rewind that far,
+ * a retry that needs to rewind further fails with StreamSeekException.
+ * Once the upload fails, the failure is rethrown by every later Write() and Finish()
+ * THREAD SAFE (INTERNAL LOCKS)
+ */
+class UploadStream
+{
+public:
+
+    /** Function that runs the upload reading from the given WriteFunc, returning the backend's JSON */
+    using UploadFunc = std::function<nlohmann::json (const Backend::WriteFunc&)>;
+
+    /**
+     * Starts the upload on a new thread
+     * @param bufferSize the maximum number of bytes to buffer before Write() blocks
+     * @param replaySize the number of bytes already given to the upload to keep for retries
+     * @param uploadFunc function that runs the upload
+     */
+    UploadStream(size_t bufferSize, size_t replaySize, const UploadFunc& uploadFunc);
+
+    /** Aborts the upload if not finished and waits for its thread */
+    virtual ~UploadStream();
+    DELETE_COPY(UploadStream)
+    DELETE_MOVE(UploadStream)
+
+    /**
+     * Appends data to the stream, blocking while the buffer is full
+     * @param data the data to append, or nullptr to append zeroes
+     * @param length the number of bytes to append
+     * @throws BackendException or other if the upload failed
+     */
+    void Write(const char* data, size_t length);
+
+    /** Returns the total number of bytes given to Write() */
+    [[nodiscard]] uint64_t GetWritten() const;
+
+    /**
+     * Ends the stream and waits for the upload to finish (may be called again after failure)
+     * @return the backend's JSON response to the upload
+     * @throws BackendException or other if the upload failed
+     */
+    nlohmann::json Finish();
+
+private:
+
+    using UniqueLock = std::unique_lock<std::mutex>;
+
+    /** The WriteFunc given to the upload, waits for data then copies it out of the buffer (may rewind within mReplaySize) */
+    bool ReadFunc(size_t offset, char* buf, size_t buflen, size_t& read);
+
+    /** The main function for the upload thread */
+    void UploadMain(const UploadFunc& uploadFunc);
+
+    /** Returns the number of bytes Write() can add without blocking */
+    size_t GetFree(const UniqueLock& lock) const;
+
+    /** Throws the upload's failure, or StreamFailException if it ended early */
+    void CheckFailure(const UniqueLock& lock) const;
+
+    /** The ring buffer of data waiting to be uploaded, followed by data kept for retries */
+    std::vector<char> mBuffer;
+    /** The number of bytes already given to the upload to keep for retries */
+    const size_t mReplaySize;
+    /** The index of the first byte of buffered data */
+    size_t mHead { 0 };
+    /** The number of bytes buffered (including kept for retries) */
+    size_t mUsed { 0 };
+    /** The stream offset of the first byte of buffered data */
+    uint64_t mBase { 0 };
+
+    /** The total number of bytes given to Write() */
+    uint64_t mWritten { 0 };
+    /** The furthest stream offset given to the upload */
+    uint64_t mRead { 0 };
+
+    /** True if Finish() was called (no more data will come) */
+    bool mFinished { false };
+    /** True if the upload should be abandoned */
+    bool mAborted { false };
+    /** True if the upload thread has returned */
+    bool mDone { false };
+
+    /** The upload's response JSON once done */
+    std::unique_ptr<nlohmann::json> mResult;
+    /** The upload's exception if it failed */
+    std::exception_ptr mFailure;
+
+    /** Mutex that protects all state */
+    mutable std::mutex mMutex;
+    /** Condition variable signalled whenever data is added or removed or the state changes */
+    std::condition_variable mCV;
+
+    mutable Debug mDebug;
+
+    /** The thread running the upload (initialized last) */
+    std::thread mThread;
+};
+
+} // namespace Filedata
+} // namespace Filesystem
+} // namespace Andromeda
+
+#endif // LIBA2_UPLOADSTREAM_H_
@@ -119,8 +119,8 @@ void PlainFolder::SubCreateFile(const std::string& name, const SharedLockW& this
     else file = std::make_unique<File>(mBackend, *this, name, *mFsConfig, // create later
         [&](const std::string& fname){ 
             return mBackend.CreateFile(GetID(), fname); },
-        [&](const std::string& fname, const WriteFunc& ffunc, bool oneshot){ 
-            return mBackend.UploadFile(GetID(), fname, ffunc, oneshot); });
+        [&](const std::string& fname, const WriteFunc& ffunc, bool oneshot, bool stream){ 
+            return mBackend.UploadFile(GetID(), fname, ffunc, oneshot, false, stream); });
 
     const SharedLockR subLock { file->GetReadLock() };
     mItemMap[file->GetName(subLock)] = std::move(file);